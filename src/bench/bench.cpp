@@ -0,0 +1,862 @@
+#include "common.h"
+#include "utils/utils.h"
+#include "bench.h"
+#include "kz/kz.h"
+#include "kz/jumpstats/kz_jumpstats.h"
+#include "kz/mode/kz_mode_ckz.h"
+#include "kz/mode/kz_mode_vnl.h"
+#include "kz/recorder/kz_recorder.h"
+
+#include <chrono>
+
+#include "tier0/memdbgon.h"
+
+/*
+ * Headless movement benchmark.
+ *
+ * Replays a tick stream written by the movement recorder (or a synthetic one) without a server, and reports how many
+ * ticks per second each stage handles. The hook stages run a player with the mode and jumpstats services through the
+ * movement hooks in the order the detours call them (see mv_hooks.cpp), the movement of the engine itself is replaced
+ * by the recorded result of each tick. The other stages time parts of the mode and jumpstat math on their own.
+ *
+ * Usage: cs2kz-bench [recording.kzmr] [-n iterations] [-max <ns per tick>]
+ * With -max, the exit code is 1 if any stage takes longer than the given time per tick.
+ */
+
+#define BENCH_DEFAULT_ITERATIONS 20
+#define BENCH_SYNTHETIC_TICKS    (64 * 60 * 5)
+#define BENCH_AIR_ACCELERATE     100.0f
+
+// Ground checks hit a 30 degree slope facing the player, so that the slope fix has something to do on every landing.
+#define BENCH_SLOPE_NORMAL_Z 0.866f
+// The movement code checks for ground 2 units below the player, with a little room for rounding.
+#define BENCH_GROUND_CHECK_DISTANCE 2.01f
+
+// There is no schema system either. Each field gets a slot of its own in every fake entity, big enough for any field.
+#define BENCH_SCHEMA_SLOT_SIZE 128
+// Fields start after the C++ part of the entity classes, which is only a vtable and the empty accessors.
+// The fields of an inline class (the collision property of a pawn) are at the sum of both offsets,
+// so they are always past the fields of the entity itself.
+#define BENCH_SCHEMA_BASE (BENCH_SCHEMA_SLOT_SIZE * SCHEMA_MAX_FIELDS)
+// Inline classes go up to three levels deep (a collision attribute in the collision property of a pawn).
+#define BENCH_ENTITY_SIZE (BENCH_SCHEMA_BASE * 6)
+
+class BenchPlayer;
+
+struct BenchStage
+{
+	const char *name;
+	void (*run)(BenchPlayer *player, const CUtlVector<RecorderTick> &ticks);
+	// Stages that run the hooks get a player with this mode, the others get no player.
+	ModeServiceFactory createMode;
+	u64 modeHooks;
+	f64 seconds;
+	f64 checksum;
+};
+
+internal f64 checksum;
+
+internal f32 AsFloat(u32 bits)
+{
+	f32 value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+internal u32 AsBits(f32 value)
+{
+	u32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+internal Vector GetVector(const RecorderTick &tick, u32 field)
+{
+	return Vector(AsFloat(tick.fields[field]), AsFloat(tick.fields[field + 1]), AsFloat(tick.fields[field + 2]));
+}
+
+internal QAngle GetAngles(const RecorderTick &tick)
+{
+	return QAngle(AsFloat(tick.fields[RecorderField_ViewAngleX]), AsFloat(tick.fields[RecorderField_ViewAngleY]),
+				  AsFloat(tick.fields[RecorderField_ViewAngleZ]));
+}
+
+internal void SetVector(RecorderTick &tick, u32 field, const Vector &vec)
+{
+	tick.fields[field] = AsBits(vec.x);
+	tick.fields[field + 1] = AsBits(vec.y);
+	tick.fields[field + 2] = AsBits(vec.z);
+}
+
+// Ground ticks are the ones that neither start nor end with vertical speed.
+internal bool IsOnGround(const RecorderTick &tick)
+{
+	return AsFloat(tick.fields[RecorderField_VelocityZ]) == 0.0f && AsFloat(tick.fields[RecorderField_PostVelocityZ]) == 0.0f;
+}
+
+// Same wish direction as AirMove builds from the view angles and the movement keys.
+internal f32 CalcWishDir(const RecorderTick &tick, Vector &wishdir)
+{
+	Vector forward, right, up;
+	AngleVectors(GetAngles(tick), &forward, &right, &up);
+	f32 fmove = AsFloat(tick.fields[RecorderField_ForwardMove]);
+	f32 smove = -AsFloat(tick.fields[RecorderField_SideMove]);
+	for (u32 i = 0; i < 2; i++)
+	{
+		wishdir[i] = forward[i] * fmove + right[i] * smove;
+	}
+	wishdir[2] = 0;
+	return MIN(VectorNormalize(wishdir), AsFloat(tick.fields[RecorderField_MaxSpeed]));
+}
+
+/*
+ * Recording parsing
+ */
+
+struct BenchReader
+{
+	const u8 *data;
+	const u8 *end;
+	bool failed;
+
+	bool Read(void *out, size_t size)
+	{
+		if (this->failed || (size_t)(this->end - this->data) < size)
+		{
+			this->failed = true;
+			return false;
+		}
+		memcpy(out, this->data, size);
+		this->data += size;
+		return true;
+	}
+
+	u8 ReadByte()
+	{
+		u8 value = 0;
+		this->Read(&value, sizeof(value));
+		return value;
+	}
+
+	u64 ReadVarint()
+	{
+		u64 value = 0;
+		for (u32 shift = 0; shift < 64 && !this->failed; shift += 7)
+		{
+			u8 byte = this->ReadByte();
+			value |= (u64)(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+			{
+				return value;
+			}
+		}
+		this->failed = true;
+		return 0;
+	}
+
+	i64 ReadZigZag()
+	{
+		u64 value = this->ReadVarint();
+		return (i64)(value >> 1) ^ -(i64)(value & 1);
+	}
+
+	void SkipString()
+	{
+		while (!this->failed && this->ReadByte() != 0)
+		{
+		}
+	}
+};
+
+internal bool LoadRecording(const char *path, CUtlVector<RecorderTick> &ticks)
+{
+	FILE *file = fopen(path, "rb");
+	if (!file)
+	{
+		fprintf(stderr, "Failed to open %s!\n", path);
+		return false;
+	}
+	CUtlVector<u8> buffer;
+	u8 chunk[65536];
+	size_t size;
+	while ((size = fread(chunk, 1, sizeof(chunk), file)) > 0)
+	{
+		buffer.AddMultipleToTail((int)size, chunk);
+	}
+	fclose(file);
+
+	BenchReader reader = {buffer.Base(), buffer.Base() + buffer.Count(), false};
+	u32 header[2];
+	if (!reader.Read(header, sizeof(header)) || header[0] != KZ_RECORDER_MAGIC || header[1] != KZ_RECORDER_VERSION)
+	{
+		fprintf(stderr, "%s is not a version %i movement recording!\n", path, KZ_RECORDER_VERSION);
+		return false;
+	}
+
+	RecorderTick previous = {};
+	while (reader.data < reader.end && !reader.failed)
+	{
+		switch (reader.ReadByte())
+		{
+			case RecorderEntry_Begin:
+			{
+				RecorderBegin begin;
+				reader.Read(&begin.xuid, sizeof(begin.xuid));
+				reader.Read(&begin.time, sizeof(begin.time));
+				reader.Read(&begin.tickInterval, sizeof(begin.tickInterval));
+				reader.Read(&begin.tick, sizeof(begin.tick));
+				reader.SkipString();
+				previous = {};
+				previous.tick = begin.tick;
+				break;
+			}
+			case RecorderEntry_ModeCvars:
+			{
+				reader.SkipString();
+				reader.SkipString();
+				u32 values[256];
+				reader.Read(values, reader.ReadByte() * sizeof(u32));
+				break;
+			}
+			case RecorderEntry_Tick:
+			{
+				RecorderTick tick = {};
+				tick.tick = previous.tick + (i32)reader.ReadZigZag();
+				u32 mask = (u32)reader.ReadVarint();
+				// Fields are predicted in order, the post values depend on the pre values of the same tick.
+				for (u32 i = 0; i < RECORDERFIELD_COUNT; i++)
+				{
+					tick.fields[i] = RecorderPredictField(previous, tick, i);
+					if (mask & (1 << i))
+					{
+						tick.fields[i] += (u32)(i32)reader.ReadZigZag();
+					}
+				}
+				for (u32 i = 0; i < 3; i++)
+				{
+					tick.buttons[i] = previous.buttons[i] ^ reader.ReadVarint();
+				}
+				tick.subtickMoveCount = MIN(reader.ReadByte(), KZ_RECORDER_MAX_SUBTICK_MOVES);
+				for (u32 i = 0; i < tick.subtickMoveCount; i++)
+				{
+					reader.Read(&tick.subtickMoves[i].when, sizeof(f32));
+					u64 button = reader.ReadVarint();
+					tick.subtickMoves[i].button = button >> 1;
+					tick.subtickMoves[i].pressed = button & 1;
+				}
+				if (!reader.failed)
+				{
+					ticks.AddToTail(tick);
+				}
+				previous = tick;
+				break;
+			}
+			case RecorderEntry_End:
+			{
+				break;
+			}
+			default:
+			{
+				reader.failed = true;
+				break;
+			}
+		}
+	}
+	if (reader.failed)
+	{
+		fprintf(stderr, "%s is truncated or corrupt, using the first %i ticks.\n", path, ticks.Count());
+	}
+	return ticks.Count() > 0;
+}
+
+// Ground prestrafe followed by a jump with alternating strafes, over and over.
+internal void GenerateTicks(CUtlVector<RecorderTick> &ticks)
+{
+	Vector origin(0, 0, 0);
+	Vector velocity(0, 0, 0);
+	f32 yaw = 0;
+	for (i32 i = 0; i < BENCH_SYNTHETIC_TICKS; i++)
+	{
+		RecorderTick tick = {};
+		tick.tick = i;
+		f32 time = i * ENGINE_FIXED_TICK_INTERVAL;
+		f32 cycle = fmod(time, 1.5f);
+		bool strafingLeft = sin(time * 2 * M_PI * 1.5f) > 0;
+		yaw += strafingLeft ? 1.5f : -1.5f;
+
+		SetVector(tick, RecorderField_OriginX, origin);
+		SetVector(tick, RecorderField_VelocityX, velocity);
+		tick.fields[RecorderField_ViewAngleY] = AsBits(utils::NormalizeDeg(yaw));
+		tick.fields[RecorderField_SideMove] = AsBits(strafingLeft ? 250.0f : -250.0f);
+		tick.fields[RecorderField_ForwardMove] = AsBits(cycle < 0.5f ? 250.0f : 0.0f);
+		tick.fields[RecorderField_MaxSpeed] = AsBits(250.0f);
+		tick.buttons[0] = strafingLeft ? IN_MOVELEFT : IN_MOVERIGHT;
+
+		// Turn the velocity with the view and keep the speed in a believable range.
+		f32 speed = MIN(velocity.Length2D() + (cycle < 0.5f ? 12.0f : 0.8f), 350.0f);
+		f32 radians = DEG2RAD(yaw + (strafingLeft ? 80.0f : -80.0f));
+		velocity.x = cos(radians) * speed;
+		velocity.y = sin(radians) * speed;
+		if (cycle >= 0.5f && cycle < 0.5f + ENGINE_FIXED_TICK_INTERVAL)
+		{
+			velocity.z = 301.993377f;
+			tick.buttons[0] |= IN_JUMP;
+		}
+		else if (cycle >= 0.5f && cycle < 0.5f + 0.755f)
+		{
+			velocity.z -= 800.0f * ENGINE_FIXED_TICK_INTERVAL;
+		}
+		else
+		{
+			velocity.z = 0;
+		}
+		origin += velocity * ENGINE_FIXED_TICK_INTERVAL;
+
+		SetVector(tick, RecorderField_PostOriginX, origin);
+		SetVector(tick, RecorderField_PostVelocityX, velocity);
+		ticks.AddToTail(tick);
+	}
+}
+
+/*
+ * Stand-ins for the engine
+ */
+
+// The world is a floor at the height the player last stood on. Only ground checks, straight down traces of at most
+// BENCH_GROUND_CHECK_DISTANCE units, can hit it. Everything else misses, so the player never collides with anything.
+internal struct
+{
+	f32 floorZ;
+	Vector floorNormal;
+} world;
+
+internal void SetFloor(f32 z, f32 yaw)
+{
+	f32 horizontal = sqrt(1.0f - BENCH_SLOPE_NORMAL_Z * BENCH_SLOPE_NORMAL_Z);
+	world.floorZ = z;
+	world.floorNormal = Vector(cos(DEG2RAD(yaw)) * horizontal, sin(DEG2RAD(yaw)) * horizontal, BENCH_SLOPE_NORMAL_Z);
+}
+
+internal void BenchTracePlayerBBox(const Vector &start, const Vector &end, const bbox_t &bounds, CTraceFilterS2 *filter, trace_t_s2 &pm)
+{
+	pm.m_pEnt = nullptr;
+	pm.startpos = start;
+	pm.startsolid = false;
+	if (start.x != end.x || start.y != end.y || end.z >= start.z || start.z - end.z > BENCH_GROUND_CHECK_DISTANCE || end.z > world.floorZ)
+	{
+		pm.endpos = end;
+		pm.planeNormal.Init();
+		pm.fraction = 1.0f;
+		return;
+	}
+	pm.fraction = Clamp((start.z - world.floorZ) / (start.z - end.z), 0.0f, 1.0f);
+	pm.endpos = start + (end - start) * pm.fraction;
+	pm.planeNormal = world.floorNormal;
+}
+
+internal void BenchInitGameTrace(trace_t_s2 *trace)
+{
+	V_memset(trace, 0, sizeof(*trace));
+	trace->fraction = 1.0f;
+}
+
+internal void BenchInitPlayerMovementTraceFilter(CTraceFilterPlayerMovementCS &filter, CEntityInstance *entity, uint64_t interactWith,
+												 int collisionGroup)
+{
+}
+
+internal void InitSchemaLayout()
+{
+	for (schema::FieldKey *key = schema::FieldKey::first; key; key = key->next)
+	{
+		schema::fields[key->id] = {BENCH_SCHEMA_BASE + key->id * BENCH_SCHEMA_SLOT_SIZE, false, 0};
+	}
+}
+
+// Mode without movement hooks, so that a stage can time the player and jumpstats hooks on their own.
+class BenchModeService : public KZModeService
+{
+	using KZModeService::KZModeService;
+
+public:
+	virtual const char *GetModeName() override
+	{
+		return "Bench";
+	}
+
+	virtual const char *GetModeShortName() override
+	{
+		return "BNC";
+	}
+
+	virtual DistanceTier GetDistanceTier(JumpType jumpType, f32 distance) override
+	{
+		return DistanceTier_None;
+	}
+
+	virtual const char **GetModeConVarValues() override
+	{
+		return nullptr;
+	}
+};
+
+internal KZModeService *CreateBenchMode(KZPlayer *player)
+{
+	return new BenchModeService(player);
+}
+
+internal KZModeService *CreateClassicMode(KZPlayer *player)
+{
+	return new KZClassicModeService(player);
+}
+
+internal KZModeService *CreateVanillaMode(KZPlayer *player)
+{
+	return new KZVanillaModeService(player);
+}
+
+// A standing player whose entities are zeroed buffers laid out by InitSchemaLayout.
+class BenchPlayer : public KZPlayer
+{
+public:
+	BenchPlayer(ModeServiceFactory createMode, u64 modeHooks) : KZPlayer(1)
+	{
+		this->modeService = createMode(this);
+		this->modeServiceHooks = modeHooks;
+		this->UpdateActiveHooks();
+
+		this->controller = static_cast<CCSPlayerController *>(malloc(BENCH_ENTITY_SIZE));
+		this->pawn = static_cast<CCSPlayerPawn *>(malloc(BENCH_ENTITY_SIZE));
+		this->moveServices = static_cast<CCSPlayer_MovementServices *>(malloc(BENCH_ENTITY_SIZE));
+		this->Reset();
+	}
+
+	~BenchPlayer()
+	{
+		delete this->modeService;
+		delete this->styleService;
+		delete this->jumpstatsService;
+		free(this->controller);
+		free(this->pawn);
+		free(this->moveServices);
+	}
+
+	CMoveData moveData {};
+
+	virtual CCSPlayerController *GetController() override
+	{
+		return this->controller;
+	}
+
+	virtual CCSPlayerPawn *GetPawn() override
+	{
+		return this->pawn;
+	}
+
+	virtual CCSPlayer_MovementServices *GetMoveServices() override
+	{
+		return this->moveServices;
+	}
+
+	virtual void Reset() override
+	{
+		V_memset(this->controller, 0, BENCH_ENTITY_SIZE);
+		V_memset(this->pawn, 0, BENCH_ENTITY_SIZE);
+		V_memset(this->moveServices, 0, BENCH_ENTITY_SIZE);
+		V_strncpy(this->controller->m_iszPlayerName(), "Bench", BENCH_SCHEMA_SLOT_SIZE);
+		this->pawn->SetMoveType(MOVETYPE_WALK);
+		this->pawn->m_flGravityScale(1.0f);
+		this->pawn->m_pCollision(&this->pawn->m_Collision());
+		this->moveServices->m_flSurfaceFriction(1.0f);
+		// Don't report a movetype change on the first tick.
+		this->MovementPlayer::OnPhysicsSimulatePost();
+
+		KZPlayer::Reset();
+	}
+
+private:
+	CCSPlayerController *controller;
+	CCSPlayerPawn *pawn;
+	CCSPlayer_MovementServices *moveServices;
+};
+
+
+/*
+ * Tick driver
+ */
+
+internal void LoadMoveData(CMoveData *mv, const RecorderTick &tick)
+{
+	mv->m_vecViewAngles = GetAngles(tick);
+	mv->m_flForwardMove = AsFloat(tick.fields[RecorderField_ForwardMove]);
+	mv->m_flSideMove = AsFloat(tick.fields[RecorderField_SideMove]);
+	mv->m_flUpMove = AsFloat(tick.fields[RecorderField_UpMove]);
+	mv->m_flMaxSpeed = AsFloat(tick.fields[RecorderField_MaxSpeed]);
+	mv->m_vecAbsOrigin = GetVector(tick, RecorderField_OriginX);
+	mv->m_vecVelocity = GetVector(tick, RecorderField_VelocityX);
+}
+
+internal void SetOnGround(CCSPlayerPawn *pawn, bool onGround)
+{
+	pawn->m_fFlags(onGround ? FL_ONGROUND : 0);
+}
+
+// One call of ProcessMovement. The hooks and the bookkeeping around them are called like the detours in mv_hooks.cpp do,
+// the engine functions in between are replaced by copying the recorded result of the tick into the move data.
+internal void SimulateTick(BenchPlayer *player, const RecorderTick &tick)
+{
+	bench::globals.tickcount = tick.tick;
+	bench::globals.curtime = tick.tick * ENGINE_FIXED_TICK_INTERVAL;
+	bench::globals.frametime = ENGINE_FIXED_TICK_INTERVAL;
+
+	CCSPlayerPawn *pawn = player->GetPawn();
+	CCSPlayer_MovementServices *moveServices = player->GetMoveServices();
+	CMoveData *mv = &player->moveData;
+
+	Vector postOrigin = GetVector(tick, RecorderField_PostOriginX);
+	Vector postVelocity = GetVector(tick, RecorderField_PostVelocityX);
+	bool startOnGround = AsFloat(tick.fields[RecorderField_VelocityZ]) == 0.0f;
+	bool endOnGround = postVelocity.z == 0.0f;
+	bool jumped = startOnGround && postVelocity.z > 0.0f;
+	// Keep the floor where the player stands, a landing tick has to find it under the origin it lands on.
+	f32 yaw = AsFloat(tick.fields[RecorderField_ViewAngleY]);
+	if (endOnGround)
+	{
+		SetFloor(postOrigin.z, yaw);
+	}
+	else if (startOnGround)
+	{
+		SetFloor(GetVector(tick, RecorderField_OriginX).z, yaw);
+	}
+	SetOnGround(pawn, startOnGround);
+	for (u32 i = 0; i < 3; i++)
+	{
+		moveServices->m_nButtons()->m_pButtonStates[i] = tick.buttons[i];
+	}
+
+	if (player->HasPreHook(MovementHook_PhysicsSimulate))
+	{
+		player->OnPhysicsSimulate();
+	}
+
+	LoadMoveData(mv, tick);
+	player->currentMoveData = mv;
+	player->moveDataPre = CMoveData(*mv);
+	if (player->HasPreHook(MovementHook_ProcessMovement))
+	{
+		player->OnProcessMovement();
+	}
+
+	if (player->HasPreHook(MovementHook_Duck))
+	{
+		player->OnDuck();
+	}
+	if (player->HasPostHook(MovementHook_Duck))
+	{
+		player->OnDuckPost();
+	}
+
+	if (jumped)
+	{
+		if (player->HasPreHook(MovementHook_OnJump))
+		{
+			player->OnJump();
+		}
+		mv->m_vecVelocity.z = postVelocity.z;
+		SetOnGround(pawn, false);
+		player->hitPerf = !player->oldWalkMoved;
+		player->RegisterTakeoff(true);
+		player->OnStopTouchGround();
+		if (player->HasPostHook(MovementHook_OnJump))
+		{
+			player->OnJumpPost();
+		}
+	}
+
+	bool walked = startOnGround && !jumped;
+	if (walked)
+	{
+		if (player->HasPreHook(MovementHook_WalkMove))
+		{
+			player->OnWalkMove();
+		}
+		mv->m_vecVelocity = postVelocity;
+	}
+	else
+	{
+		if (player->HasPreHook(MovementHook_AirMove))
+		{
+			player->OnAirMove();
+		}
+		Vector wishdir;
+		f32 wishspeed = CalcWishDir(tick, wishdir);
+		f32 accel = BENCH_AIR_ACCELERATE;
+		if (player->HasPreHook(MovementHook_AirAccelerate))
+		{
+			player->OnAirAccelerate(wishdir, wishspeed, accel);
+		}
+		// Gravity is applied after the move, a landing tick still moves with the vertical speed it started with.
+		mv->m_vecVelocity.x = postVelocity.x;
+		mv->m_vecVelocity.y = postVelocity.y;
+		if (!endOnGround)
+		{
+			mv->m_vecVelocity.z = postVelocity.z;
+		}
+		if (player->HasPostHook(MovementHook_AirAccelerate))
+		{
+			player->OnAirAcceleratePost(wishdir, wishspeed, accel);
+		}
+	}
+
+	// The velocity is already the recorded one, so TryPlayerMove only moves the player and never reports a collision.
+	if (player->HasPreHook(MovementHook_TryPlayerMove))
+	{
+		player->OnTryPlayerMove(nullptr, nullptr);
+	}
+	mv->m_vecAbsOrigin = postOrigin;
+	if (player->HasPostHook(MovementHook_TryPlayerMove))
+	{
+		player->OnTryPlayerMovePost(nullptr, nullptr);
+	}
+
+	if (walked)
+	{
+		player->walkMoved = true;
+		if (player->HasPostHook(MovementHook_WalkMove))
+		{
+			player->OnWalkMovePost();
+		}
+	}
+	else if (player->HasPostHook(MovementHook_AirMove))
+	{
+		player->OnAirMovePost();
+	}
+
+	if (player->HasPreHook(MovementHook_CategorizePosition))
+	{
+		player->OnCategorizePosition(walked);
+	}
+	Vector oldVelocity = mv->m_vecVelocity;
+	bool oldOnGround = !!(pawn->m_fFlags() & FL_ONGROUND);
+	if (endOnGround)
+	{
+		mv->m_vecVelocity.z = 0.0f;
+	}
+	SetOnGround(pawn, endOnGround);
+	if (!oldOnGround && endOnGround)
+	{
+		player->RegisterLanding(oldVelocity);
+		player->duckBugged = player->processingDuck;
+		player->OnStartTouchGround();
+		if (player->jumpstatsService->HasJump())
+		{
+			checksum += player->jumpstatsService->GetCurrentJump().GetDistance();
+		}
+	}
+	else if (oldOnGround && !endOnGround)
+	{
+		player->RegisterTakeoff(false);
+		player->OnStopTouchGround();
+	}
+	if (player->HasPostHook(MovementHook_CategorizePosition))
+	{
+		player->OnCategorizePositionPost(walked);
+	}
+
+	player->moveDataPost = CMoveData(*mv);
+	if (player->HasPostHook(MovementHook_ProcessMovement))
+	{
+		player->OnProcessMovementPost();
+	}
+	if (player->HasPostHook(MovementHook_PhysicsSimulate))
+	{
+		player->OnPhysicsSimulatePost();
+	}
+	checksum += mv->m_vecVelocity.Length();
+}
+
+/*
+ * Stages
+ */
+
+internal void RunMovementHooks(BenchPlayer *player, const CUtlVector<RecorderTick> &ticks)
+{
+	player->Reset();
+	LoadMoveData(&player->moveData, ticks[0]);
+	player->moveDataPre = CMoveData(player->moveData);
+	player->moveDataPost = CMoveData(player->moveData);
+	player->oldAngles = player->moveData.m_vecViewAngles;
+	FOR_EACH_VEC(ticks, i)
+	{
+		SimulateTick(player, ticks[i]);
+	}
+}
+
+internal void RunCKZTurnRate(BenchPlayer *player, const CUtlVector<RecorderTick> &ticks)
+{
+	FOR_EACH_VEC(ticks, i)
+	{
+		const RecorderTick &tick = ticks[i];
+		checksum += KZ::ckz::CalcTurnRate(GetAngles(tick), AsFloat(tick.fields[RecorderField_ForwardMove]),
+										  AsFloat(tick.fields[RecorderField_SideMove]), GetVector(tick, RecorderField_VelocityX));
+	}
+}
+
+// Same math as KZClassicModeService::UpdateAngleHistory and CalcPrestrafe, without the player around it.
+internal void RunCKZPrestrafe(BenchPlayer *player, const CUtlVector<RecorderTick> &ticks)
+{
+	CUtlVector<KZ::ckz::AngleHistory> angleHistory;
+	f32 leftPreRatio = 0, rightPreRatio = 0, bonusSpeed = 0, landingTime = 0;
+	bool wasOnGround = false;
+	FOR_EACH_VEC(ticks, i)
+	{
+		const RecorderTick &tick = ticks[i];
+		f32 curtime = tick.tick * ENGINE_FIXED_TICK_INTERVAL;
+		bool onGround = IsOnGround(tick);
+		if (onGround && !wasOnGround)
+		{
+			landingTime = curtime;
+		}
+		wasOnGround = onGround;
+
+		Vector velocity = GetVector(tick, RecorderField_VelocityX);
+		KZ::ckz::UpdateAngleHistory(angleHistory, curtime, ENGINE_FIXED_TICK_INTERVAL, onGround, GetAngles(tick),
+									AsFloat(tick.fields[RecorderField_ForwardMove]), AsFloat(tick.fields[RecorderField_SideMove]), velocity);
+		f32 averageRate = KZ::ckz::CalcAverageTurnRate(angleHistory);
+		bool punish = landingTime + PS_LANDING_GRACE_PERIOD < curtime;
+		KZ::ckz::UpdatePrestrafeRatios(leftPreRatio, rightPreRatio, bonusSpeed, averageRate, ENGINE_FIXED_TICK_INTERVAL, punish, onGround,
+									   velocity.Length2D());
+		checksum += KZ::ckz::CalcPrestrafeGain(leftPreRatio, rightPreRatio);
+	}
+}
+
+// Builds an AACall for every air tick the way KZJumpstatsService does, and ends a strafe whenever the turn direction flips.
+internal void RunJumpstatStrafes(BenchPlayer *player, const CUtlVector<RecorderTick> &ticks)
+{
+	// Stands in for the buffer a jump keeps its calls in, reused for each strafe.
+	AACallBuffer aaCalls;
+	Strafe strafe(&aaCalls);
+	strafe.turnstate = TURN_NONE;
+	FOR_EACH_VEC(ticks, i)
+	{
+		const RecorderTick &tick = ticks[i];
+		if (IsOnGround(tick) || i == 0)
+		{
+			continue;
+		}
+		f32 prevYaw = AsFloat(ticks[i - 1].fields[RecorderField_ViewAngleY]);
+		f32 currentYaw = AsFloat(tick.fields[RecorderField_ViewAngleY]);
+		f32 turn = utils::GetAngleDifference(currentYaw, prevYaw, 180.0f);
+		TurnState turnState = turn > 0 ? TURN_LEFT : turn < 0 ? TURN_RIGHT : TURN_NONE;
+		if (turnState != TURN_NONE && turnState != strafe.turnstate && strafe.GetAACallCount() > 0)
+		{
+			strafe.End();
+			checksum += strafe.GetSync() + strafe.GetGain() + (strafe.arStats.available ? strafe.arStats.average : 0);
+			aaCalls.RemoveAll();
+			strafe = Strafe(&aaCalls);
+		}
+		strafe.turnstate = turnState;
+
+		AACall call;
+		call.wishspeed = CalcWishDir(tick, call.wishdir);
+		call.maxspeed = AsFloat(tick.fields[RecorderField_MaxSpeed]);
+		call.accel = BENCH_AIR_ACCELERATE;
+		call.surfaceFriction = 1.0f;
+		call.duration = ENGINE_FIXED_TICK_INTERVAL;
+		call.prevYaw = prevYaw;
+		call.currentYaw = currentYaw;
+		call.velocityPre = GetVector(tick, RecorderField_VelocityX);
+		call.velocityPost = GetVector(tick, RecorderField_PostVelocityX);
+		call.curtime = tick.tick * ENGINE_FIXED_TICK_INTERVAL;
+		call.tickcount = tick.tick;
+		memcpy(call.buttons, tick.buttons, sizeof(call.buttons));
+		strafe.AddAACall(call);
+	}
+	strafe.End();
+}
+
+// clang-format off
+internal BenchStage stages[] =
+{
+	{"Jumpstats hooks",        RunMovementHooks,   CreateBenchMode,   KZ::GetServiceHooks<BenchModeService, KZModeService>()},
+	{"CKZ + jumpstats hooks",  RunMovementHooks,   CreateClassicMode, KZ::GetServiceHooks<KZClassicModeService, KZModeService>()},
+	{"VNL + jumpstats hooks",  RunMovementHooks,   CreateVanillaMode, KZ::GetServiceHooks<KZVanillaModeService, KZModeService>()},
+	{"ckz::CalcTurnRate",      RunCKZTurnRate},
+	{"ckz prestrafe math",     RunCKZPrestrafe},
+	{"Strafe::AddAACall/End",  RunJumpstatStrafes},
+};
+// clang-format on
+
+int main(int argc, char **argv)
+{
+	const char *recording = nullptr;
+	i32 iterations = BENCH_DEFAULT_ITERATIONS;
+	f64 maxNanoseconds = 0;
+	for (i32 i = 1; i < argc; i++)
+	{
+		if (!V_stricmp(argv[i], "-n") && i + 1 < argc)
+		{
+			iterations = MAX(atoi(argv[++i]), 1);
+		}
+		else if (!V_stricmp(argv[i], "-max") && i + 1 < argc)
+		{
+			maxNanoseconds = atof(argv[++i]);
+		}
+		else
+		{
+			recording = argv[i];
+		}
+	}
+
+	CUtlVector<RecorderTick> ticks;
+	if (recording)
+	{
+		if (!LoadRecording(recording, ticks))
+		{
+			return 2;
+		}
+	}
+	else
+	{
+		GenerateTicks(ticks);
+	}
+	if (ticks.Count() == 0)
+	{
+		printf("No ticks to replay!\n");
+		return 2;
+	}
+	printf("%i ticks from %s, %i iterations\n\n", ticks.Count(), recording ? recording : "synthetic stream", iterations);
+
+	InitSchemaLayout();
+	g_pKZUtils = new KZUtils(BenchTracePlayerBBox, BenchInitGameTrace, BenchInitPlayerMovementTraceFilter, nullptr, nullptr, nullptr, nullptr,
+							 nullptr);
+
+	bool tooSlow = false;
+	printf("%-24s %14s %12s %16s\n", "stage", "ticks/s", "ns/tick", "checksum");
+	for (BenchStage &stage : stages)
+	{
+		BenchPlayer *player = stage.createMode ? new BenchPlayer(stage.createMode, stage.modeHooks) : nullptr;
+		checksum = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (i32 i = 0; i < iterations; i++)
+		{
+			stage.run(player, ticks);
+		}
+		stage.seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start).count();
+		stage.checksum = checksum / iterations;
+		delete player;
+
+		f64 tickCount = (f64)ticks.Count() * iterations;
+		f64 nanoseconds = stage.seconds * 1e9 / tickCount;
+		bool overLimit = maxNanoseconds > 0 && nanoseconds > maxNanoseconds;
+		tooSlow |= overLimit;
+		printf("%-24s %14.0f %12.2f %16.4f%s\n", stage.name, tickCount / stage.seconds, nanoseconds, stage.checksum, overLimit ? " !" : "");
+	}
+
+	if (tooSlow)
+	{
+		printf("\nStages marked with ! are above the limit of %.2fns per tick!\n", maxNanoseconds);
+		return 1;
+	}
+	return 0;
+}
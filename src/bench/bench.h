@@ -0,0 +1,11 @@
+#pragma once
+#include "common.h"
+
+/*
+ * Shared between the benchmark and the stubs it links in place of the plugin, see bench_stubs.cpp.
+ */
+namespace bench
+{
+	// Returned as both the server and the game globals, the tick driver in bench.cpp advances them.
+	inline CGlobalVars globals;
+} // namespace bench
@@ -0,0 +1,343 @@
+#include "bench.h"
+#include "kz/kz.h"
+#include "kz/jumpstats/kz_jumpstats.h"
+#include "kz/mode/kz_mode.h"
+#include "kz/style/kz_style.h"
+#include "utils/utils.h"
+#include "utils/simplecmds.h"
+
+#include "tier0/memdbgon.h"
+
+/*
+ * What the benchmark links instead of the rest of the plugin.
+ *
+ * The mode, jumpstats and movement player code is linked as is. KZPlayer dispatches to them the same way kz_player.cpp does,
+ * but the services that need a running server (timer, HUD, checkpoints, recorder...) don't exist here.
+ * Everything that would talk to clients or the entity system does nothing.
+ */
+
+CKZPlayerManager *g_pKZPlayerManager = nullptr;
+CMovementPlayerManager *g_pPlayerManager = nullptr;
+
+// Not "NRM", so finished jumps are never broadcast to the other players, which would walk the entity system.
+class BenchStyleService : public KZStyleService
+{
+	using KZStyleService::KZStyleService;
+
+public:
+	virtual const char *GetStyleName() override
+	{
+		return "Bench";
+	}
+
+	virtual const char *GetStyleShortName() override
+	{
+		return "BNC";
+	}
+};
+
+/*
+ * KZUtils
+ */
+
+CGameConfig *KZUtils::GetGameConfig()
+{
+	return nullptr;
+}
+
+const CGlobalVars *KZUtils::GetServerGlobals()
+{
+	return &bench::globals;
+}
+
+CGlobalVars *KZUtils::GetGlobals()
+{
+	return &bench::globals;
+}
+
+CBaseEntity2 *KZUtils::FindEntityByClassname(CEntityInstance *start, const char *name)
+{
+	return nullptr;
+}
+
+CBasePlayerController *KZUtils::GetController(CBaseEntity2 *entity)
+{
+	return nullptr;
+}
+
+CBasePlayerController *KZUtils::GetController(CPlayerSlot slot)
+{
+	return nullptr;
+}
+
+CPlayerSlot KZUtils::GetEntityPlayerSlot(CBaseEntity2 *entity)
+{
+	return -1;
+}
+
+void KZUtils::SendConVarValue(CPlayerSlot slot, ConVar *conVar, const char *value) {}
+
+void KZUtils::SendMultipleConVarValues(CPlayerSlot slot, ConVar **cvars, const char **values, u32 size) {}
+
+f32 KZUtils::NormalizeDeg(f32 a)
+{
+	return utils::NormalizeDeg(a);
+}
+
+f32 KZUtils::GetAngleDifference(const f32 source, const f32 target, const f32 c, bool relative)
+{
+	return utils::GetAngleDifference(source, target, c, relative);
+}
+
+CGameEntitySystem *KZUtils::GetGameEntitySystem()
+{
+	return nullptr;
+}
+
+// Nothing the benchmark runs starts timers.
+void KZUtils::AddTimer(CTimerBase *timer, bool preserveMapChange) {}
+
+void KZUtils::RemoveTimer(CTimerBase *timer) {}
+
+void utils::PlaySoundToClient(CPlayerSlot player, const char *sound, f32 volume) {}
+
+bool scmd::RegisterCmd(const char *name, scmd::Callback_t *callback, const char *description, bool hidden, bool adminOnly)
+{
+	return false;
+}
+
+KZPlayer *CKZPlayerManager::ToPlayer(CBasePlayerController *controller)
+{
+	return nullptr;
+}
+
+KZPlayer *CKZPlayerManager::ToPlayer(u32 index)
+{
+	return nullptr;
+}
+
+/*
+ * KZPlayer
+ */
+
+// The mode service is set up by the benchmark itself, see BenchPlayer.
+void KZPlayer::Init()
+{
+	this->hideLegs = false;
+	this->previousTurnState = TURN_NONE;
+
+	delete this->jumpstatsService;
+	delete this->styleService;
+
+	this->jumpstatsService = new KZJumpstatsService(this);
+	this->styleService = new BenchStyleService(this);
+	this->styleServiceHooks = KZ::GetServiceHooks<BenchStyleService, KZStyleService>();
+	this->UpdateActiveHooks();
+}
+
+void KZPlayer::Reset()
+{
+	MovementPlayer::Reset();
+	this->hideLegs = false;
+	this->previousTurnState = TURN_NONE;
+
+	this->jumpstatsService->Reset();
+	this->modeService->Reset();
+}
+
+META_RES KZPlayer::GetPlayerMaxSpeed(f32 &maxSpeed)
+{
+	return this->modeService->GetPlayerMaxSpeed(maxSpeed);
+}
+
+// Same as in kz_player.cpp.
+#define KZ_SERVICE_DISPATCH(hook, call) \
+	if (this->modeServiceHooks & (hook)) \
+	{ \
+		this->modeService->call; \
+	} \
+	if (this->styleServiceHooks & (hook)) \
+	{ \
+		this->styleService->call; \
+	}
+
+// Hooks that only the mode and style services take part in.
+#define KZ_BENCH_DISPATCH(function, hook, params, args) \
+	void KZPlayer::function params \
+	{ \
+		KZ_SERVICE_DISPATCH(hook, function args); \
+	}
+
+// clang-format off
+KZ_BENCH_DISPATCH(OnProcessUsercmds,        MV_HOOK_PRE(MovementHook_ProcessUsercmds),   (void *cmds, int numcmds), (cmds, numcmds))
+KZ_BENCH_DISPATCH(OnProcessUsercmdsPost,    MV_HOOK_POST(MovementHook_ProcessUsercmds),  (void *cmds, int numcmds), (cmds, numcmds))
+KZ_BENCH_DISPATCH(OnPlayerMove,             MV_HOOK_PRE(MovementHook_PlayerMoveNew),     (), ())
+KZ_BENCH_DISPATCH(OnPlayerMovePost,         MV_HOOK_POST(MovementHook_PlayerMoveNew),    (), ())
+KZ_BENCH_DISPATCH(OnCheckParameters,        MV_HOOK_PRE(MovementHook_CheckParameters),   (), ())
+KZ_BENCH_DISPATCH(OnCheckParametersPost,    MV_HOOK_POST(MovementHook_CheckParameters),  (), ())
+KZ_BENCH_DISPATCH(OnCanMove,                MV_HOOK_PRE(MovementHook_CanMove),           (), ())
+KZ_BENCH_DISPATCH(OnCanMovePost,            MV_HOOK_POST(MovementHook_CanMove),          (), ())
+KZ_BENCH_DISPATCH(OnFullWalkMove,           MV_HOOK_PRE(MovementHook_FullWalkMove),      (bool &ground), (ground))
+KZ_BENCH_DISPATCH(OnFullWalkMovePost,       MV_HOOK_POST(MovementHook_FullWalkMove),     (bool ground), (ground))
+KZ_BENCH_DISPATCH(OnMoveInit,               MV_HOOK_PRE(MovementHook_MoveInit),          (), ())
+KZ_BENCH_DISPATCH(OnMoveInitPost,           MV_HOOK_POST(MovementHook_MoveInit),         (), ())
+KZ_BENCH_DISPATCH(OnCheckWater,             MV_HOOK_PRE(MovementHook_CheckWater),        (), ())
+KZ_BENCH_DISPATCH(OnCheckWaterPost,         MV_HOOK_POST(MovementHook_CheckWater),       (), ())
+KZ_BENCH_DISPATCH(OnWaterMove,              MV_HOOK_PRE(MovementHook_WaterMove),         (), ())
+KZ_BENCH_DISPATCH(OnWaterMovePost,          MV_HOOK_POST(MovementHook_WaterMove),        (), ())
+KZ_BENCH_DISPATCH(OnCheckVelocity,          MV_HOOK_PRE(MovementHook_CheckVelocity),     (const char *a3), (a3))
+KZ_BENCH_DISPATCH(OnCheckVelocityPost,      MV_HOOK_POST(MovementHook_CheckVelocity),    (const char *a3), (a3))
+KZ_BENCH_DISPATCH(OnDuck,                   MV_HOOK_PRE(MovementHook_Duck),              (), ())
+KZ_BENCH_DISPATCH(OnDuckPost,               MV_HOOK_POST(MovementHook_Duck),             (), ())
+KZ_BENCH_DISPATCH(OnCanUnduck,              MV_HOOK_PRE(MovementHook_CanUnduck),         (), ())
+KZ_BENCH_DISPATCH(OnCanUnduckPost,          MV_HOOK_POST(MovementHook_CanUnduck),        (bool &ret), (ret))
+KZ_BENCH_DISPATCH(OnLadderMove,             MV_HOOK_PRE(MovementHook_LadderMove),        (), ())
+KZ_BENCH_DISPATCH(OnLadderMovePost,         MV_HOOK_POST(MovementHook_LadderMove),       (), ())
+KZ_BENCH_DISPATCH(OnCheckJumpButton,        MV_HOOK_PRE(MovementHook_CheckJumpButton),   (), ())
+KZ_BENCH_DISPATCH(OnCheckJumpButtonPost,    MV_HOOK_POST(MovementHook_CheckJumpButton),  (), ())
+KZ_BENCH_DISPATCH(OnJump,                   MV_HOOK_PRE(MovementHook_OnJump),            (), ())
+KZ_BENCH_DISPATCH(OnJumpPost,               MV_HOOK_POST(MovementHook_OnJump),           (), ())
+KZ_BENCH_DISPATCH(OnAirMove,                MV_HOOK_PRE(MovementHook_AirMove),           (), ())
+KZ_BENCH_DISPATCH(OnAirMovePost,            MV_HOOK_POST(MovementHook_AirMove),          (), ())
+KZ_BENCH_DISPATCH(OnFriction,               MV_HOOK_PRE(MovementHook_Friction),          (), ())
+KZ_BENCH_DISPATCH(OnFrictionPost,           MV_HOOK_POST(MovementHook_Friction),         (), ())
+KZ_BENCH_DISPATCH(OnWalkMove,               MV_HOOK_PRE(MovementHook_WalkMove),          (), ())
+KZ_BENCH_DISPATCH(OnWalkMovePost,           MV_HOOK_POST(MovementHook_WalkMove),         (), ())
+KZ_BENCH_DISPATCH(OnCategorizePosition,     MV_HOOK_PRE(MovementHook_CategorizePosition),  (bool bStayOnGround), (bStayOnGround))
+KZ_BENCH_DISPATCH(OnCategorizePositionPost, MV_HOOK_POST(MovementHook_CategorizePosition), (bool bStayOnGround), (bStayOnGround))
+KZ_BENCH_DISPATCH(OnFinishGravity,          MV_HOOK_PRE(MovementHook_FinishGravity),     (), ())
+KZ_BENCH_DISPATCH(OnFinishGravityPost,      MV_HOOK_POST(MovementHook_FinishGravity),    (), ())
+KZ_BENCH_DISPATCH(OnCheckFalling,           MV_HOOK_PRE(MovementHook_CheckFalling),      (), ())
+KZ_BENCH_DISPATCH(OnCheckFallingPost,       MV_HOOK_POST(MovementHook_CheckFalling),     (), ())
+KZ_BENCH_DISPATCH(OnPostPlayerMove,         MV_HOOK_PRE(MovementHook_PostPlayerMove),    (), ())
+KZ_BENCH_DISPATCH(OnPostPlayerMovePost,     MV_HOOK_POST(MovementHook_PostPlayerMove),   (), ())
+KZ_BENCH_DISPATCH(OnPostThinkPost,          MV_HOOK_POST(MovementHook_PostThink),        (), ())
+// clang-format on
+
+#undef KZ_BENCH_DISPATCH
+
+void KZPlayer::OnPhysicsSimulate()
+{
+	MovementPlayer::OnPhysicsSimulate();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_PhysicsSimulate), OnPhysicsSimulate());
+}
+
+void KZPlayer::OnPhysicsSimulatePost()
+{
+	MovementPlayer::OnPhysicsSimulatePost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_PhysicsSimulate), OnPhysicsSimulatePost());
+}
+
+// The mode cvars are not applied, there are no convars to apply them to.
+void KZPlayer::OnProcessMovement()
+{
+	MovementPlayer::OnProcessMovement();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_ProcessMovement), OnProcessMovement());
+	this->jumpstatsService->OnProcessMovement();
+}
+
+void KZPlayer::OnProcessMovementPost()
+{
+	this->jumpstatsService->UpdateJump();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_ProcessMovement), OnProcessMovementPost());
+	this->jumpstatsService->OnProcessMovementPost();
+	MovementPlayer::OnProcessMovementPost();
+}
+
+void KZPlayer::OnAirAccelerate(Vector &wishdir, f32 &wishspeed, f32 &accel)
+{
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_AirAccelerate), OnAirAccelerate(wishdir, wishspeed, accel));
+	this->jumpstatsService->OnAirAccelerate();
+}
+
+void KZPlayer::OnAirAcceleratePost(Vector wishdir, f32 wishspeed, f32 accel)
+{
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_AirAccelerate), OnAirAcceleratePost(wishdir, wishspeed, accel));
+	this->jumpstatsService->OnAirAcceleratePost(wishdir, wishspeed, accel);
+}
+
+void KZPlayer::OnTryPlayerMove(Vector *pFirstDest, trace_t_s2 *pFirstTrace)
+{
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_TryPlayerMove), OnTryPlayerMove(pFirstDest, pFirstTrace));
+	this->jumpstatsService->OnTryPlayerMove();
+}
+
+void KZPlayer::OnTryPlayerMovePost(Vector *pFirstDest, trace_t_s2 *pFirstTrace)
+{
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_TryPlayerMove), OnTryPlayerMovePost(pFirstDest, pFirstTrace));
+	this->jumpstatsService->OnTryPlayerMovePost();
+}
+
+void KZPlayer::OnPostThink()
+{
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_PostThink), OnPostThink());
+	MovementPlayer::OnPostThink();
+}
+
+#undef KZ_SERVICE_DISPATCH
+
+void KZPlayer::OnStartTouchGround()
+{
+	this->jumpstatsService->EndJump();
+	this->modeService->OnStartTouchGround();
+	this->styleService->OnStartTouchGround();
+}
+
+void KZPlayer::OnStopTouchGround()
+{
+	this->jumpstatsService->AddJump();
+	this->modeService->OnStopTouchGround();
+	this->styleService->OnStopTouchGround();
+}
+
+void KZPlayer::OnChangeMoveType(MoveType_t oldMoveType)
+{
+	this->jumpstatsService->OnChangeMoveType(oldMoveType);
+	this->modeService->OnChangeMoveType(oldMoveType);
+	this->styleService->OnChangeMoveType(oldMoveType);
+}
+
+void KZPlayer::OnTeleport(const Vector *origin, const QAngle *angles, const Vector *velocity)
+{
+	this->jumpstatsService->InvalidateJumpstats("Teleported");
+	this->modeService->OnTeleport(origin, angles, velocity);
+}
+
+void KZPlayer::OnChangeTeamPost(i32 team) {}
+
+bool KZPlayer::OnTriggerStartTouch(CBaseTrigger *trigger)
+{
+	bool retValue = this->modeService->OnTriggerStartTouch(trigger);
+	retValue &= this->styleService->OnTriggerStartTouch(trigger);
+	return retValue;
+}
+
+bool KZPlayer::OnTriggerTouch(CBaseTrigger *trigger)
+{
+	bool retValue = this->modeService->OnTriggerTouch(trigger);
+	retValue &= this->styleService->OnTriggerTouch(trigger);
+	return retValue;
+}
+
+bool KZPlayer::OnTriggerEndTouch(CBaseTrigger *trigger)
+{
+	bool retValue = this->modeService->OnTriggerEndTouch(trigger);
+	retValue &= this->styleService->OnTriggerEndTouch(trigger);
+	return retValue;
+}
+
+// There are no triggers to touch.
+void KZPlayer::TouchTriggersAlongPath(const Vector &start, const Vector &end, const bbox_t &bounds) {}
+
+void KZPlayer::UpdateTriggerTouchList() {}
+
+// Nobody to print to.
+void KZPlayer::PrintConsole(bool addPrefix, bool includeSpectators, const char *format, ...) {}
+
+void KZPlayer::PrintChat(bool addPrefix, bool includeSpectators, const char *format, ...) {}
+
+void KZPlayer::PrintCentre(bool addPrefix, bool includeSpectators, const char *format, ...) {}
+
+void KZPlayer::PrintAlert(bool addPrefix, bool includeSpectators, const char *format, ...) {}
+
+void KZPlayer::PrintHTMLCentre(bool addPrefix, bool includeSpectators, const char *format, ...) {}
@@ -7,6 +7,7 @@
 #include "utils/gameconfig.h"
 
 #include "movement/movement.h"
+#include "movement/mv_perf.h"
 #include "kz/kz.h"
 #include "kz/hud/kz_hud.h"
 #include "kz/mode/kz_mode.h"
@@ -14,6 +15,7 @@
 #include "kz/style/kz_style.h"
 #include "kz/tip/kz_tip.h"
 #include "kz/option/kz_option.h"
+#include "kz/recorder/kz_recorder.h"
 
 #include "tier0/memdbgon.h"
 
@@ -37,11 +39,11 @@ bool KZPlugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t maxlen, bool
 	}
 	hooks::Initialize();
 	movement::InitDetours();
+	movement::perf::Init();
 
 	KZ::mode::InitModeManager();
 	KZ::style::InitStyleManager();
 	KZSpecService::Init();
-	KZHUDService::Init();
 	KZ::misc::RegisterCommands();
 	if (!KZ::mode::InitModeCvars())
 	{
@@ -54,6 +56,8 @@ bool KZPlugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t maxlen, bool
 
 	KZOptionService::InitOptions();
 	KZTipService::InitTips();
+	KZHUDService::Init();
+	KZRecorderService::Init();
 	return true;
 }
 
@@ -61,6 +65,7 @@ bool KZPlugin::Unload(char *error, size_t maxlen)
 {
 	this->unloading = true;
 	hooks::Cleanup();
+	KZRecorderService::Cleanup();
 	KZ::mode::EnableReplicatedModeCvars();
 	utils::Cleanup();
 	g_pKZModeManager->Cleanup();
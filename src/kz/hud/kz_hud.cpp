@@ -3,17 +3,33 @@
 #include "sdk/datatypes.h"
 #include "utils/utils.h"
 #include "utils/simplecmds.h"
+#include "utils/stringbuilder.h"
 
 #include "../timer/kz_timer.h"
 #include "tier0/memdbgon.h"
 
 #include "../checkpoint/kz_checkpoint.h"
+#include "../option/kz_option.h"
 
 internal KZHUDServiceTimerEventListener timerEventListener;
 
+// What each client was last sent, the panel of one player can go to several clients through spectating.
+struct KZHUDRecipientState
+{
+	i32 sourceSlot;
+	u32 centreVersion;
+	u32 alertVersion;
+	f64 lastSendTime;
+};
+
+internal KZHUDRecipientState recipientStates[MAXPLAYERS];
+internal f64 minRefreshInterval;
+
 void KZHUDService::Init()
 {
 	KZTimerService::RegisterEventListener(&timerEventListener);
+	f64 refreshRate = KZOptionService::GetOptionFloat("hudRefreshRate", KZ_DEFAULT_HUD_REFRESH_RATE);
+	minRefreshInterval = refreshRate > 0.0 ? 1.0 / refreshRate : 0.0;
 }
 
 void KZHUDService::Reset()
@@ -21,92 +37,124 @@ void KZHUDService::Reset()
 	this->showPanel = true;
 	this->timerStoppedTime = {};
 	this->currentTimeWhenTimerStopped = {};
+	this->panelState = {};
+	this->centreText[0] = 0;
+	this->alertText[0] = 0;
+	recipientStates[this->player->GetPlayerSlot().Get()] = {-1};
 }
 
-void KZHUDService::AddSpeedText(char *buffer, int size)
+// Rounds like the "%.0f" the panel used to print with, halfway values go to the even number.
+internal i32 RoundSpeed(f32 speed)
 {
-	char speed[128];
-	speed[0] = 0;
+	return (i32)rint(speed);
+}
+
+void KZHUDService::UpdatePanelState()
+{
+	KZHUDPanelState state {};
+
 	Vector velocity;
 	this->player->GetVelocity(&velocity);
+	state.speed = RoundSpeed(velocity.Length2D());
+	state.takeoffSpeed = -1;
 	// Keep the takeoff velocity on for a while after landing so the speed values flicker less.
-	if ((this->player->GetPawn()->m_fFlags & FL_ONGROUND && g_pKZUtils->GetServerGlobals()->curtime - this->player->landingTime > 0.07)
-		|| (this->player->GetPawn()->m_MoveType == MOVETYPE_LADDER && !player->IsButtonPressed(IN_JUMP)))
+	if (!((this->player->GetPawn()->m_fFlags & FL_ONGROUND && g_pKZUtils->GetServerGlobals()->curtime - this->player->landingTime > 0.07)
+		  || (this->player->GetPawn()->m_MoveType == MOVETYPE_LADDER && !player->IsButtonPressed(IN_JUMP))))
 	{
-		snprintf(speed, sizeof(speed), "Speed: %.0f", velocity.Length2D());
+		state.takeoffSpeed = RoundSpeed(this->player->takeoffVelocity.Length2D());
 	}
-	else
+
+	const InputBitMask_t keys[] = {IN_MOVELEFT, IN_FORWARD, IN_BACK, IN_MOVERIGHT, IN_DUCK, IN_JUMP};
+	for (u32 i = 0; i < Q_ARRAYSIZE(keys); i++)
 	{
-		snprintf(speed, sizeof(speed), "Speed: %.0f (%.0f)", velocity.Length2D(), this->player->takeoffVelocity.Length2D());
+		state.keys |= this->player->IsButtonPressed(keys[i]) << i;
 	}
-	V_strncat(buffer, speed, size);
-}
-
-void KZHUDService::AddKeyText(char *buffer, int size)
-{
-	char keys[128];
-	keys[0] = 0;
 
-	// clang-format off
+	state.currentCp = this->player->checkpointService->GetCurrentCpIndex();
+	state.cpCount = this->player->checkpointService->GetCheckpointCount();
+	state.teleportCount = this->player->checkpointService->GetTeleportCount();
 
-	snprintf(keys, sizeof(keys),
-		"Keys: %s %s %s %s %s %s",
-		this->player->IsButtonPressed(IN_MOVELEFT) ? "A" : "_",
-		this->player->IsButtonPressed(IN_FORWARD) ? "W" : "_",
-		this->player->IsButtonPressed(IN_BACK) ? "S" : "_",
-		this->player->IsButtonPressed(IN_MOVERIGHT) ? "D" : "_",
-		this->player->IsButtonPressed(IN_DUCK) ? "C" : "_",
-		this->player->IsButtonPressed(IN_JUMP) ? "J" : "_"
-	);
-
-	// clang-format on
+	state.time = -1;
+	state.timerRunning = this->player->timerService->GetTimerRunning();
+	state.timerPaused = this->player->timerService->GetPaused();
+	if (state.timerRunning || this->ShouldShowTimerAfterStop())
+	{
+		// clang-format off
 
-	V_strncat(buffer, keys, size);
-}
+		f64 time = state.timerRunning
+			? player->timerService->GetTime()
+			: this->currentTimeWhenTimerStopped;
 
-void KZHUDService::AddTeleText(char *buffer, int size)
-{
-	char tele[128];
-	tele[0] = 0;
+		// clang-format on
 
-	// clang-format off
+		state.time = RoundFloatToInt(time * 1000);
+	}
 
-	snprintf(tele, sizeof(tele),
-		"CP: %i/%i TPs: %i",
-		this->player->checkpointService->GetCurrentCpIndex(),
-		this->player->checkpointService->GetCheckpointCount(),
-		this->player->checkpointService->GetTeleportCount()
-	);
+	if (state == this->panelState && this->centreText[0])
+	{
+		return;
+	}
+	this->panelState = state;
 
-	// clang-format on
+	char buffer[256];
+	StringBuilder centre(buffer, sizeof(buffer));
+	this->AddTeleText(centre);
+	this->AddTimerText(centre);
+	if (V_strcmp(buffer, this->centreText))
+	{
+		V_strncpy(this->centreText, buffer, sizeof(this->centreText));
+		this->centreVersion++;
+	}
 
-	V_strncat(buffer, tele, size);
+	StringBuilder alert(buffer, sizeof(buffer));
+	this->AddSpeedText(alert);
+	alert.Append('\n');
+	this->AddKeyText(alert);
+	if (V_strcmp(buffer, this->alertText))
+	{
+		V_strncpy(this->alertText, buffer, sizeof(this->alertText));
+		this->alertVersion++;
+	}
 }
 
-void KZHUDService::AddTimerText(char *buffer, int size)
+void KZHUDService::AddSpeedText(StringBuilder &builder)
 {
-	char timer[128];
-	if (this->player->timerService->GetTimerRunning() || this->ShouldShowTimerAfterStop())
+	builder.Append("Speed: ").AppendInt(this->panelState.speed);
+	if (this->panelState.takeoffSpeed >= 0)
 	{
-		V_strncat(buffer, "\n", size);
-
-		// clang-format off
+		builder.Append(" (").AppendInt(this->panelState.takeoffSpeed).Append(')');
+	}
+}
 
-		f64 time = this->player->timerService->GetTimerRunning()
-			? player->timerService->GetTime()
-			: this->currentTimeWhenTimerStopped;
+void KZHUDService::AddKeyText(StringBuilder &builder)
+{
+	const char keyNames[] = {'A', 'W', 'S', 'D', 'C', 'J'};
+	builder.Append("Keys:");
+	for (u32 i = 0; i < sizeof(keyNames); i++)
+	{
+		builder.Append(' ').Append(this->panelState.keys & (1 << i) ? keyNames[i] : '_');
+	}
+}
 
-		// clang-format on
+void KZHUDService::AddTeleText(StringBuilder &builder)
+{
+	builder.Append("CP: ").AppendInt(this->panelState.currentCp).Append('/').AppendInt(this->panelState.cpCount);
+	builder.Append(" TPs: ").AppendInt(this->panelState.teleportCount);
+}
 
-		KZTimerService::FormatTime(time, timer, sizeof(timer));
-		V_strncat(buffer, timer, size);
-		if (!player->timerService->GetTimerRunning())
+void KZHUDService::AddTimerText(StringBuilder &builder)
+{
+	if (this->panelState.time >= 0)
+	{
+		builder.Append('\n');
+		KZTimerService::FormatTime(this->panelState.time / 1000.0, builder);
+		if (!this->panelState.timerRunning)
 		{
-			V_strncat(buffer, " (STOPPED)", size);
+			builder.Append(" (STOPPED)");
 		}
-		if (player->timerService->GetPaused())
+		if (this->panelState.timerPaused)
 		{
-			V_strncat(buffer, " (PAUSED)", size);
+			builder.Append(" (PAUSED)");
 		}
 	}
 }
@@ -118,19 +166,49 @@ void KZHUDService::DrawSpeedPanel()
 		return;
 	}
 
-	char buffer[1024];
-	buffer[0] = 0;
+	this->UpdatePanelState();
 
-	this->AddTeleText(buffer, sizeof(buffer));
-	this->AddTimerText(buffer, sizeof(buffer));
-	this->player->PrintCentre(false, true, buffer);
-	buffer[0] = 0;
-
-	this->AddSpeedText(buffer, sizeof(buffer));
-	V_strncat(buffer, "\n", sizeof(buffer));
-	this->AddKeyText(buffer, sizeof(buffer));
+	// Only send to clients that don't have the current text yet, at most at the configured rate.
+	u64 recipients = this->player->GetPrintRecipients(true);
+	i32 sourceSlot = this->player->GetPlayerSlot().Get();
+	f64 currentTime = g_pKZUtils->GetServerGlobals()->realtime;
+	u64 centreRecipients = 0;
+	u64 alertRecipients = 0;
+	for (i32 i = 0; i < MAXPLAYERS; i++)
+	{
+		if (!(recipients & (1ull << i)))
+		{
+			continue;
+		}
+		KZHUDRecipientState &state = recipientStates[i];
+		f64 elapsed = currentTime - state.lastSendTime;
+		// realtime can go back when the server restarts.
+		bool intervalPassed = elapsed < 0.0 || elapsed >= minRefreshInterval;
+		if (!intervalPassed)
+		{
+			continue;
+		}
+		bool keepAlive = elapsed < 0.0 || elapsed >= KZ_HUD_KEEPALIVE_INTERVAL;
+		bool sameSource = state.sourceSlot == sourceSlot;
+		bool sendCentre = keepAlive || !sameSource || state.centreVersion != this->centreVersion;
+		bool sendAlert = keepAlive || !sameSource || state.alertVersion != this->alertVersion;
+		if (!sendCentre && !sendAlert)
+		{
+			continue;
+		}
+		centreRecipients |= sendCentre ? 1ull << i : 0;
+		alertRecipients |= sendAlert ? 1ull << i : 0;
+		state = {sourceSlot, this->centreVersion, this->alertVersion, currentTime};
+	}
 
-	this->player->PrintAlert(false, true, buffer);
+	if (centreRecipients)
+	{
+		utils::QueuePrint(centreRecipients, HUD_PRINTCENTER, this->centreText);
+	}
+	if (alertRecipients)
+	{
+		utils::QueuePrint(alertRecipients, HUD_PRINTALERT, this->alertText);
+	}
 }
 
 void KZHUDService::TogglePanel()
@@ -141,6 +219,8 @@ void KZHUDService::TogglePanel()
 		utils::PrintAlert(this->player->GetController(), "");
 		utils::PrintCentre(this->player->GetController(), "");
 	}
+	// Send the panel again right away once it is back on.
+	recipientStates[this->player->GetPlayerSlot().Get()] = {-1};
 }
 
 void KZHUDService::OnTimerStopped(f64 currentTimeWhenTimerStopped)
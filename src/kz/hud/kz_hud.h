@@ -9,6 +9,26 @@ class KZHUDServiceTimerEventListener : public KZTimerServiceEventListener
 };
 
 #define KZ_HUD_TIMER_STOPPED_GRACE_TIME 3.0f
+// Unchanged panels are still resent this often so they don't fade out on the client.
+#define KZ_HUD_KEEPALIVE_INTERVAL 1.0
+
+// Everything the speed panel shows, at display precision.
+struct KZHUDPanelState
+{
+	i32 speed;
+	// -1 if the takeoff speed isn't shown.
+	i32 takeoffSpeed;
+	u8 keys;
+	i32 currentCp;
+	i32 cpCount;
+	i32 teleportCount;
+	// Milliseconds, -1 if the timer isn't shown.
+	i32 time;
+	bool timerRunning;
+	bool timerPaused;
+
+	bool operator==(const KZHUDPanelState &other) const = default;
+};
 
 class KZHUDService : public KZBaseService
 {
@@ -19,6 +39,13 @@ private:
 	f64 timerStoppedTime {};
 	f64 currentTimeWhenTimerStopped {};
 
+	// The panel is only rebuilt when its state changes, the versions tell recipients whether they are up to date.
+	KZHUDPanelState panelState {};
+	char centreText[256] {};
+	char alertText[256] {};
+	u32 centreVersion {};
+	u32 alertVersion {};
+
 public:
 	virtual void Reset() override;
 	static_global void Init();
@@ -41,8 +68,9 @@ public:
 	}
 
 private:
-	void AddSpeedText(char *buffer, int size);
-	void AddKeyText(char *buffer, int size);
-	void AddTeleText(char *buffer, int size);
-	void AddTimerText(char *buffer, int size);
+	void UpdatePanelState();
+	void AddSpeedText(StringBuilder &builder);
+	void AddKeyText(StringBuilder &builder);
+	void AddTeleText(StringBuilder &builder);
+	void AddTimerText(StringBuilder &builder);
 };
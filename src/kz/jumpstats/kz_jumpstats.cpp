@@ -1,6 +1,7 @@
 #include "../kz.h"
 #include "utils/utils.h"
 #include "utils/simplecmds.h"
+#include "utils/stringbuilder.h"
 
 #include "kz_jumpstats.h"
 #include "../mode/kz_mode.h"
@@ -9,7 +10,6 @@
 #include "tier0/memdbgon.h"
 
 #define IGNORE_JUMP_TIME                0.2f
-#define JS_EPSILON                      0.03125f
 #define JS_MAX_LADDERJUMP_OFFSET        2.0f
 #define JS_MAX_BHOP_GROUND_TIME         0.05f
 #define JS_MAX_DUCKBUG_RESET_TIME       0.05f
@@ -68,319 +68,64 @@ const char *distanceTierSounds[DISTANCETIER_COUNT] = {
 };
 
 /*
- * AACall stuff
+ * Jump stuff
  */
 
-f32 AACall::CalcIdealYaw(bool useRadians)
-{
-	f64 accelspeed;
-	if (this->wishspeed != 0)
-	{
-		accelspeed = this->accel * this->wishspeed * this->surfaceFriction * this->duration;
-	}
-	else
-	{
-		accelspeed = this->accel * this->maxspeed * this->surfaceFriction * this->duration;
-	}
-	if (accelspeed <= 0.0)
-	{
-		return useRadians ? M_PI : RAD2DEG(M_PI);
-	}
-
-	if (this->velocityPre.Length2D() == 0.0)
-	{
-		return 0.0;
-	}
-
-	const f64 wishspeedcapped = 30; // Hardcoding for now.
-	f64 tmp = wishspeedcapped - accelspeed;
-	if (tmp <= 0.0)
-	{
-		return useRadians ? M_PI / 2 : RAD2DEG(M_PI / 2);
-	}
-
-	f64 speed = this->velocityPre.Length2D();
-	if (tmp < speed)
-	{
-		return useRadians ? acos(tmp / speed) : RAD2DEG(acos(tmp / speed));
-	}
-
-	return 0.0;
-}
+void Jump::Start(KZPlayer *player)
+{
+	this->player = player;
+	this->strafes.RemoveAll();
+	this->aaCalls.RemoveAll();
+	this->totalDistance = 0.0f;
+	this->currentMaxSpeed = 0.0f;
+	this->currentMaxHeight = -16384.0f;
+	this->airtime = 0.0f;
+	this->deadAir = 0.0f;
+	this->overlap = 0.0f;
+	this->badAngles = 0.0f;
+	this->sync = 0.0f;
+	this->duckDuration = 0.0f;
+	this->duckEndDuration = 0.0f;
+	this->width = 0.0f;
+	this->gainEff = 0.0f;
+	this->hitHead = false;
+	this->valid = true;
+	this->ended = false;
+	this->aaCallsFull = false;
+	this->touchDuration = 0.0f;
+	this->invalidateReason[0] = '\0';
 
-f32 AACall::CalcMinYaw(bool useRadians)
-{
-	// Hardcoding max wishspeed. If your velocity is lower than 30, any direction will get you gain.
-	const f64 wishspeedcapped = 30;
-	if (this->velocityPre.Length2D() <= wishspeedcapped)
-	{
-		return 0.0;
-	}
-	return useRadians ? acos(30.0 / this->velocityPre.Length2D()) : RAD2DEG(acos(30.0 / this->velocityPre.Length2D()));
-}
-
-f32 AACall::CalcMaxYaw(bool useRadians)
-{
-	f32 gamma1, numer, denom;
-	gamma1 = AACall::CalcAccelSpeed(true);
-	f32 speed = this->velocityPre.Length2D();
-	if (gamma1 <= 60)
-	{
-		numer = -gamma1;
-		denom = 2 * speed;
-	}
-	else
-	{
-		numer = -30;
-		denom = speed;
-	}
-	if (denom < fabs(numer))
-	{
-		return this->CalcIdealYaw();
-	}
-
-	return useRadians ? acos(numer / denom) : RAD2DEG(acos(numer / denom));
-}
-
-f32 AACall::CalcAccelSpeed(bool tryMaxSpeed)
-{
-	if (tryMaxSpeed && this->wishspeed == 0)
-	{
-		return this->accel * this->maxspeed * this->surfaceFriction * this->duration;
-	}
-	return this->accel * this->wishspeed * this->surfaceFriction * this->duration;
-}
-
-f32 AACall::CalcIdealGain()
-{
-	// sqrt(v^2+a^2+2*v*a*cos(yaw)
-	// clang-format off
-	f32 idealSpeed = sqrt(this->velocityPre.Length2DSqr()
-		+ MIN(this->CalcAccelSpeed(true), 30)
-		* MIN(this->CalcAccelSpeed(true), 30)
-		+ 2
-		* MIN(this->CalcAccelSpeed(true), 30)
-		* this->velocityPre.Length2D()
-		* cos(this->CalcIdealYaw(true))
-	);
-	// clang-format on
-
-	return idealSpeed - this->velocityPre.Length2D();
-}
-
-/*
- * Strafe stuff
- */
-
-void Strafe::UpdateCollisionVelocityChange(f32 delta)
-{
-	if (delta < 0.0f)
-	{
-		this->externalLoss -= delta;
-	}
-	else
-	{
-		this->externalGain += delta;
-	}
+	this->takeoffOrigin = this->player->takeoffOrigin;
+	this->adjustedTakeoffOrigin = this->player->takeoffGroundOrigin;
+	this->takeoffVelocity = this->player->takeoffVelocity;
+	this->jumpType = this->player->jumpstatsService->DetermineJumpType();
 }
 
-void Strafe::End()
+void Jump::AddAACall(const AACall &call)
 {
-	FOR_EACH_VEC(this->aaCalls, i)
+	// Check before GetCurrentStrafe, which can start or end strafes.
+	if (this->aaCalls.Count() >= JS_MAX_AACALLS_PER_JUMP)
 	{
-		this->duration += this->aaCalls[i].duration;
-		// Calculate BA/DA/OL
-		if (this->aaCalls[i].wishspeed == 0)
-		{
-			u64 buttonBits = IN_FORWARD | IN_BACK | IN_MOVELEFT | IN_MOVERIGHT;
-			if (CInButtonState::IsButtonPressed(this->aaCalls[i].buttons, buttonBits))
-			{
-				this->overlap += this->aaCalls[i].duration;
-			}
-			else
-			{
-				this->deadAir += this->aaCalls[i].duration;
-			}
-		}
-		else if ((this->aaCalls[i].velocityPost - this->aaCalls[i].velocityPre).Length2D() <= JS_EPSILON)
-		{
-			// This gain could just be from quantized float stuff.
-			this->badAngles += this->aaCalls[i].duration;
-		}
-		// Calculate sync.
-		else if (this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D() > JS_EPSILON)
-		{
-			this->syncDuration += this->aaCalls[i].duration;
-		}
-
-		// Gain/loss.
-		this->maxGain += this->aaCalls[i].CalcIdealGain();
-		f32 speedDiff = this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D();
-		if (speedDiff > 0)
-		{
-			this->airGain += speedDiff;
-		}
-		else
-		{
-			this->airLoss += speedDiff;
-		}
-		f32 externalSpeedDiff = this->aaCalls[i].externalSpeedDiff;
-		if (externalSpeedDiff > 0)
-		{
-			this->externalGain += externalSpeedDiff;
-		}
-		else
-		{
-			this->externalLoss += externalSpeedDiff;
-		}
-		this->width += fabs(utils::GetAngleDifference(this->aaCalls[i].currentYaw, this->aaCalls[i].prevYaw, 180.0f));
+		this->aaCallsFull = true;
+		return;
 	}
-	this->CalcAngleRatioStats();
+	this->GetCurrentStrafe()->AddAACall(call);
+	this->lastAACall = call;
 }
 
-bool Strafe::CalcAngleRatioStats()
+void Jump::UpdateAACallPost(Vector wishdir, f32 wishspeed, f32 accel)
 {
-	this->arStats.available = false;
-	f32 totalDuration = 0.0f;
-	f32 totalRatios = 0.0f;
-	CUtlVector<f32> ratios;
-
-	QAngle angles, velAngles;
-	FOR_EACH_VEC(this->aaCalls, i)
+	if (this->aaCallsFull)
 	{
-		if (this->aaCalls[i].velocityPre.Length2D() == 0)
-		{
-			// Any angle should be a good angle here.
-			// ratio += 0;
-			continue;
-		}
-		VectorAngles(this->aaCalls[i].velocityPre, velAngles);
-
-		// If no attempt to gain speed was made, use the angle of the last call as a reference,
-		// and add yaw relative to last tick's yaw.
-		// If the velocity is 0 as well, then every angle is a perfect angle.
-		if (this->aaCalls[i].wishspeed != 0)
-		{
-			VectorAngles(this->aaCalls[i].wishdir, angles);
-		}
-		else
-		{
-			angles.y = this->aaCalls[i].prevYaw + utils::GetAngleDifference(this->aaCalls[i].currentYaw, this->aaCalls[i].prevYaw, 180.0f);
-		}
-
-		angles -= velAngles;
-		// Get the minimum, ideal, and max yaw for gain.
-		f32 minYaw = utils::NormalizeDeg(this->aaCalls[i].CalcMinYaw());
-		f32 idealYaw = utils::NormalizeDeg(this->aaCalls[i].CalcIdealYaw());
-		f32 maxYaw = utils::NormalizeDeg(this->aaCalls[i].CalcMaxYaw());
-
-		angles.y = utils::NormalizeDeg(angles.y);
-
-		if (this->turnstate == TURN_RIGHT || /* The ideal angle is calculated for left turns, we need to flip it for right turns. */
-			(this->turnstate == TURN_NONE
-			 && fabs(utils::GetAngleDifference(angles.y, idealYaw, 180.0f)) > fabs(utils::GetAngleDifference(-angles.y, idealYaw, 180.0f))))
-		// If we aren't turning at all, take the one closer to the ideal yaw.
-		{
-			angles.y = -angles.y;
-		}
-
-		// It is possible for the player to gain speed here, by pressing the opposite keys
-		// while still turning in the same direction, which results in actual gain...
-		// Usually this happens at the end of a strafe.
-		if (angles.y < 0 && this->aaCalls[i].velocityPost.Length2D() > this->aaCalls[i].velocityPre.Length2D())
-		{
-			angles.y = -angles.y;
-		}
-
-		// If the player yaw is way too off, they are probably pressing the wrong key and probably not turning too fast.
-		// So we shouldn't count them into the average calc.
-
-		//	utils::PrintConsoleAll("%f %f %f %f | %f / %f / %f | %f -> %f | %f %f | ws %f wd %f %f %f accel %f fraction %f",
-		//	minYaw, angles.y, idealYaw, maxYaw,
-		//	utils::GetAngleDifference(angles.y, minYaw, 180.0),
-		//	utils::GetAngleDifference(idealYaw, minYaw, 180.0),
-		//	utils::GetAngleDifference(maxYaw, minYaw, 180.0),
-		//	this->aaCalls[i].velocityPre.Length2D(), this->aaCalls[i].velocityPost.Length2D(),
-		//	this->aaCalls[i].velocityPre.x, this->aaCalls[i].velocityPre.y,
-		//	this->aaCalls[i].wishspeed,
-		//	this->aaCalls[i].wishdir.x,
-		//	this->aaCalls[i].wishdir.y,
-		//	this->aaCalls[i].wishdir.z,
-		//	this->aaCalls[i].accel,
-		//	this->aaCalls[i].duration * ENGINE_FIXED_TICK_RATE);
-		if (angles.y > maxYaw + 20.0f || angles.y < minYaw - 20.0f)
-		{
-		}
-		f32 gainRatio = (this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D()) / this->aaCalls[i].CalcIdealGain();
-		f32 fraction = this->aaCalls[i].duration * ENGINE_FIXED_TICK_RATE;
-		if (angles.y < minYaw)
-		{
-			totalRatios += -1 * fraction;
-			totalDuration += fraction;
-			ratios.AddToTail(-1 * fraction);
-			// utils::PrintConsoleAll("No Gain: GR = %f (%f / %f)", gainRatio, this->aaCalls[i].velocityPost.Length2D()
-			// - this->aaCalls[i].velocityPre.Length2D(), this->aaCalls[i].CalcIdealGain());
-			continue;
-		}
-		else if (angles.y < idealYaw)
-		{
-			totalRatios += (gainRatio - 1) * fraction;
-			totalDuration += fraction;
-			ratios.AddToTail((gainRatio - 1) * fraction);
-			// utils::PrintConsoleAll("Slow Gain: GR = %f (%f / %f)", gainRatio,
-			// this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D(),
-			// this->aaCalls[i].CalcIdealGain());
-		}
-		else if (angles.y < maxYaw)
-		{
-			totalRatios += (1 - gainRatio) * fraction;
-			totalDuration += fraction;
-			ratios.AddToTail((1 - gainRatio) * fraction);
-			// utils::PrintConsoleAll("Fast Gain: GR = %f (%f / %f)", gainRatio,
-			// this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D(),
-			// this->aaCalls[i].CalcIdealGain());
-		}
-		else
-		{
-			totalRatios += 1.0f;
-			totalDuration += fraction;
-			ratios.AddToTail(1.0f);
-			// utils::PrintConsoleAll("TooFast Gain: GR = %f (%f / %f)", gainRatio,
-			// this->aaCalls[i].velocityPost.Length2D() - this->aaCalls[i].velocityPre.Length2D(),
-			// this->aaCalls[i].CalcIdealGain());
-		}
-	}
-
-	// This can return nan if the duration is 0, this is intended...
-	if (totalDuration == 0.0f)
-	{
-		return false;
+		return;
 	}
-	ratios.Sort(this->SortFloat);
-	this->arStats.available = true;
-	this->arStats.average = totalRatios / totalDuration;
-	this->arStats.median = ratios[ratios.Count() / 2];
-	this->arStats.max = ratios[ratios.Count() - 1];
-	return true;
-}
-
-/*
- * Jump stuff
- */
-
-void Jump::Init()
-{
-	this->takeoffOrigin = this->player->takeoffOrigin;
-	this->adjustedTakeoffOrigin = this->player->takeoffGroundOrigin;
-	this->takeoffVelocity = this->player->takeoffVelocity;
-	this->jumpType = this->player->jumpstatsService->DetermineJumpType();
-}
-
-void Jump::UpdateAACallPost(Vector wishdir, f32 wishspeed, f32 accel)
-{
 	// Use the latest parameters, just in case they changed.
 	Strafe *strafe = this->GetCurrentStrafe();
-	AACall *call = &strafe->aaCalls.Tail();
+	if (strafe->GetAACallCount() == 0)
+	{
+		return;
+	}
+	AACall *call = &this->lastAACall;
 	QAngle currentAngle;
 	this->player->GetAngles(&currentAngle);
 	call->maxspeed = this->player->currentMoveData->m_flMaxSpeed;
@@ -393,6 +138,7 @@ void Jump::UpdateAACallPost(Vector wishdir, f32 wishspeed, f32 accel)
 	call->duration = g_pKZUtils->GetGlobals()->frametime;
 	call->ducking = this->player->GetMoveServices()->m_bDucked;
 	this->player->GetVelocity(&call->velocityPost);
+	strafe->UpdateLastAACall(*call);
 	strafe->UpdateStrafeMaxSpeed(call->velocityPost.Length2D());
 }
 
@@ -422,20 +168,21 @@ void Jump::End()
 
 	f32 gain = 0.0f;
 	f32 maxGain = 0.0f;
-	FOR_EACH_VEC(this->strafes, i)
+	// Strafes hold consecutive ranges of the calls, so this goes through them in order.
+	for (i32 i = 0; i < this->aaCalls.Count(); i++)
 	{
-		FOR_EACH_VEC(this->strafes[i].aaCalls, j)
+		if (this->aaCalls.flags[i] & AACALL_DUCKING)
 		{
-			if (this->strafes[i].aaCalls[j].ducking)
-			{
-				this->duckDuration += this->strafes[i].aaCalls[j].duration;
-				this->duckEndDuration += this->strafes[i].aaCalls[j].duration;
-			}
-			else
-			{
-				this->duckEndDuration = 0.0f;
-			}
+			this->duckDuration += this->aaCalls.duration[i];
+			this->duckEndDuration += this->aaCalls.duration[i];
+		}
+		else
+		{
+			this->duckEndDuration = 0.0f;
 		}
+	}
+	FOR_EACH_VEC(this->strafes, i)
+	{
 		this->width += this->strafes[i].GetWidth();
 		this->overlap += this->strafes[i].GetOverlapDuration();
 		this->deadAir += this->strafes[i].GetDeadAirDuration();
@@ -493,7 +240,7 @@ Strafe *Jump::GetCurrentStrafe()
 	// Always start with 1 strafe.
 	if (this->strafes.Count() == 0)
 	{
-		Strafe strafe = Strafe();
+		Strafe strafe = Strafe(&this->aaCalls);
 		strafe.turnstate = this->player->GetTurning();
 		this->strafes.AddToTail(strafe);
 	}
@@ -507,7 +254,7 @@ Strafe *Jump::GetCurrentStrafe()
 	{
 		this->strafes.Tail().End();
 		// Finish the previous strafe before adding a new strafe.
-		Strafe strafe = Strafe();
+		Strafe strafe = Strafe(&this->aaCalls);
 		strafe.turnstate = this->player->GetTurning();
 		this->strafes.AddToTail(strafe);
 	}
@@ -581,7 +328,7 @@ JumpType KZJumpstatsService::DetermineJumpType()
 	}
 	if (this->player->duckBugged)
 	{
-		if (this->jumps.Tail().GetOffset() < JS_EPSILON && this->jumps.Tail().GetJumpType() == JumpType_LongJump)
+		if (this->GetCurrentJump().GetOffset() < JS_EPSILON && this->GetCurrentJump().GetJumpType() == JumpType_LongJump)
 		{
 			return JumpType_Jumpbug;
 		}
@@ -593,13 +340,13 @@ JumpType KZJumpstatsService::DetermineJumpType()
 	if (this->HitBhop() && !this->HitDuckbugRecently())
 	{
 		// Check for no offset
-		if (this->jumps.Tail().DidHitHead())
+		if (this->GetCurrentJump().DidHitHead())
 		{
 			return JumpType_Invalid;
 		}
-		if (fabs(this->jumps.Tail().GetOffset()) < JS_EPSILON)
+		if (fabs(this->GetCurrentJump().GetOffset()) < JS_EPSILON)
 		{
-			switch (this->jumps.Tail().GetJumpType())
+			switch (this->GetCurrentJump().GetJumpType())
 			{
 				case JumpType_LongJump:
 					return JumpType_Bhop;
@@ -612,7 +359,7 @@ JumpType KZJumpstatsService::DetermineJumpType()
 			}
 		}
 		// Check for weird jump
-		if (this->jumps.Tail().GetJumpType() == JumpType_Fall && this->ValidWeirdJumpDropDistance())
+		if (this->GetCurrentJump().GetJumpType() == JumpType_Fall && this->ValidWeirdJumpDropDistance())
 		{
 			return JumpType_WeirdJump;
 		}
@@ -631,7 +378,7 @@ void KZJumpstatsService::Reset()
 	this->broadcastMinTier = DistanceTier_Godlike;
 	this->soundMinTier = DistanceTier_Godlike;
 	this->showJumpstats = true;
-	this->jumps.Purge();
+	this->jumpCount = 0;
 	this->jsAlways = {};
 	this->lastJumpButtonTime = {};
 	this->lastNoclipTime = {};
@@ -646,7 +393,7 @@ void KZJumpstatsService::OnProcessMovement()
 {
 	// Always ensure that the player has at least an ongoing jump.
 	// This is mostly to prevent crash, it's not a valid jump.
-	if (this->jumps.Count() == 0)
+	if (!this->HasJump())
 	{
 		this->AddJump();
 		this->InvalidateJumpstats("First jump");
@@ -682,7 +429,7 @@ bool KZJumpstatsService::HitDuckbugRecently()
 
 bool KZJumpstatsService::ValidWeirdJumpDropDistance()
 {
-	return this->jumps.Tail().GetOffset() > -1 * JS_MAX_WEIRDJUMP_FALL_OFFSET;
+	return this->GetCurrentJump().GetOffset() > -1 * JS_MAX_WEIRDJUMP_FALL_OFFSET;
 }
 
 bool KZJumpstatsService::GroundSpeedCappedRecently()
@@ -704,8 +451,7 @@ void KZJumpstatsService::OnAirAccelerate()
 	call.prevYaw = this->player->oldAngles.y;
 	call.curtime = g_pKZUtils->GetGlobals()->curtime;
 	call.tickcount = g_pKZUtils->GetGlobals()->tickcount;
-	Strafe *strafe = this->jumps.Tail().GetCurrentStrafe();
-	strafe->aaCalls.AddToTail(call);
+	this->GetCurrentJump().AddAACall(call);
 }
 
 void KZJumpstatsService::OnAirAcceleratePost(Vector wishdir, f32 wishspeed, f32 accel)
@@ -714,19 +460,21 @@ void KZJumpstatsService::OnAirAcceleratePost(Vector wishdir, f32 wishspeed, f32
 	{
 		return;
 	}
-	this->jumps.Tail().UpdateAACallPost(wishdir, wishspeed, accel);
+	this->GetCurrentJump().UpdateAACallPost(wishdir, wishspeed, accel);
 }
 
 void KZJumpstatsService::AddJump()
 {
-	this->jumps.AddToTail(Jump(this->player));
+	// The jump type depends on the previous jump, which is still the current one until jumpCount goes up.
+	this->jumps[this->jumpCount % JS_JUMP_HISTORY_SIZE].Start(this->player);
+	this->jumpCount++;
 }
 
 void KZJumpstatsService::UpdateJump()
 {
-	if (this->jumps.Count() > 0)
+	if (this->HasJump())
 	{
-		this->jumps.Tail().Update();
+		this->GetCurrentJump().Update();
 	}
 	this->DetectInvalidCollisions();
 	this->DetectInvalidGains();
@@ -735,9 +483,9 @@ void KZJumpstatsService::UpdateJump()
 
 void KZJumpstatsService::EndJump()
 {
-	if (this->jumps.Count() > 0)
+	if (this->HasJump())
 	{
-		Jump *jump = &this->jumps.Tail();
+		Jump *jump = &this->GetCurrentJump();
 
 		// Prevent stats being calculated twice.
 		if (jump->AlreadyEnded())
@@ -818,146 +566,138 @@ void KZJumpstatsService::PrintJumpToChat(KZPlayer *target, Jump *jump)
 
 	f32 flooredDist = floor(jump->GetDistance() * 10) / 10;
 
-	// clang-format off
-	jump->GetJumpPlayer()->PrintChat(true, true,
-		"%s%s{grey}: %s%.1f {grey}| {olive}%i {grey}Strafes | {olive}%.0f%% {grey}Sync | {olive}%.2f {grey}Pre | {olive}%.2f {grey}Max\n\
-		{grey}BA {olive}%.0f%% {grey}| OL {olive}%.0f%% {grey}| DA {olive}%.0f%% {grey}| {olive}%.1f {grey}Deviation | {olive}%.1f {grey}Width | {olive}%.2f {grey}Height",
-		jumpColor,
-		jumpTypeShortStr[jump->GetJumpType()],
-		jumpColor,
-		flooredDist,
-		jump->strafes.Count(),
-		jump->GetSync() * 100.0f,
-		jump->GetJumpPlayer()->takeoffVelocity.Length2D(),
-		jump->GetMaxSpeed(),
-		jump->GetBadAngles() * 100,
-		jump->GetOverlap() * 100,
-		jump->GetDeadAir() * 100,
-		jump->GetDeviation(),
-		jump->GetWidth(),
-		jump->GetMaxHeight()
-	);
-	// clang-format on
+	char buffer[512];
+	StringBuilder builder(buffer, sizeof(buffer));
+	builder.Append(jumpColor).Append(jumpTypeShortStr[jump->GetJumpType()]).Append("{grey}: ");
+	builder.Append(jumpColor).AppendFloat(flooredDist, 1).Append(" {grey}| {olive}");
+	builder.AppendInt(jump->strafes.Count()).Append(" {grey}Strafes | {olive}");
+	builder.AppendFloat(jump->GetSync() * 100.0f, 0).Append("% {grey}Sync | {olive}");
+	builder.AppendFloat(jump->GetJumpPlayer()->takeoffVelocity.Length2D(), 2).Append(" {grey}Pre | {olive}");
+	builder.AppendFloat(jump->GetMaxSpeed(), 2).Append(" {grey}Max\n\t\t{grey}BA {olive}");
+	builder.AppendFloat(jump->GetBadAngles() * 100, 0).Append("% {grey}| OL {olive}");
+	builder.AppendFloat(jump->GetOverlap() * 100, 0).Append("% {grey}| DA {olive}");
+	builder.AppendFloat(jump->GetDeadAir() * 100, 0).Append("% {grey}| {olive}");
+	builder.AppendFloat(jump->GetDeviation(), 1).Append(" {grey}Deviation | {olive}");
+	builder.AppendFloat(jump->GetWidth(), 1).Append(" {grey}Width | {olive}");
+	builder.AppendFloat(jump->GetMaxHeight(), 2).Append(" {grey}Height");
+	jump->GetJumpPlayer()->PrintChat(true, true, "%s", buffer);
 }
 
 void KZJumpstatsService::PrintJumpToConsole(KZPlayer *target, Jump *jump)
 {
-	char invalidateReason[256] {};
+	KZPlayer *jumpPlayer = jump->GetJumpPlayer();
+	char buffer[512];
+
+	StringBuilder builder(buffer, sizeof(buffer));
+	builder.Append(jumpPlayer->GetController()->m_iszPlayerName()).Append(" jumped ").AppendFloat(jump->GetDistance(), 4);
+	builder.Append(" units with a ").Append(jumpTypeStr[jump->GetJumpType()]).Append(' ');
 	if (jump->invalidateReason[0] != '\0')
 	{
-		V_snprintf(invalidateReason, sizeof(invalidateReason), "(%s)", jump->invalidateReason);
-	}
-
+		builder.Append('(').Append(jump->invalidateReason).Append(')');
+	}
+	jumpPlayer->PrintConsole(false, true, "%s", buffer);
+
+	builder = StringBuilder(buffer, sizeof(buffer));
+	builder.Append(jumpPlayer->modeService->GetModeShortName()).Append(" | ");
+	builder.Append(jumpPlayer->styleService->GetStyleShortName()).Append(" | ");
+	builder.AppendInt(jump->strafes.Count()).Append(" Strafes | ");
+	builder.AppendFloat(jump->GetSync() * 100.0f, 1).Append("% Sync | ");
+	builder.AppendFloat(jump->GetTakeoffSpeed(), 2).Append(" Pre | ");
+	builder.AppendFloat(jump->GetMaxSpeed(), 2).Append(" Max | ");
+	builder.AppendFloat(jump->GetBadAngles() * 100.0f, 0).Append("% BA | ");
+	builder.AppendFloat(jump->GetOverlap() * 100.0f, 0).Append("% OL | ");
+	builder.AppendFloat(jump->GetDeadAir() * 100.0f, 0).Append("% DA | ");
+	builder.AppendFloat(jump->GetMaxHeight(), 2).Append(" Height");
+	jumpPlayer->PrintConsole(false, true, "%s", buffer);
+
+	builder = StringBuilder(buffer, sizeof(buffer));
+	builder.AppendFloat(jump->GetGainEfficiency() * 100.0f, 0).Append("% GainEff | ");
+	builder.AppendFloat(jump->GetAirPath(), 3).Append(" Airpath | ");
+	builder.AppendFloat(jump->GetDeviation(), 1).Append(" Deviation | ");
+	builder.AppendFloat(jump->GetWidth(), 1).Append(" Width | ");
+	builder.AppendFloat(jumpPlayer->landingTimeActual - jumpPlayer->takeoffTime, 4).Append(" Airtime | ");
+	builder.AppendFloat(jump->GetOffset(), 1).Append(" Offset | ");
+	builder.AppendFloat(jump->GetDuckTime(true), 2).Append('/').AppendFloat(jump->GetDuckTime(false), 2).Append(" Crouched");
+	jumpPlayer->PrintConsole(false, true, "%s", buffer);
+
+	// Right aligned column headers of the strafe table.
 	// clang-format off
-
-	jump->GetJumpPlayer()->PrintConsole(false, true,
-		"%s jumped %.4f units with a %s %s",
-		jump->GetJumpPlayer()->GetController()->m_iszPlayerName(),
-		jump->GetDistance(),
-		jumpTypeStr[jump->GetJumpType()],
-		invalidateReason
-	);
-
-	jump->GetJumpPlayer()->PrintConsole(false, true,
-		"%s | %s | %i Strafes | %.1f%% Sync | %.2f Pre | %.2f Max | %.0f%% BA | %.0f%% OL | %.0f%% DA | %.2f Height",
-		jump->GetJumpPlayer()->modeService->GetModeShortName(),
-		jump->GetJumpPlayer()->styleService->GetStyleShortName(),
-		jump->strafes.Count(),
-		jump->GetSync() * 100.0f,
-		jump->GetTakeoffSpeed(),
-		jump->GetMaxSpeed(),
-		jump->GetBadAngles() * 100.0f,
-		jump->GetOverlap() * 100.0f,
-		jump->GetDeadAir() * 100.0f,
-		jump->GetMaxHeight()
-	);
-
-	jump->GetJumpPlayer()->PrintConsole(false, true,
-		"%.0f%% GainEff | %.3f Airpath | %.1f Deviation | %.1f Width | %.4f Airtime | %.1f Offset | %.2f/%.2f Crouched",
-		jump->GetGainEfficiency() * 100.0f,
-		jump->GetAirPath(),
-		jump->GetDeviation(),
-		jump->GetWidth(),
-		jump->GetJumpPlayer()->landingTimeActual - jump->GetJumpPlayer()->takeoffTime,
-		jump->GetOffset(),
-		jump->GetDuckTime(true),
-		jump->GetDuckTime(false)
-	);
-
-	jump->GetJumpPlayer()->PrintConsole(false, true,
-		"#.%5s %9s %17s %11s %7s %7s %4s %4s %9s %7s %s",
-		"Sync",
-		"Gain",
-		"Loss",
-		"Max",
-		"Air",
-		"BA",
-		"OL",
-		"DA",
-		"AvgGain",
-		"GainEff",
-		"AngRatio(Avg/Med/Max)"
-	);
+	const struct
+	{
+		const char *name;
+		u32 width;
+	} columns[] = {
+		{"Sync", 5}, {"Gain", 9}, {"Loss", 17}, {"Max", 11}, {"Air", 7}, {"BA", 7},
+		{"OL", 4}, {"DA", 4}, {"AvgGain", 9}, {"GainEff", 7}, {"AngRatio(Avg/Med/Max)", 0}
+	};
+	// clang-format on
+	builder = StringBuilder(buffer, sizeof(buffer));
+	builder.Append("#.");
+	for (u32 i = 0; i < sizeof(columns) / sizeof(columns[0]); i++)
+	{
+		if (i > 0)
+		{
+			builder.Append(' ');
+		}
+		u32 mark = builder.Length();
+		builder.Append(columns[i].name).AlignRight(mark, columns[i].width);
+	}
+	jumpPlayer->PrintConsole(false, true, "%s", buffer);
 
 	FOR_EACH_VEC(jump->strafes, i)
 	{
-		char syncString[16], gainString[16], lossString[16], externalGainString[16], externalLossString[16], maxString[16], durationString[16];
-		char badAngleString[16], overlapString[16], deadAirString[16], avgGainString[16], gainEffString[16];
-		char angRatioString[32];
-		V_snprintf(syncString, sizeof(syncString), "%.0f%%", jump->strafes[i].GetSync() * 100.0f);
-		V_snprintf(gainString, sizeof(gainString), "%.2f", jump->strafes[i].GetGain());
-		V_snprintf(externalGainString, sizeof(externalGainString), "(+%.2f)", fabs(jump->strafes[i].GetGain(true)));
-		V_snprintf(lossString, sizeof(lossString), "-%.2f", fabs(jump->strafes[i].GetLoss()));
-		V_snprintf(externalLossString, sizeof(externalLossString), "(-%.2f)", fabs(jump->strafes[i].GetLoss(true)));
-		V_snprintf(maxString, sizeof(maxString), "%.2f", jump->strafes[i].GetStrafeMaxSpeed());
-		V_snprintf(durationString, sizeof(durationString), "%.3f", jump->strafes[i].GetStrafeDuration());
-		V_snprintf(badAngleString, sizeof(badAngleString), "%.0f%%", jump->strafes[i].GetBadAngleDuration() / jump->strafes[i].GetStrafeDuration() * 100.0f);
-		V_snprintf(overlapString, sizeof(overlapString), "%.0f%%", jump->strafes[i].GetOverlapDuration() / jump->strafes[i].GetStrafeDuration() * 100.0f);
-		V_snprintf(deadAirString, sizeof(deadAirString), "%.0f%%", jump->strafes[i].GetDeadAirDuration() / jump->strafes[i].GetStrafeDuration() * 100.0f);
-		V_snprintf(avgGainString, sizeof(avgGainString), "%.2f", jump->strafes[i].GetGain() / jump->strafes[i].GetStrafeDuration() * ENGINE_FIXED_TICK_INTERVAL);
-		V_snprintf(gainEffString, sizeof(gainEffString), "%.0f%%", jump->strafes[i].GetGain() / jump->strafes[i].GetMaxGain() * 100.0f);
-
-		if (jump->strafes[i].arStats.available)
-		{
-			V_snprintf(angRatioString, sizeof(angRatioString),
-				"%.2f/%.2f/%.2f",
-				jump->strafes[i].arStats.average,
-				jump->strafes[i].arStats.median,
-				jump->strafes[i].arStats.max
-			);
+		Strafe &strafe = jump->strafes[i];
+		builder = StringBuilder(buffer, sizeof(buffer));
+		u32 mark;
+
+		builder.AppendInt(i + 1).Append('.');
+		mark = builder.Length();
+		builder.AppendFloat(strafe.GetSync() * 100.0f, 0).Append('%').AlignRight(mark, 5).Append(' ');
+
+		mark = builder.Length();
+		builder.AppendFloat(strafe.GetGain(), 2).AlignRight(mark, 7);
+		mark = builder.Length();
+		builder.Append("(+").AppendFloat(fabs(strafe.GetGain(true)), 2).Append(')').AlignLeft(mark, 10).Append(' ');
+
+		mark = builder.Length();
+		builder.Append('-').AppendFloat(fabs(strafe.GetLoss()), 2).AlignRight(mark, 7);
+		mark = builder.Length();
+		builder.Append("(-").AppendFloat(fabs(strafe.GetLoss(true)), 2).Append(')').AlignLeft(mark, 10).Append(' ');
+
+		mark = builder.Length();
+		builder.AppendFloat(strafe.GetStrafeMaxSpeed(), 2).AlignLeft(mark, 7).Append(' ');
+		mark = builder.Length();
+		builder.AppendFloat(strafe.GetStrafeDuration(), 3).AlignLeft(mark, 8).Append(' ');
+		mark = builder.Length();
+		builder.AppendFloat(strafe.GetBadAngleDuration() / strafe.GetStrafeDuration() * 100.0f, 0).Append('%').AlignLeft(mark, 4).Append(' ');
+		mark = builder.Length();
+		builder.AppendFloat(strafe.GetOverlapDuration() / strafe.GetStrafeDuration() * 100.0f, 0).Append('%').AlignLeft(mark, 4).Append(' ');
+		mark = builder.Length();
+		builder.AppendFloat(strafe.GetDeadAirDuration() / strafe.GetStrafeDuration() * 100.0f, 0).Append('%').AlignLeft(mark, 4).Append(' ');
+		mark = builder.Length();
+		builder.AppendFloat(strafe.GetGain() / strafe.GetStrafeDuration() * ENGINE_FIXED_TICK_INTERVAL, 2).AlignLeft(mark, 7).Append(' ');
+		mark = builder.Length();
+		builder.AppendFloat(strafe.GetGain() / strafe.GetMaxGain() * 100.0f, 0).Append('%').AlignLeft(mark, 7).Append(' ');
+
+		if (strafe.arStats.available)
+		{
+			builder.AppendFloat(strafe.arStats.average, 2).Append('/');
+			builder.AppendFloat(strafe.arStats.median, 2).Append('/');
+			builder.AppendFloat(strafe.arStats.max, 2);
 		}
 		else
 		{
-			V_snprintf(angRatioString, sizeof(angRatioString), "N/A");
+			builder.Append("N/A");
 		}
-
-		jump->GetJumpPlayer()->PrintConsole(false, true,
-			"%i.%5s %7s%-10s %7s%-10s %-7s %-8s %-4s %-4s %-4s %-7s %-7s %s",
-			i + 1,
-			syncString,
-			gainString,
-			externalGainString,
-			lossString,
-			externalLossString,
-			maxString,
-			durationString,
-			badAngleString,
-			overlapString,
-			deadAirString,
-			avgGainString,
-			gainEffString,
-			angRatioString
-		);
+		jumpPlayer->PrintConsole(false, true, "%s", buffer);
 	}
-
-	// clang-format on
 }
 
 void KZJumpstatsService::InvalidateJumpstats(const char *reason)
 {
-	if (this->jumps.Count() > 0 && !this->jumps.Tail().AlreadyEnded())
+	if (this->HasJump() && !this->GetCurrentJump().AlreadyEnded())
 	{
-		this->jumps.Tail().Invalidate(reason);
+		this->GetCurrentJump().Invalidate(reason);
 	}
 }
 
@@ -1013,7 +753,7 @@ void KZJumpstatsService::DetectNoclip()
 
 void KZJumpstatsService::DetectEdgebug()
 {
-	if (this->jumps.Count() == 0 || !this->jumps.Tail().IsValid())
+	if (!this->HasJump() || !this->GetCurrentJump().IsValid())
 	{
 		return;
 	}
@@ -1028,22 +768,22 @@ void KZJumpstatsService::DetectEdgebug()
 
 void KZJumpstatsService::DetectInvalidCollisions()
 {
-	if (this->jumps.Count() == 0 || !this->jumps.Tail().IsValid())
+	if (!this->HasJump() || !this->GetCurrentJump().IsValid())
 	{
 		return;
 	}
 	if (this->player->IsCollidingWithWorld())
 	{
-		this->jumps.Tail().touchDuration += g_pKZUtils->GetGlobals()->frametime;
+		this->GetCurrentJump().touchDuration += g_pKZUtils->GetGlobals()->frametime;
 		// Headhit invadidates following bhops but not the current jump,
 		// while other collisions do after a certain duration.
-		if (this->jumps.Tail().touchDuration > JS_TOUCH_GRACE_PERIOD)
+		if (this->GetCurrentJump().touchDuration > JS_TOUCH_GRACE_PERIOD)
 		{
 			this->InvalidateJumpstats("Invalid collisions");
 		}
 		if (this->player->moveDataPre.m_vecVelocity.z > 0.0f)
 		{
-			this->jumps.Tail().MarkHitHead();
+			this->GetCurrentJump().MarkHitHead();
 		}
 	}
 }
@@ -1093,12 +833,12 @@ void KZJumpstatsService::OnTryPlayerMove()
 
 void KZJumpstatsService::OnTryPlayerMovePost()
 {
-	if (this->jumps.Count() == 0 || this->jumps.Tail().strafes.Count() == 0)
+	if (!this->HasJump() || this->GetCurrentJump().strafes.Count() == 0)
 	{
 		return;
 	}
 	f32 velocity = this->player->currentMoveData->m_vecVelocity.Length2D() - this->tpmVelocity.Length2D();
-	this->jumps.Tail().strafes.Tail().UpdateCollisionVelocityChange(velocity);
+	this->GetCurrentJump().strafes.Tail().UpdateCollisionVelocityChange(velocity);
 	this->DetectEdgebug();
 }
 
@@ -6,6 +6,12 @@
 
 #include "../kz.h"
 
+#define JS_EPSILON 0.03125f
+// Jumps kept per player. Only the latest one and the one before it are ever looked at.
+#define JS_JUMP_HISTORY_SIZE 4
+// Longer jumps stop recording airstrafes, they are far past any valid airtime anyway.
+#define JS_MAX_AACALLS_PER_JUMP 2048
+
 class KZPlayer;
 
 enum JumpType
@@ -39,6 +45,7 @@ enum DistanceTier : u8
 extern const char *jumpTypeShortStr[JUMPTYPE_COUNT];
 extern const char *distanceTierSounds[DISTANCETIER_COUNT];
 
+// One AirAccelerate call, filled in over the pre and post hooks before it goes into an AACallBuffer.
 class AACall
 {
 public:
@@ -58,22 +65,71 @@ public:
 	f32 curtime {};
 	i32 tickcount {};
 	bool ducking {};
+};
+
+#define AACALL_MOVE_KEYS (1 << 0)
+#define AACALL_DUCKING   (1 << 1)
 
+/*
+ * The AA calls of a jump, stored one array per field so that strafes can be analysed several calls at a time.
+ * Only what the analysis reads is kept: yaws and 2D vectors, with the buttons reduced to AACALL_* flags.
+ */
+class AACallBuffer
+{
 public:
-	f32 CalcIdealYaw(bool useRadians = false);
-	f32 CalcMinYaw(bool useRadians = false);
-	f32 CalcMaxYaw(bool useRadians = false);
-	f32 CalcAccelSpeed(bool tryMaxSpeed = false);
-	f32 CalcIdealGain();
+	CUtlVector<f32> externalSpeedDiff;
+	CUtlVector<f32> prevYaw;
+	CUtlVector<f32> currentYaw;
+	CUtlVector<f32> wishdirX;
+	CUtlVector<f32> wishdirY;
+	CUtlVector<f32> maxspeed;
+	CUtlVector<f32> wishspeed;
+	CUtlVector<f32> accel;
+	CUtlVector<f32> surfaceFriction;
+	CUtlVector<f32> duration;
+	CUtlVector<f32> velocityPreX;
+	CUtlVector<f32> velocityPreY;
+	CUtlVector<f32> velocityPostX;
+	CUtlVector<f32> velocityPostY;
+	CUtlVector<u8> flags;
+	// Angle ratios of the strafes, see Strafe::AddAngleRatio. A strafe never has more ratios than calls.
+	CUtlVector<f32> lowerRatios;
+	CUtlVector<f32> upperRatios;
+
+	i32 Count()
+	{
+		return this->duration.Count();
+	}
+
+	void RemoveAll();
+	void AddToTail(const AACall &call);
+	void Set(i32 index, const AACall &call);
 };
 
 class Strafe
 {
 public:
-	CCopyableUtlVector<AACall> aaCalls;
+	Strafe() {}
+
+	Strafe(AACallBuffer *aaCallBuffer) : aaCallBuffer(aaCallBuffer), firstAACall(aaCallBuffer->Count()) {}
+
 	TurnState turnstate;
 
 private:
+	// The calls of a strafe are a contiguous range in the buffer of its jump, only the last strafe of a jump gets new calls.
+	AACallBuffer *aaCallBuffer {};
+	i32 firstAACall {};
+	i32 numAACalls {};
+
+	// Running angle ratio stats, up to date with the first numRatioCalls calls for ratioTurnState.
+	TurnState ratioTurnState {};
+	i32 numRatioCalls {};
+	i32 numLowerRatios {};
+	i32 numUpperRatios {};
+	f32 ratioSum {};
+	f32 ratioDuration {};
+	f32 maxRatio {};
+
 	f32 duration {};
 
 	f32 badAngles {};
@@ -100,6 +156,21 @@ private:
 public:
 	void End();
 
+	void AddAACall(const AACall &call)
+	{
+		Assert(this->firstAACall + this->numAACalls == this->aaCallBuffer->Count());
+		this->aaCallBuffer->AddToTail(call);
+		this->numAACalls++;
+	}
+
+	// For the post hook, which completes the call added in the pre hook.
+	void UpdateLastAACall(const AACall &call);
+
+	i32 GetAACallCount()
+	{
+		return this->numAACalls;
+	}
+
 	f32 GetStrafeDuration()
 	{
 		return this->duration;
@@ -158,16 +229,6 @@ public:
 		return this->strafeMaxSpeed;
 	}
 
-	// Calculate the ratio for each strafe.
-	// The ratio is 0 if the angle is perfect, closer to -100 if it's too slow
-	// Closer to 100 if it passes the optimal value.
-	// Note: if the player jumps in place, no velocity and no attempt to move at all, any angle will be "perfect".
-	// Returns false if there is no available stats.
-	internal int SortFloat(const f32 *a, const f32 *b)
-	{
-		return *a > *b;
-	}
-
 	struct AngleRatioStats
 	{
 		bool available;
@@ -178,12 +239,23 @@ public:
 
 	AngleRatioStats arStats;
 
+	// Calculate the ratio for each strafe.
+	// The ratio is 0 if the angle is perfect, closer to -100 if it's too slow
+	// Closer to 100 if it passes the optimal value.
+	// Note: if the player jumps in place, no velocity and no attempt to move at all, any angle will be "perfect".
+	// The ratios are added up as the calls come in, this only adds calls that are still missing and reads the result.
+	// Returns false if there is no available stats.
 	bool CalcAngleRatioStats();
 
 	void UpdateStrafeMaxSpeed(f32 speed)
 	{
 		this->strafeMaxSpeed = MAX(this->strafeMaxSpeed, speed);
 	}
+
+private:
+	// Adds the calls that aren't in the angle ratio stats yet.
+	void UpdateAngleRatios();
+	void AddAngleRatio(i32 index);
 };
 
 class Jump
@@ -217,21 +289,26 @@ private:
 	bool hitHead {};
 	bool valid = true;
 	bool ended {};
+	bool aaCallsFull {};
 
 public:
-	CCopyableUtlVector<Strafe> strafes;
+	// Jumps live in the history ring of their player and are reused, so these only grow until they fit a typical jump.
+	CUtlVector<Strafe> strafes;
+	AACallBuffer aaCalls;
+	// Copy of the latest call in aaCalls, for the post hook to complete.
+	AACall lastAACall;
 	f32 touchDuration {};
 	char invalidateReason[256] {};
 
 public:
 	Jump() {}
 
-	Jump(KZPlayer *player) : player(player)
-	{
-		Init();
-	}
+	Jump(const Jump &) = delete;
+	Jump &operator=(const Jump &) = delete;
 
-	void Init();
+	// Starts a new jump in this slot, dropping the previous one.
+	void Start(KZPlayer *player);
+	void AddAACall(const AACall &call);
 	void UpdateAACallPost(Vector wishdir, f32 wishspeed, f32 accel);
 	void Update();
 	void End();
@@ -343,7 +420,6 @@ class KZJumpstatsService : public KZBaseService
 public:
 	KZJumpstatsService(KZPlayer *player) : KZBaseService(player)
 	{
-		this->jumps = CUtlVector<Jump>(1, 0);
 		this->tpmVelocity = Vector(0, 0, 0);
 	}
 
@@ -356,7 +432,9 @@ private:
 	bool jsAlways {};
 	bool showJumpstats {}; // Need change to type
 
-	CUtlVector<Jump> jumps;
+	Jump jumps[JS_JUMP_HISTORY_SIZE];
+	// Jumps started since the last reset, the latest one is at (jumpCount - 1) % JS_JUMP_HISTORY_SIZE.
+	u32 jumpCount {};
 	f32 lastJumpButtonTime {};
 	f32 lastNoclipTime {};
 	f32 lastDuckbugTime {};
@@ -406,6 +484,16 @@ public:
 
 	void TrackJumpstatsVariables();
 
+	bool HasJump()
+	{
+		return this->jumpCount > 0;
+	}
+
+	Jump &GetCurrentJump()
+	{
+		return this->jumps[(this->jumpCount - 1) % JS_JUMP_HISTORY_SIZE];
+	}
+
 	void AddJump();
 	void UpdateJump();
 	void EndJump();
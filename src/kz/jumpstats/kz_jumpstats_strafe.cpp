@@ -0,0 +1,555 @@
+#include "kz_jumpstats.h"
+#include "utils/utils.h"
+
+#include <algorithm>
+#include <functional>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define JUMPSTATS_SSE2
+#endif
+
+#include "tier0/memdbgon.h"
+
+// Airstrafe math, kept apart from the service so that it can be built without the engine (see src/bench).
+
+// Hardcoding max wishspeed. If your velocity is lower than 30, any direction will get you gain.
+#define JS_WISHSPEED_CAPPED 30.0f
+
+/*
+ * AACall stuff
+ */
+
+void AACallBuffer::RemoveAll()
+{
+	this->externalSpeedDiff.RemoveAll();
+	this->prevYaw.RemoveAll();
+	this->currentYaw.RemoveAll();
+	this->wishdirX.RemoveAll();
+	this->wishdirY.RemoveAll();
+	this->maxspeed.RemoveAll();
+	this->wishspeed.RemoveAll();
+	this->accel.RemoveAll();
+	this->surfaceFriction.RemoveAll();
+	this->duration.RemoveAll();
+	this->velocityPreX.RemoveAll();
+	this->velocityPreY.RemoveAll();
+	this->velocityPostX.RemoveAll();
+	this->velocityPostY.RemoveAll();
+	this->flags.RemoveAll();
+	this->lowerRatios.RemoveAll();
+	this->upperRatios.RemoveAll();
+}
+
+void AACallBuffer::AddToTail(const AACall &call)
+{
+	this->externalSpeedDiff.AddToTail();
+	this->prevYaw.AddToTail();
+	this->currentYaw.AddToTail();
+	this->wishdirX.AddToTail();
+	this->wishdirY.AddToTail();
+	this->maxspeed.AddToTail();
+	this->wishspeed.AddToTail();
+	this->accel.AddToTail();
+	this->surfaceFriction.AddToTail();
+	this->duration.AddToTail();
+	this->velocityPreX.AddToTail();
+	this->velocityPreY.AddToTail();
+	this->velocityPostX.AddToTail();
+	this->velocityPostY.AddToTail();
+	this->flags.AddToTail();
+	this->lowerRatios.AddToTail();
+	this->upperRatios.AddToTail();
+	this->Set(this->Count() - 1, call);
+}
+
+void AACallBuffer::Set(i32 index, const AACall &call)
+{
+	this->externalSpeedDiff[index] = call.externalSpeedDiff;
+	this->prevYaw[index] = call.prevYaw;
+	this->currentYaw[index] = call.currentYaw;
+	this->wishdirX[index] = call.wishdir.x;
+	this->wishdirY[index] = call.wishdir.y;
+	this->maxspeed[index] = call.maxspeed;
+	this->wishspeed[index] = call.wishspeed;
+	this->accel[index] = call.accel;
+	this->surfaceFriction[index] = call.surfaceFriction;
+	this->duration[index] = call.duration;
+	this->velocityPreX[index] = call.velocityPre.x;
+	this->velocityPreY[index] = call.velocityPre.y;
+	this->velocityPostX[index] = call.velocityPost.x;
+	this->velocityPostY[index] = call.velocityPost.y;
+	u8 flags = 0;
+	if (CInButtonState::IsButtonPressed(call.buttons, IN_FORWARD | IN_BACK | IN_MOVELEFT | IN_MOVERIGHT))
+	{
+		flags |= AACALL_MOVE_KEYS;
+	}
+	if (call.ducking)
+	{
+		flags |= AACALL_DUCKING;
+	}
+	this->flags[index] = flags;
+}
+
+/*
+ * Strafe analysis
+ *
+ * The angle ratio of a call is worked out when the call is complete, and goes into running stats of its strafe (see
+ * Strafe::UpdateLastAACall). The rest is sums over the calls that only need the cosine of the ideal yaw, which the SSE2
+ * path does for 4 calls at a time when the strafe ends. The scalar path handles what is left at the end of a strafe and
+ * builds without SSE2, the two agree to within float rounding.
+ */
+
+// Sums over the calls of a strafe.
+struct StrafeTotals
+{
+	f32 duration;
+	f32 badAngles;
+	f32 overlap;
+	f32 deadAir;
+	f32 syncDuration;
+	f32 width;
+	f32 airGain;
+	f32 airLoss;
+	f32 maxGain;
+	f32 externalGain;
+	f32 externalLoss;
+};
+
+internal f32 CalcAccelSpeed(AACallBuffer &calls, i32 index)
+{
+	f32 speed = calls.wishspeed[index] == 0 ? calls.maxspeed[index] : calls.wishspeed[index];
+	return calls.accel[index] * speed * calls.surfaceFriction[index] * calls.duration[index];
+}
+
+// Cosine of the yaw between wishdir and velocity that gains the most speed.
+internal f32 CalcIdealYawCos(f32 accelSpeed, f32 speed)
+{
+	if (accelSpeed <= 0.0f)
+	{
+		return -1.0f;
+	}
+	if (speed == 0.0f)
+	{
+		return 1.0f;
+	}
+	f32 tmp = JS_WISHSPEED_CAPPED - accelSpeed;
+	if (tmp <= 0.0f)
+	{
+		return 0.0f;
+	}
+	return tmp < speed ? tmp / speed : 1.0f;
+}
+
+// Takes the squared speed as well, the gain is small next to the speed and would lose precision squaring it back.
+internal f32 CalcIdealGain(f32 accelSpeed, f32 speedSqr, f32 speed, f32 idealCos)
+{
+	// sqrt(v^2+a^2+2*v*a*cos(yaw)
+	f32 cappedAccelSpeed = MIN(accelSpeed, JS_WISHSPEED_CAPPED);
+	return sqrt(speedSqr + cappedAccelSpeed * cappedAccelSpeed + 2 * cappedAccelSpeed * speed * idealCos) - speed;
+}
+
+// Normalized like the yaws always were, so a yaw of 180 degrees is -180.
+internal f32 CalcYawFromCos(f32 cosine)
+{
+	if (cosine <= -1.0f)
+	{
+		return -180.0f;
+	}
+	return utils::NormalizeDeg(RAD2DEG(acos(cosine)));
+}
+
+// Yaw of a 2D direction in degrees, in [0, 360) like VectorAngles gives it.
+internal f32 CalcYaw(f32 y, f32 x)
+{
+	if (y == 0 && x == 0)
+	{
+		return 0.0f;
+	}
+	f32 yaw = atan2(y, x) * 180 / M_PI;
+	if (yaw < 0)
+	{
+		yaw += 360;
+	}
+	return yaw;
+}
+
+internal void AnalyseAACall(AACallBuffer &calls, i32 index, StrafeTotals &totals)
+{
+	f32 duration = calls.duration[index];
+	f32 speedPreSqr = calls.velocityPreX[index] * calls.velocityPreX[index] + calls.velocityPreY[index] * calls.velocityPreY[index];
+	f32 speedPre = sqrt(speedPreSqr);
+	f32 speedPost = sqrt(calls.velocityPostX[index] * calls.velocityPostX[index] + calls.velocityPostY[index] * calls.velocityPostY[index]);
+	f32 speedDiff = speedPost - speedPre;
+	f32 deltaX = calls.velocityPostX[index] - calls.velocityPreX[index];
+	f32 deltaY = calls.velocityPostY[index] - calls.velocityPreY[index];
+
+	totals.duration += duration;
+	// Calculate BA/DA/OL
+	if (calls.wishspeed[index] == 0)
+	{
+		if (calls.flags[index] & AACALL_MOVE_KEYS)
+		{
+			totals.overlap += duration;
+		}
+		else
+		{
+			totals.deadAir += duration;
+		}
+	}
+	else if (sqrt(deltaX * deltaX + deltaY * deltaY) <= JS_EPSILON)
+	{
+		// This gain could just be from quantized float stuff.
+		totals.badAngles += duration;
+	}
+	// Calculate sync.
+	else if (speedDiff > JS_EPSILON)
+	{
+		totals.syncDuration += duration;
+	}
+
+	// Gain/loss.
+	f32 accelSpeed = CalcAccelSpeed(calls, index);
+	totals.maxGain += CalcIdealGain(accelSpeed, speedPreSqr, speedPre, CalcIdealYawCos(accelSpeed, speedPre));
+	if (speedDiff > 0)
+	{
+		totals.airGain += speedDiff;
+	}
+	else
+	{
+		totals.airLoss += speedDiff;
+	}
+	f32 externalSpeedDiff = calls.externalSpeedDiff[index];
+	if (externalSpeedDiff > 0)
+	{
+		totals.externalGain += externalSpeedDiff;
+	}
+	else
+	{
+		totals.externalLoss += externalSpeedDiff;
+	}
+	totals.width += fabs(utils::GetAngleDifference(calls.currentYaw[index], calls.prevYaw[index], 180.0f));
+}
+
+// Returns false if the call has no ratio.
+internal bool CalcAngleRatio(AACallBuffer &calls, i32 index, TurnState turnstate, f32 &ratio, f32 &fraction)
+{
+	f32 speedPreSqr = calls.velocityPreX[index] * calls.velocityPreX[index] + calls.velocityPreY[index] * calls.velocityPreY[index];
+	f32 speedPre = sqrt(speedPreSqr);
+	if (speedPre == 0)
+	{
+		// Any angle should be a good angle here.
+		return false;
+	}
+	f32 speedPost = sqrt(calls.velocityPostX[index] * calls.velocityPostX[index] + calls.velocityPostY[index] * calls.velocityPostY[index]);
+
+	// If no attempt to gain speed was made, use the angle of the last call as a reference,
+	// and add yaw relative to last tick's yaw.
+	f32 wishYaw;
+	if (calls.wishspeed[index] != 0)
+	{
+		wishYaw = CalcYaw(calls.wishdirY[index], calls.wishdirX[index]);
+	}
+	else
+	{
+		wishYaw = calls.prevYaw[index] + utils::GetAngleDifference(calls.currentYaw[index], calls.prevYaw[index], 180.0f);
+	}
+	f32 yaw = utils::NormalizeDeg(wishYaw - CalcYaw(calls.velocityPreY[index], calls.velocityPreX[index]));
+
+	// Get the minimum, ideal, and max yaw for gain.
+	f32 accelSpeed = CalcAccelSpeed(calls, index);
+	f32 idealCos = CalcIdealYawCos(accelSpeed, speedPre);
+	f32 minYaw = CalcYawFromCos(speedPre <= JS_WISHSPEED_CAPPED ? 1.0f : JS_WISHSPEED_CAPPED / speedPre);
+	f32 idealYaw = CalcYawFromCos(idealCos);
+	f32 numer = accelSpeed <= 2 * JS_WISHSPEED_CAPPED ? -accelSpeed : -JS_WISHSPEED_CAPPED;
+	f32 denom = accelSpeed <= 2 * JS_WISHSPEED_CAPPED ? 2 * speedPre : speedPre;
+	f32 maxYaw = denom < fabs(numer) ? idealYaw : CalcYawFromCos(numer / denom);
+
+	if (turnstate == TURN_RIGHT || /* The ideal angle is calculated for left turns, we need to flip it for right turns. */
+		(turnstate == TURN_NONE
+		 && fabs(utils::GetAngleDifference(yaw, idealYaw, 180.0f)) > fabs(utils::GetAngleDifference(-yaw, idealYaw, 180.0f))))
+	// If we aren't turning at all, take the one closer to the ideal yaw.
+	{
+		yaw = -yaw;
+	}
+
+	// It is possible for the player to gain speed here, by pressing the opposite keys
+	// while still turning in the same direction, which results in actual gain...
+	// Usually this happens at the end of a strafe.
+	if (yaw < 0 && speedPost > speedPre)
+	{
+		yaw = -yaw;
+	}
+
+	f32 gainRatio = (speedPost - speedPre) / CalcIdealGain(accelSpeed, speedPreSqr, speedPre, idealCos);
+	fraction = calls.duration[index] * ENGINE_FIXED_TICK_RATE;
+	if (yaw < minYaw)
+	{
+		// No gain.
+		ratio = -1 * fraction;
+	}
+	else if (yaw < idealYaw)
+	{
+		// Slow gain.
+		ratio = (gainRatio - 1) * fraction;
+	}
+	else if (yaw < maxYaw)
+	{
+		// Fast gain.
+		ratio = (1 - gainRatio) * fraction;
+	}
+	else
+	{
+		// Too fast.
+		ratio = 1.0f;
+	}
+	return true;
+}
+
+#ifdef JUMPSTATS_SSE2
+
+internal __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+internal __m128 Abs(__m128 x)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+
+// See utils::GetAngleDifference, in degrees.
+internal __m128 GetAngleDifference(__m128 source, __m128 target)
+{
+	__m128 a = _mm_add_ps(Abs(_mm_sub_ps(target, source)), _mm_set1_ps(180.0f));
+	// fmod, angles never get anywhere near the range of i32.
+	a = _mm_sub_ps(a, _mm_mul_ps(_mm_set1_ps(360.0f), _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(a, _mm_set1_ps(360.0f))))));
+	// The quotient can round up to the next integer.
+	a = Select(_mm_cmplt_ps(a, _mm_setzero_ps()), _mm_add_ps(a, _mm_set1_ps(360.0f)), a);
+	return _mm_sub_ps(a, _mm_set1_ps(180.0f));
+}
+
+internal f32 HorizontalSum(__m128 x)
+{
+	alignas(16) f32 lanes[4];
+	_mm_store_ps(lanes, x);
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+// Same as AnalyseAACall for 4 calls at a time. Returns how many calls were analysed, the rest is left to AnalyseAACall.
+internal i32 AnalyseAACallsSSE2(AACallBuffer &calls, i32 first, i32 count, StrafeTotals &totals)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 epsilon = _mm_set1_ps(JS_EPSILON);
+	const __m128 wishspeedCapped = _mm_set1_ps(JS_WISHSPEED_CAPPED);
+
+	__m128 duration = zero;
+	__m128 badAngles = zero;
+	__m128 overlap = zero;
+	__m128 deadAir = zero;
+	__m128 syncDuration = zero;
+	__m128 width = zero;
+	__m128 airGain = zero;
+	__m128 airLoss = zero;
+	__m128 maxGain = zero;
+	__m128 externalGain = zero;
+	__m128 externalLoss = zero;
+
+	i32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		i32 index = first + i;
+		__m128 callDuration = _mm_loadu_ps(calls.duration.Base() + index);
+		__m128 wishspeed = _mm_loadu_ps(calls.wishspeed.Base() + index);
+		__m128 preX = _mm_loadu_ps(calls.velocityPreX.Base() + index);
+		__m128 preY = _mm_loadu_ps(calls.velocityPreY.Base() + index);
+		__m128 postX = _mm_loadu_ps(calls.velocityPostX.Base() + index);
+		__m128 postY = _mm_loadu_ps(calls.velocityPostY.Base() + index);
+		const u8 *flags = calls.flags.Base() + index;
+		__m128i flagBits = _mm_setr_epi32(flags[0], flags[1], flags[2], flags[3]);
+		__m128i moveKeyBit = _mm_set1_epi32(AACALL_MOVE_KEYS);
+		__m128 moveKeys = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(flagBits, moveKeyBit), moveKeyBit));
+
+		__m128 speedPreSqr = _mm_add_ps(_mm_mul_ps(preX, preX), _mm_mul_ps(preY, preY));
+		__m128 speedPre = _mm_sqrt_ps(speedPreSqr);
+		__m128 speedPost = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(postX, postX), _mm_mul_ps(postY, postY)));
+		__m128 speedDiff = _mm_sub_ps(speedPost, speedPre);
+		__m128 deltaX = _mm_sub_ps(postX, preX);
+		__m128 deltaY = _mm_sub_ps(postY, preY);
+		__m128 delta = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(deltaX, deltaX), _mm_mul_ps(deltaY, deltaY)));
+
+		duration = _mm_add_ps(duration, callDuration);
+		__m128 noWish = _mm_cmpeq_ps(wishspeed, zero);
+		overlap = _mm_add_ps(overlap, _mm_and_ps(_mm_and_ps(noWish, moveKeys), callDuration));
+		deadAir = _mm_add_ps(deadAir, _mm_and_ps(_mm_andnot_ps(moveKeys, noWish), callDuration));
+		__m128 bad = _mm_andnot_ps(noWish, _mm_cmple_ps(delta, epsilon));
+		badAngles = _mm_add_ps(badAngles, _mm_and_ps(bad, callDuration));
+		__m128 sync = _mm_andnot_ps(_mm_or_ps(noWish, bad), _mm_cmpgt_ps(speedDiff, epsilon));
+		syncDuration = _mm_add_ps(syncDuration, _mm_and_ps(sync, callDuration));
+
+		__m128 accelSpeed = Select(noWish, _mm_loadu_ps(calls.maxspeed.Base() + index), wishspeed);
+		accelSpeed = _mm_mul_ps(_mm_loadu_ps(calls.accel.Base() + index), accelSpeed);
+		accelSpeed = _mm_mul_ps(_mm_mul_ps(accelSpeed, _mm_loadu_ps(calls.surfaceFriction.Base() + index)), callDuration);
+		// Same priorities as CalcIdealYawCos, from last to first.
+		__m128 tmp = _mm_sub_ps(wishspeedCapped, accelSpeed);
+		__m128 idealCos = Select(_mm_cmplt_ps(tmp, speedPre), _mm_div_ps(tmp, speedPre), one);
+		idealCos = Select(_mm_cmple_ps(tmp, zero), zero, idealCos);
+		idealCos = Select(_mm_cmpeq_ps(speedPre, zero), one, idealCos);
+		idealCos = Select(_mm_cmple_ps(accelSpeed, zero), _mm_set1_ps(-1.0f), idealCos);
+		__m128 cappedAccelSpeed = _mm_min_ps(accelSpeed, wishspeedCapped);
+		__m128 idealSpeedSqr = _mm_add_ps(speedPreSqr, _mm_mul_ps(cappedAccelSpeed, cappedAccelSpeed));
+		idealSpeedSqr = _mm_add_ps(idealSpeedSqr, _mm_mul_ps(_mm_mul_ps(_mm_add_ps(cappedAccelSpeed, cappedAccelSpeed), speedPre), idealCos));
+		maxGain = _mm_add_ps(maxGain, _mm_sub_ps(_mm_sqrt_ps(idealSpeedSqr), speedPre));
+
+		__m128 gained = _mm_cmpgt_ps(speedDiff, zero);
+		airGain = _mm_add_ps(airGain, _mm_and_ps(gained, speedDiff));
+		airLoss = _mm_add_ps(airLoss, _mm_andnot_ps(gained, speedDiff));
+		__m128 externalSpeedDiff = _mm_loadu_ps(calls.externalSpeedDiff.Base() + index);
+		__m128 externalGained = _mm_cmpgt_ps(externalSpeedDiff, zero);
+		externalGain = _mm_add_ps(externalGain, _mm_and_ps(externalGained, externalSpeedDiff));
+		externalLoss = _mm_add_ps(externalLoss, _mm_andnot_ps(externalGained, externalSpeedDiff));
+		__m128 prevYaw = _mm_loadu_ps(calls.prevYaw.Base() + index);
+		__m128 currentYaw = _mm_loadu_ps(calls.currentYaw.Base() + index);
+		width = _mm_add_ps(width, Abs(GetAngleDifference(currentYaw, prevYaw)));
+	}
+
+	totals.duration += HorizontalSum(duration);
+	totals.badAngles += HorizontalSum(badAngles);
+	totals.overlap += HorizontalSum(overlap);
+	totals.deadAir += HorizontalSum(deadAir);
+	totals.syncDuration += HorizontalSum(syncDuration);
+	totals.width += HorizontalSum(width);
+	totals.airGain += HorizontalSum(airGain);
+	totals.airLoss += HorizontalSum(airLoss);
+	totals.maxGain += HorizontalSum(maxGain);
+	totals.externalGain += HorizontalSum(externalGain);
+	totals.externalLoss += HorizontalSum(externalLoss);
+	return i;
+}
+
+#endif
+
+/*
+ * Strafe stuff
+ */
+
+void Strafe::UpdateCollisionVelocityChange(f32 delta)
+{
+	if (delta < 0.0f)
+	{
+		this->externalLoss -= delta;
+	}
+	else
+	{
+		this->externalGain += delta;
+	}
+}
+
+void Strafe::UpdateLastAACall(const AACall &call)
+{
+	this->aaCallBuffer->Set(this->firstAACall + this->numAACalls - 1, call);
+	this->UpdateAngleRatios();
+}
+
+void Strafe::UpdateAngleRatios()
+{
+	if (this->turnstate != this->ratioTurnState)
+	{
+		// The ratios depend on the turn direction, which is only known some time into the strafe.
+		this->ratioTurnState = this->turnstate;
+		this->numRatioCalls = 0;
+		this->numLowerRatios = 0;
+		this->numUpperRatios = 0;
+		this->ratioSum = 0.0f;
+		this->ratioDuration = 0.0f;
+	}
+	for (; this->numRatioCalls < this->numAACalls; this->numRatioCalls++)
+	{
+		this->AddAngleRatio(this->firstAACall + this->numRatioCalls);
+	}
+}
+
+void Strafe::AddAngleRatio(i32 index)
+{
+	f32 ratio, fraction;
+	if (!CalcAngleRatio(*this->aaCallBuffer, index, this->turnstate, ratio, fraction))
+	{
+		return;
+	}
+	this->maxRatio = this->numLowerRatios + this->numUpperRatios == 0 ? ratio : MAX(this->maxRatio, ratio);
+	this->ratioSum += ratio;
+	this->ratioDuration += fraction;
+
+	// The lower half of the ratios is a max-heap and the upper half a min-heap, so the median is the top of the upper one.
+	// The heaps never hold more ratios than there are calls, which is the space this strafe has in both arrays.
+	f32 *lower = this->aaCallBuffer->lowerRatios.Base() + this->firstAACall;
+	f32 *upper = this->aaCallBuffer->upperRatios.Base() + this->firstAACall;
+	if (this->numUpperRatios > 0 && ratio >= upper[0])
+	{
+		upper[this->numUpperRatios++] = ratio;
+		std::push_heap(upper, upper + this->numUpperRatios, std::greater<f32>());
+	}
+	else
+	{
+		lower[this->numLowerRatios++] = ratio;
+		std::push_heap(lower, lower + this->numLowerRatios, std::less<f32>());
+	}
+	// Keep the upper half at the bigger size for odd counts, like the middle element of a sorted array.
+	if (this->numLowerRatios > this->numUpperRatios)
+	{
+		std::pop_heap(lower, lower + this->numLowerRatios--, std::less<f32>());
+		upper[this->numUpperRatios++] = lower[this->numLowerRatios];
+		std::push_heap(upper, upper + this->numUpperRatios, std::greater<f32>());
+	}
+	else if (this->numUpperRatios > this->numLowerRatios + 1)
+	{
+		std::pop_heap(upper, upper + this->numUpperRatios--, std::greater<f32>());
+		lower[this->numLowerRatios++] = upper[this->numUpperRatios];
+		std::push_heap(lower, lower + this->numLowerRatios, std::less<f32>());
+	}
+}
+
+void Strafe::End()
+{
+	StrafeTotals totals {};
+	AACallBuffer &calls = *this->aaCallBuffer;
+	i32 i = 0;
+#ifdef JUMPSTATS_SSE2
+	i = AnalyseAACallsSSE2(calls, this->firstAACall, this->numAACalls, totals);
+#endif
+	for (; i < this->numAACalls; i++)
+	{
+		AnalyseAACall(calls, this->firstAACall + i, totals);
+	}
+
+	this->duration += totals.duration;
+	this->badAngles += totals.badAngles;
+	this->overlap += totals.overlap;
+	this->deadAir += totals.deadAir;
+	this->syncDuration += totals.syncDuration;
+	this->width += totals.width;
+	this->airGain += totals.airGain;
+	this->airLoss += totals.airLoss;
+	this->maxGain += totals.maxGain;
+	this->externalGain += totals.externalGain;
+	this->externalLoss += totals.externalLoss;
+	this->CalcAngleRatioStats();
+}
+
+bool Strafe::CalcAngleRatioStats()
+{
+	this->arStats.available = false;
+	this->UpdateAngleRatios();
+
+	// This can return nan if the duration is 0, this is intended...
+	if (this->ratioDuration == 0.0f)
+	{
+		return false;
+	}
+	this->arStats.available = true;
+	this->arStats.average = this->ratioSum / this->ratioDuration;
+	this->arStats.median = this->aaCallBuffer->upperRatios[this->firstAACall];
+	this->arStats.max = this->maxRatio;
+	return true;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <type_traits>
 #include "common.h"
 #include "movement/movement.h"
 #include "sdk/datatypes.h"
@@ -14,10 +15,16 @@
 
 #define KZ_CHAT_PREFIX "{lime}KZ {grey}|{default}"
 
-#define KZ_DEFAULT_TIP_INTERVAL 75.0
-#define KZ_DEFAULT_LANGUAGE     "en"
-#define KZ_DEFAULT_STYLE        "Normal"
-#define KZ_DEFAULT_MODE         "Classic"
+#define KZ_DEFAULT_TIP_INTERVAL     75.0
+#define KZ_DEFAULT_HUD_REFRESH_RATE 16.0
+#define KZ_DEFAULT_LANGUAGE         "en"
+#define KZ_DEFAULT_STYLE            "Normal"
+#define KZ_DEFAULT_MODE             "Classic"
+
+// Hooks the player needs for its own services, regardless of mode and style.
+#define KZ_PLAYER_HOOKS \
+	(MV_HOOK_BOTH(MovementHook_PhysicsSimulate) | MV_HOOK_BOTH(MovementHook_ProcessMovement) | MV_HOOK_BOTH(MovementHook_AirAccelerate) \
+	 | MV_HOOK_BOTH(MovementHook_TryPlayerMove) | MV_HOOK_PRE(MovementHook_PostThink))
 
 class KZPlayer;
 // class Jump;
@@ -32,12 +39,18 @@ class KZNoclipService;
 class KZOptionService;
 class KZQuietService;
 class KZRacingService;
+class KZRecorderService;
 class KZSavelocService;
 class KZSpecService;
 class KZStyleService;
 class KZTimerService;
 class KZTipService;
 
+namespace KZ::mode
+{
+	struct ModeCvarValues;
+}
+
 class KZPlayer : public MovementPlayer
 {
 public:
@@ -142,12 +155,25 @@ public:
 	KZOptionService *optionService {};
 	KZQuietService *quietService {};
 	KZRacingService *racingService {};
+	KZRecorderService *recorderService {};
 	KZSavelocService *savelocService {};
 	KZSpecService *specService {};
 	KZStyleService *styleService {};
 	KZTimerService *timerService {};
 	KZTipService *tipService {};
 
+	// Hooks overridden by the current mode and style services, see KZ::GetServiceHooks.
+	u64 modeServiceHooks = MV_HOOKS_ALL;
+	u64 styleServiceHooks = MV_HOOKS_ALL;
+
+	// Parsed cvar values of the current mode, see KZ::mode::ApplyModeSettings.
+	const KZ::mode::ModeCvarValues *modeCvarValues {};
+
+	void UpdateActiveHooks()
+	{
+		this->activeHooks = KZ_PLAYER_HOOKS | this->modeServiceHooks | this->styleServiceHooks;
+	}
+
 	void EnableGodMode();
 
 	// Leg stuff
@@ -174,6 +200,8 @@ public:
 	virtual void PrintCentre(bool addPrefix, bool includeSpectators, const char *format, ...);
 	virtual void PrintAlert(bool addPrefix, bool includeSpectators, const char *format, ...);
 	virtual void PrintHTMLCentre(bool addPrefix, bool includeSpectators, const char *format, ...);
+	// Bits of the player slots that see this player's prints.
+	u64 GetPrintRecipients(bool includeSpectators);
 };
 
 class KZBaseService
@@ -221,6 +249,48 @@ extern CKZPlayerManager *g_pKZPlayerManager;
 
 namespace KZ
 {
+	// Movement hooks that Service declares itself instead of inheriting the empty defaults of Base.
+	// Mode and style plugins pass this to RegisterMode/RegisterStyle so that the player only dispatches to hooks that do something.
+	template<typename Service, typename Base>
+	constexpr u64 GetServiceHooks()
+	{
+#define KZ_SERVICE_HOOK(hook, function) \
+	((std::is_same_v<decltype(&Service::function), decltype(&Base::function)> ? 0 : MV_HOOK_PRE(hook)) \
+	 | (std::is_same_v<decltype(&Service::function##Post), decltype(&Base::function##Post)> ? 0 : MV_HOOK_POST(hook)))
+
+		// clang-format off
+		return (std::is_same_v<decltype(&Service::GetPlayerMaxSpeed), decltype(&Base::GetPlayerMaxSpeed)> ? 0 : MV_HOOK_POST(MovementHook_GetMaxSpeed))
+			| KZ_SERVICE_HOOK(MovementHook_PhysicsSimulate, OnPhysicsSimulate)
+			| KZ_SERVICE_HOOK(MovementHook_ProcessUsercmds, OnProcessUsercmds)
+			| KZ_SERVICE_HOOK(MovementHook_ProcessMovement, OnProcessMovement)
+			| KZ_SERVICE_HOOK(MovementHook_PlayerMoveNew, OnPlayerMove)
+			| KZ_SERVICE_HOOK(MovementHook_CheckParameters, OnCheckParameters)
+			| KZ_SERVICE_HOOK(MovementHook_CanMove, OnCanMove)
+			| KZ_SERVICE_HOOK(MovementHook_FullWalkMove, OnFullWalkMove)
+			| KZ_SERVICE_HOOK(MovementHook_MoveInit, OnMoveInit)
+			| KZ_SERVICE_HOOK(MovementHook_CheckWater, OnCheckWater)
+			| KZ_SERVICE_HOOK(MovementHook_WaterMove, OnWaterMove)
+			| KZ_SERVICE_HOOK(MovementHook_CheckVelocity, OnCheckVelocity)
+			| KZ_SERVICE_HOOK(MovementHook_Duck, OnDuck)
+			| KZ_SERVICE_HOOK(MovementHook_CanUnduck, OnCanUnduck)
+			| KZ_SERVICE_HOOK(MovementHook_LadderMove, OnLadderMove)
+			| KZ_SERVICE_HOOK(MovementHook_CheckJumpButton, OnCheckJumpButton)
+			| KZ_SERVICE_HOOK(MovementHook_OnJump, OnJump)
+			| KZ_SERVICE_HOOK(MovementHook_AirMove, OnAirMove)
+			| KZ_SERVICE_HOOK(MovementHook_AirAccelerate, OnAirAccelerate)
+			| KZ_SERVICE_HOOK(MovementHook_Friction, OnFriction)
+			| KZ_SERVICE_HOOK(MovementHook_WalkMove, OnWalkMove)
+			| KZ_SERVICE_HOOK(MovementHook_TryPlayerMove, OnTryPlayerMove)
+			| KZ_SERVICE_HOOK(MovementHook_CategorizePosition, OnCategorizePosition)
+			| KZ_SERVICE_HOOK(MovementHook_FinishGravity, OnFinishGravity)
+			| KZ_SERVICE_HOOK(MovementHook_CheckFalling, OnCheckFalling)
+			| KZ_SERVICE_HOOK(MovementHook_PostPlayerMove, OnPostPlayerMove)
+			| KZ_SERVICE_HOOK(MovementHook_PostThink, OnPostThink);
+		// clang-format on
+
+#undef KZ_SERVICE_HOOK
+	}
+
 	namespace misc
 	{
 		void RegisterCommands();
@@ -1,5 +1,7 @@
 #include "kz.h"
 #include "utils/utils.h"
+#include "utils/entitykind.h"
+#include "utils/triggerindex.h"
 
 #include "checkpoint/kz_checkpoint.h"
 #include "quiet/kz_quiet.h"
@@ -13,6 +15,8 @@
 #include "spec/kz_spec.h"
 #include "timer/kz_timer.h"
 #include "option/kz_option.h"
+#include "recorder/kz_recorder.h"
+#include "movement/mv_perf.h"
 
 #include "tier0/memdbgon.h"
 
@@ -30,6 +34,7 @@ void KZPlayer::Init()
 	delete this->timerService;
 	delete this->noclipService;
 	delete this->tipService;
+	delete this->recorderService;
 
 	this->checkpointService = new KZCheckpointService(this);
 	this->jumpstatsService = new KZJumpstatsService(this);
@@ -40,8 +45,10 @@ void KZPlayer::Init()
 	this->timerService = new KZTimerService(this);
 	this->optionService = new KZOptionService(this);
 	this->tipService = new KZTipService(this);
+	this->recorderService = new KZRecorderService(this);
 	KZ::mode::InitModeService(this);
 	KZ::style::InitStyleService(this);
+	movement::perf::SetPlayerContext(this->index, this->modeService->GetModeShortName(), this->styleService->GetStyleShortName());
 }
 
 void KZPlayer::Reset()
@@ -60,6 +67,7 @@ void KZPlayer::Reset()
 	this->tipService->Reset();
 	this->modeService->Reset();
 	this->optionService->Reset();
+	this->recorderService->Reset();
 
 	g_pKZModeManager->SwitchToMode(this, KZOptionService::GetOptionStr("defaultMode", KZ_DEFAULT_MODE), true);
 	g_pKZStyleManager->SwitchToStyle(this, KZOptionService::GetOptionStr("defaultStyle", KZ_DEFAULT_STYLE), true);
@@ -70,39 +78,45 @@ META_RES KZPlayer::GetPlayerMaxSpeed(f32 &maxSpeed)
 	return this->modeService->GetPlayerMaxSpeed(maxSpeed);
 }
 
+// Calls a movement hook on the mode and style services that implement it, see KZ::GetServiceHooks.
+#define KZ_SERVICE_DISPATCH(hook, call) \
+	if (this->modeServiceHooks & (hook)) \
+	{ \
+		this->modeService->call; \
+	} \
+	if (this->styleServiceHooks & (hook)) \
+	{ \
+		this->styleService->call; \
+	}
+
 void KZPlayer::OnPhysicsSimulate()
 {
 	MovementPlayer::OnPhysicsSimulate();
-	this->modeService->OnPhysicsSimulate();
-	this->styleService->OnPhysicsSimulate();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_PhysicsSimulate), OnPhysicsSimulate());
 }
 
 void KZPlayer::OnPhysicsSimulatePost()
 {
 	MovementPlayer::OnPhysicsSimulatePost();
-	this->modeService->OnPhysicsSimulatePost();
-	this->styleService->OnPhysicsSimulatePost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_PhysicsSimulate), OnPhysicsSimulatePost());
 	this->timerService->OnPhysicsSimulatePost();
 }
 
 void KZPlayer::OnProcessUsercmds(void *cmds, int numcmds)
 {
-	this->modeService->OnProcessUsercmds(cmds, numcmds);
-	this->styleService->OnProcessUsercmds(cmds, numcmds);
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_ProcessUsercmds), OnProcessUsercmds(cmds, numcmds));
 }
 
 void KZPlayer::OnProcessUsercmdsPost(void *cmds, int numcmds)
 {
-	this->modeService->OnProcessUsercmdsPost(cmds, numcmds);
-	this->styleService->OnProcessUsercmdsPost(cmds, numcmds);
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_ProcessUsercmds), OnProcessUsercmdsPost(cmds, numcmds));
 }
 
 void KZPlayer::OnProcessMovement()
 {
 	MovementPlayer::OnProcessMovement();
 	KZ::mode::ApplyModeSettings(this);
-	this->modeService->OnProcessMovement();
-	this->styleService->OnProcessMovement();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_ProcessMovement), OnProcessMovement());
 	this->jumpstatsService->OnProcessMovement();
 	this->checkpointService->TpHoldPlayerStill();
 	this->noclipService->HandleMoveCollision();
@@ -114,293 +128,249 @@ void KZPlayer::OnProcessMovementPost()
 {
 	this->hudService->DrawSpeedPanel();
 	this->jumpstatsService->UpdateJump();
-	this->modeService->OnProcessMovementPost();
-	this->styleService->OnProcessMovementPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_ProcessMovement), OnProcessMovementPost());
 	this->jumpstatsService->OnProcessMovementPost();
+	this->recorderService->OnProcessMovementPost();
 	MovementPlayer::OnProcessMovementPost();
 }
 
 void KZPlayer::OnPlayerMove()
 {
-	this->modeService->OnPlayerMove();
-	this->styleService->OnPlayerMove();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_PlayerMoveNew), OnPlayerMove());
 }
 
 void KZPlayer::OnPlayerMovePost()
 {
-	this->modeService->OnPlayerMovePost();
-	this->styleService->OnPlayerMovePost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_PlayerMoveNew), OnPlayerMovePost());
 }
 
 void KZPlayer::OnCheckParameters()
 {
-	this->modeService->OnCheckParameters();
-	this->styleService->OnCheckParameters();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_CheckParameters), OnCheckParameters());
 }
 
 void KZPlayer::OnCheckParametersPost()
 {
-	this->modeService->OnCheckParametersPost();
-	this->styleService->OnCheckParametersPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_CheckParameters), OnCheckParametersPost());
 }
 
 void KZPlayer::OnCanMove()
 {
-	this->modeService->OnCanMove();
-	this->styleService->OnCanMove();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_CanMove), OnCanMove());
 }
 
 void KZPlayer::OnCanMovePost()
 {
-	this->modeService->OnCanMovePost();
-	this->styleService->OnCanMovePost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_CanMove), OnCanMovePost());
 }
 
 void KZPlayer::OnFullWalkMove(bool &ground)
 {
-	this->modeService->OnFullWalkMove(ground);
-	this->styleService->OnFullWalkMove(ground);
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_FullWalkMove), OnFullWalkMove(ground));
 }
 
 void KZPlayer::OnFullWalkMovePost(bool ground)
 {
-	this->modeService->OnFullWalkMovePost(ground);
-	this->styleService->OnFullWalkMovePost(ground);
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_FullWalkMove), OnFullWalkMovePost(ground));
 }
 
 void KZPlayer::OnMoveInit()
 {
-	this->modeService->OnMoveInit();
-	this->styleService->OnMoveInit();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_MoveInit), OnMoveInit());
 }
 
 void KZPlayer::OnMoveInitPost()
 {
-	this->modeService->OnMoveInitPost();
-	this->styleService->OnMoveInitPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_MoveInit), OnMoveInitPost());
 }
 
 void KZPlayer::OnCheckWater()
 {
-	this->modeService->OnCheckWater();
-	this->styleService->OnCheckWater();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_CheckWater), OnCheckWater());
 }
 
 void KZPlayer::OnWaterMove()
 {
-	this->modeService->OnWaterMove();
-	this->styleService->OnWaterMove();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_WaterMove), OnWaterMove());
 }
 
 void KZPlayer::OnWaterMovePost()
 {
-	this->modeService->OnWaterMovePost();
-	this->styleService->OnWaterMovePost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_WaterMove), OnWaterMovePost());
 }
 
 void KZPlayer::OnCheckWaterPost()
 {
-	this->modeService->OnCheckWaterPost();
-	this->styleService->OnCheckWaterPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_CheckWater), OnCheckWaterPost());
 }
 
 void KZPlayer::OnCheckVelocity(const char *a3)
 {
-	this->modeService->OnCheckVelocity(a3);
-	this->styleService->OnCheckVelocity(a3);
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_CheckVelocity), OnCheckVelocity(a3));
 }
 
 void KZPlayer::OnCheckVelocityPost(const char *a3)
 {
-	this->modeService->OnCheckVelocityPost(a3);
-	this->styleService->OnCheckVelocityPost(a3);
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_CheckVelocity), OnCheckVelocityPost(a3));
 }
 
 void KZPlayer::OnDuck()
 {
-	this->modeService->OnDuck();
-	this->styleService->OnDuck();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_Duck), OnDuck());
 }
 
 void KZPlayer::OnDuckPost()
 {
-	this->modeService->OnDuckPost();
-	this->styleService->OnDuckPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_Duck), OnDuckPost());
 }
 
 void KZPlayer::OnCanUnduck()
 {
-	this->modeService->OnCanUnduck();
-	this->styleService->OnCanUnduck();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_CanUnduck), OnCanUnduck());
 }
 
 void KZPlayer::OnCanUnduckPost(bool &ret)
 {
-	this->modeService->OnCanUnduckPost(ret);
-	this->styleService->OnCanUnduckPost(ret);
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_CanUnduck), OnCanUnduckPost(ret));
 }
 
 void KZPlayer::OnLadderMove()
 {
-	this->modeService->OnLadderMove();
-	this->styleService->OnLadderMove();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_LadderMove), OnLadderMove());
 }
 
 void KZPlayer::OnLadderMovePost()
 {
-	this->modeService->OnLadderMovePost();
-	this->styleService->OnLadderMovePost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_LadderMove), OnLadderMovePost());
 }
 
 void KZPlayer::OnCheckJumpButton()
 {
-	this->modeService->OnCheckJumpButton();
-	this->styleService->OnCheckJumpButton();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_CheckJumpButton), OnCheckJumpButton());
 }
 
 void KZPlayer::OnCheckJumpButtonPost()
 {
-	this->modeService->OnCheckJumpButtonPost();
-	this->styleService->OnCheckJumpButtonPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_CheckJumpButton), OnCheckJumpButtonPost());
 }
 
 void KZPlayer::OnJump()
 {
-	this->modeService->OnJump();
-	this->styleService->OnJump();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_OnJump), OnJump());
 }
 
 void KZPlayer::OnJumpPost()
 {
-	this->modeService->OnJumpPost();
-	this->styleService->OnJumpPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_OnJump), OnJumpPost());
 }
 
 void KZPlayer::OnAirMove()
 {
-	this->modeService->OnAirMove();
-	this->styleService->OnAirMove();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_AirMove), OnAirMove());
 }
 
 void KZPlayer::OnAirMovePost()
 {
-	this->modeService->OnAirMovePost();
-	this->styleService->OnAirMovePost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_AirMove), OnAirMovePost());
 }
 
 void KZPlayer::OnAirAccelerate(Vector &wishdir, f32 &wishspeed, f32 &accel)
 {
-	this->modeService->OnAirAccelerate(wishdir, wishspeed, accel);
-	this->styleService->OnAirAccelerate(wishdir, wishspeed, accel);
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_AirAccelerate), OnAirAccelerate(wishdir, wishspeed, accel));
 	this->jumpstatsService->OnAirAccelerate();
 }
 
 void KZPlayer::OnAirAcceleratePost(Vector wishdir, f32 wishspeed, f32 accel)
 {
-	this->modeService->OnAirAcceleratePost(wishdir, wishspeed, accel);
-	this->styleService->OnAirAcceleratePost(wishdir, wishspeed, accel);
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_AirAccelerate), OnAirAcceleratePost(wishdir, wishspeed, accel));
 	this->jumpstatsService->OnAirAcceleratePost(wishdir, wishspeed, accel);
 }
 
 void KZPlayer::OnFriction()
 {
-	this->modeService->OnFriction();
-	this->styleService->OnFriction();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_Friction), OnFriction());
 }
 
 void KZPlayer::OnFrictionPost()
 {
-	this->modeService->OnFrictionPost();
-	this->styleService->OnFrictionPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_Friction), OnFrictionPost());
 }
 
 void KZPlayer::OnWalkMove()
 {
-	this->modeService->OnWalkMove();
-	this->styleService->OnWalkMove();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_WalkMove), OnWalkMove());
 }
 
 void KZPlayer::OnWalkMovePost()
 {
-	this->modeService->OnWalkMovePost();
-	this->styleService->OnWalkMovePost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_WalkMove), OnWalkMovePost());
 }
 
 void KZPlayer::OnTryPlayerMove(Vector *pFirstDest, trace_t_s2 *pFirstTrace)
 {
-	this->modeService->OnTryPlayerMove(pFirstDest, pFirstTrace);
-	this->styleService->OnTryPlayerMove(pFirstDest, pFirstTrace);
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_TryPlayerMove), OnTryPlayerMove(pFirstDest, pFirstTrace));
 	this->jumpstatsService->OnTryPlayerMove();
 }
 
 void KZPlayer::OnTryPlayerMovePost(Vector *pFirstDest, trace_t_s2 *pFirstTrace)
 {
-	this->modeService->OnTryPlayerMovePost(pFirstDest, pFirstTrace);
-	this->styleService->OnTryPlayerMovePost(pFirstDest, pFirstTrace);
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_TryPlayerMove), OnTryPlayerMovePost(pFirstDest, pFirstTrace));
 	this->jumpstatsService->OnTryPlayerMovePost();
 }
 
 void KZPlayer::OnCategorizePosition(bool bStayOnGround)
 {
-	this->modeService->OnCategorizePosition(bStayOnGround);
-	this->styleService->OnCategorizePosition(bStayOnGround);
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_CategorizePosition), OnCategorizePosition(bStayOnGround));
 }
 
 void KZPlayer::OnCategorizePositionPost(bool bStayOnGround)
 {
-	this->modeService->OnCategorizePositionPost(bStayOnGround);
-	this->styleService->OnCategorizePositionPost(bStayOnGround);
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_CategorizePosition), OnCategorizePositionPost(bStayOnGround));
 }
 
 void KZPlayer::OnFinishGravity()
 {
-	this->modeService->OnFinishGravity();
-	this->styleService->OnFinishGravity();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_FinishGravity), OnFinishGravity());
 }
 
 void KZPlayer::OnFinishGravityPost()
 {
-	this->modeService->OnFinishGravityPost();
-	this->styleService->OnFinishGravityPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_FinishGravity), OnFinishGravityPost());
 }
 
 void KZPlayer::OnCheckFalling()
 {
-	this->modeService->OnCheckFalling();
-	this->styleService->OnCheckFalling();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_CheckFalling), OnCheckFalling());
 }
 
 void KZPlayer::OnCheckFallingPost()
 {
-	this->modeService->OnCheckFallingPost();
-	this->styleService->OnCheckFallingPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_CheckFalling), OnCheckFallingPost());
 }
 
 void KZPlayer::OnPostPlayerMove()
 {
-	this->modeService->OnPostPlayerMove();
-	this->styleService->OnPostPlayerMove();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_PostPlayerMove), OnPostPlayerMove());
 }
 
 void KZPlayer::OnPostPlayerMovePost()
 {
-	this->modeService->OnPostPlayerMovePost();
-	this->styleService->OnPostPlayerMovePost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_PostPlayerMove), OnPostPlayerMovePost());
 }
 
 void KZPlayer::OnPostThink()
 {
-	this->modeService->OnPostThink();
-	this->styleService->OnPostThink();
+	KZ_SERVICE_DISPATCH(MV_HOOK_PRE(MovementHook_PostThink), OnPostThink());
 	MovementPlayer::OnPostThink();
 }
 
 void KZPlayer::OnPostThinkPost()
 {
-	this->modeService->OnPostThinkPost();
-	this->styleService->OnPostThinkPost();
+	KZ_SERVICE_DISPATCH(MV_HOOK_POST(MovementHook_PostThink), OnPostThinkPost());
 }
 
+#undef KZ_SERVICE_DISPATCH
+
 void KZPlayer::OnStartTouchGround()
 {
 	this->jumpstatsService->EndJump();
@@ -501,16 +471,20 @@ void KZPlayer::TouchTriggersAlongPath(const Vector &start, const Vector &end, co
 		return;
 	}
 	CTraceFilterHitAllTriggers filter;
-	trace_t_s2 tr;
-	g_pKZUtils->TracePlayerBBox(start, end, bounds, &filter, tr);
+	if (triggers::FindTouchedTriggers(start, end, bounds, filter.hitTriggerHandles))
+	{
+		trace_t_s2 tr;
+		g_pKZUtils->TracePlayerBBox(start, end, bounds, &filter, tr);
+	}
 	FOR_EACH_VEC(filter.hitTriggerHandles, i)
 	{
 		CEntityHandle handle = filter.hitTriggerHandles[i];
-		CBaseTrigger *trigger = dynamic_cast<CBaseTrigger *>(GameEntitySystem()->GetBaseEntity(handle));
-		if (!trigger || !V_strstr(trigger->GetClassname(), "trigger_"))
+		CBaseEntity2 *entity = static_cast<CBaseEntity2 *>(GameEntitySystem()->GetBaseEntity(handle));
+		if (!entity || !utils::IsTriggerKind(utils::GetEntityKind(entity)))
 		{
 			continue;
 		}
+		CBaseTrigger *trigger = static_cast<CBaseTrigger *>(entity);
 		if (!this->touchedTriggers.HasElement(handle))
 		{
 			this->GetPawn()->StartTouch(trigger);
@@ -525,7 +499,8 @@ void KZPlayer::UpdateTriggerTouchList()
 {
 	if (!this->IsAlive() || this->GetCollisionGroup() != KZ_COLLISION_GROUP_STANDARD)
 	{
-		FOR_EACH_VEC(this->touchedTriggers, i)
+		// Ending the touch removes the trigger from the set.
+		FOR_EACH_VEC_BACK(this->touchedTriggers, i)
 		{
 			CBaseTrigger *trigger = static_cast<CBaseTrigger *>(GameEntitySystem()->GetBaseEntity(this->touchedTriggers[i]));
 			trigger->EndTouch(this->GetPawn());
@@ -538,33 +513,42 @@ void KZPlayer::UpdateTriggerTouchList()
 	bbox_t bounds;
 	this->GetBBoxBounds(&bounds);
 	CTraceFilterHitAllTriggers filter;
-	trace_t_s2 tr;
-	g_pKZUtils->TracePlayerBBox(origin, origin, bounds, &filter, tr);
+	// Without any trigger around, everything that was touched gets untouched below.
+	if (triggers::FindTouchedTriggers(origin, origin, bounds, filter.hitTriggerHandles))
+	{
+		trace_t_s2 tr;
+		g_pKZUtils->TracePlayerBBox(origin, origin, bounds, &filter, tr);
+	}
 
-	FOR_EACH_VEC(this->touchedTriggers, i)
+	// Touching triggers changes touchedTriggers, so find the differences first.
+	EntityHandleSet untouchedTriggers;
+	EntityHandleSet newTriggers;
+	EntityHandleSet::Diff(
+		this->touchedTriggers, filter.hitTriggerHandles, [&](CEntityHandle handle) { untouchedTriggers.Insert(handle); },
+		[&](CEntityHandle handle) { newTriggers.Insert(handle); });
+
+	FOR_EACH_VEC(untouchedTriggers, i)
 	{
-		CEntityHandle handle = this->touchedTriggers[i];
-		CBaseTrigger *trigger = dynamic_cast<CBaseTrigger *>(GameEntitySystem()->GetBaseEntity(handle));
+		CEntityHandle handle = untouchedTriggers[i];
+		CBaseTrigger *trigger = static_cast<CBaseTrigger *>(GameEntitySystem()->GetBaseEntity(handle));
 		if (!trigger)
 		{
-			this->touchedTriggers.Remove(i);
+			this->touchedTriggers.FindAndRemove(handle);
 			continue;
 		}
-		if (!filter.hitTriggerHandles.HasElement(handle))
-		{
-			this->GetPawn()->EndTouch(trigger);
-			trigger->EndTouch(this->GetPawn());
-		}
+		this->GetPawn()->EndTouch(trigger);
+		trigger->EndTouch(this->GetPawn());
 	}
 
-	FOR_EACH_VEC(filter.hitTriggerHandles, i)
+	FOR_EACH_VEC(newTriggers, i)
 	{
-		CEntityHandle handle = filter.hitTriggerHandles[i];
-		CBaseTrigger *trigger = dynamic_cast<CBaseTrigger *>(GameEntitySystem()->GetBaseEntity(handle));
-		if (!trigger || !V_strstr(trigger->GetClassname(), "trigger_"))
+		CEntityHandle handle = newTriggers[i];
+		CBaseEntity2 *entity = static_cast<CBaseEntity2 *>(GameEntitySystem()->GetBaseEntity(handle));
+		if (!entity || !utils::IsTriggerKind(utils::GetEntityKind(entity)))
 		{
 			continue;
 		}
+		CBaseTrigger *trigger = static_cast<CBaseTrigger *>(entity);
 		if (!this->touchedTriggers.HasElement(handle))
 		{
 			trigger->StartTouch(this->GetPawn());
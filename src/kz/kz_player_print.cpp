@@ -19,27 +19,25 @@
 	} \
 	va_end(args);
 
-internal CRecipientFilter *CreateRecipientFilter(KZPlayer *targetPlayer, bool addSpectators)
+u64 KZPlayer::GetPrintRecipients(bool includeSpectators)
 {
-	if (!targetPlayer->GetController())
+	if (!this->GetController())
 	{
-		return nullptr;
+		return 0;
 	}
-	CRecipientFilter *filter = new CRecipientFilter();
-	CPlayerSlot slot = targetPlayer->GetPlayerSlot();
-	filter->AddRecipient(slot);
-	if (!addSpectators)
+	u64 recipients = 1ull << this->GetPlayerSlot().Get();
+	if (!includeSpectators)
 	{
-		return filter;
+		return recipients;
 	}
-	if (!targetPlayer->IsAlive())
+	if (!this->IsAlive())
 	{
-		return filter;
+		return recipients;
 	}
-	CCSPlayerPawn *targetPawn = targetPlayer->GetPawn();
+	CCSPlayerPawn *targetPawn = this->GetPawn();
 	if (!targetPawn)
 	{
-		return nullptr;
+		return 0;
 	}
 	for (int i = 0; i < g_pKZUtils->GetServerGlobals()->maxClients; i++)
 	{
@@ -59,64 +57,43 @@ internal CRecipientFilter *CreateRecipientFilter(KZPlayer *targetPlayer, bool ad
 		}
 		if (obsService->m_hObserverTarget().IsValid() && obsService->m_hObserverTarget().GetEntryIndex() == targetPawn->GetEntityIndex().Get())
 		{
-			filter->AddRecipient(player->GetPlayerSlot());
+			recipients |= 1ull << player->GetPlayerSlot().Get();
 		}
 	}
-	return filter;
+	return recipients;
 }
 
 void KZPlayer::PrintConsole(bool addPrefix, bool includeSpectators, const char *format, ...)
 {
 	FORMAT_STRING(buffer, addPrefix);
-	CRecipientFilter *filter = CreateRecipientFilter(this, includeSpectators);
-	if (!filter)
-	{
-		return;
-	}
-	utils::ClientPrintFilter(filter, HUD_PRINTCONSOLE, buffer, "", "", "", "");
-	delete filter;
+	utils::QueuePrint(this->GetPrintRecipients(includeSpectators), HUD_PRINTCONSOLE, buffer);
 }
 
 void KZPlayer::PrintChat(bool addPrefix, bool includeSpectators, const char *format, ...)
 {
-	FORMAT_STRING(buffer, addPrefix);
+	va_list args;
+	va_start(args, format);
 	char coloredBuffer[512];
-	if (!utils::CFormat(coloredBuffer, sizeof(coloredBuffer), buffer))
-	{
-		Warning("utils::CPrintChat did not have enough space to print: %s\n", buffer);
-		return;
-	}
-	CRecipientFilter *filter = CreateRecipientFilter(this, includeSpectators);
-	if (!filter)
+	bool formatted = utils::CFormatV(coloredBuffer, sizeof(coloredBuffer), addPrefix ? KZ_CHAT_PREFIX : nullptr, format, args);
+	va_end(args);
+	if (!formatted)
 	{
+		Warning("utils::CPrintChat did not have enough space to print: %s\n", format);
 		return;
 	}
-	utils::ClientPrintFilter(filter, HUD_PRINTTALK, coloredBuffer, "", "", "", "");
-	delete filter;
+	utils::QueuePrint(this->GetPrintRecipients(includeSpectators), HUD_PRINTTALK, coloredBuffer);
 }
 
 void KZPlayer::PrintCentre(bool addPrefix, bool includeSpectators, const char *format, ...)
 {
 	FORMAT_STRING(buffer, addPrefix);
-	CRecipientFilter *filter = CreateRecipientFilter(this, includeSpectators);
-	if (!filter)
-	{
-		return;
-	}
-	utils::ClientPrintFilter(filter, HUD_PRINTCENTER, buffer, "", "", "", "");
-	delete filter;
+	utils::QueuePrint(this->GetPrintRecipients(includeSpectators), HUD_PRINTCENTER, buffer);
 }
 
 void KZPlayer::PrintAlert(bool addPrefix, bool includeSpectators, const char *format, ...)
 {
 	FORMAT_STRING(buffer, addPrefix);
-	CRecipientFilter *filter = CreateRecipientFilter(this, includeSpectators);
-	if (!filter)
-	{
-		return;
-	}
-	utils::ClientPrintFilter(filter, HUD_PRINTALERT, buffer, "", "", "", "");
-	delete filter;
+	utils::QueuePrint(this->GetPrintRecipients(includeSpectators), HUD_PRINTALERT, buffer);
 }
 
 void KZPlayer::PrintHTMLCentre(bool addPrefix, bool includeSpectators, const char *format, ...)
@@ -127,8 +104,8 @@ void KZPlayer::PrintHTMLCentre(bool addPrefix, bool includeSpectators, const cha
 		utils::PrintHTMLCentre(this->GetController(), buffer);
 		return;
 	}
-	CRecipientFilter *filter = CreateRecipientFilter(this, includeSpectators);
-	if (!filter)
+	u64 recipients = this->GetPrintRecipients(includeSpectators);
+	if (!recipients)
 	{
 		return;
 	}
@@ -147,11 +124,13 @@ void KZPlayer::PrintHTMLCentre(bool addPrefix, bool includeSpectators, const cha
 	event->SetInt("duration", 5);
 	event->SetInt("userid", -1);
 
-	for (int i = 0; i < filter->GetRecipientCount(); i++)
+	for (int i = 0; i < MAXPLAYERS; i++)
 	{
-		IGameEventListener2 *listener = g_pKZUtils->GetLegacyGameEventListener(filter->GetRecipientIndex(i));
-		listener->FireGameEvent(event);
+		if (recipients & (1ull << i))
+		{
+			IGameEventListener2 *listener = g_pKZUtils->GetLegacyGameEventListener(CPlayerSlot(i));
+			listener->FireGameEvent(event);
+		}
 	}
 	interfaces::pGameEventManager->FreeEvent(event);
-	delete filter;
 }
@@ -3,7 +3,7 @@
 #include "../jumpstats/kz_jumpstats.h"
 #include "UtlStringMap.h"
 
-#define KZ_MODE_MANAGER_INTERFACE "KZModeManagerInterface"
+#define KZ_MODE_MANAGER_INTERFACE "KZModeManagerInterface002"
 class KZPlayer;
 
 class KZModeService : public KZBaseService
@@ -174,15 +174,21 @@ class KZModeManager
 		const char *longModeName;
 		ModeServiceFactory factory;
 		bool shortCmdRegistered;
+		u64 hooks;
+		// Parsed from the first service of this mode, the values are the same for every player.
+		KZ::mode::ModeCvarValues *cvarValues;
 	};
 
 public:
+	// hooks: Hooks implemented by the mode service, usually KZ::GetServiceHooks<Service, KZModeService>().
 	// clang-format off
-	virtual bool RegisterMode(PluginId id, const char *shortModeName, const char *longModeName, ModeServiceFactory factory);
+	virtual bool RegisterMode(PluginId id, const char *shortModeName, const char *longModeName, ModeServiceFactory factory, u64 hooks = MV_HOOKS_ALL);
 	// clang-format on
 
 	virtual void UnregisterMode(const char *modeName);
 	bool SwitchToMode(KZPlayer *player, const char *modeName, bool silent = false);
+	// Point the player to the parsed cvar values of its current mode service.
+	void UpdateModeCvarValues(KZPlayer *player);
 	void Cleanup();
 
 private:
@@ -236,6 +242,14 @@ namespace KZ::mode
 	inline ConVarHandle modeCvarHandles[numCvar];
 	inline ConVar *modeCvars[numCvar];
 
+	// Raw 32 bits of each mode cvar, as a float or an integer depending on the type of the cvar.
+	struct ModeCvarValues
+	{
+		u32 values[numCvar];
+	};
+
+	void ParseModeCvarValues(const char **strings, ModeCvarValues &out);
+	// Only writes the cvars that differ from the values of the player's mode.
 	void ApplyModeSettings(KZPlayer *player);
 	void DisableReplicatedModeCvars();
 	void EnableReplicatedModeCvars();
@@ -11,6 +11,7 @@ CGameConfig *g_pGameConfig = NULL;
 KZUtils *g_pKZUtils = NULL;
 KZModeManager *g_pModeManager = NULL;
 ModeServiceFactory g_ModeFactory = [](KZPlayer *player) -> KZModeService * { return new KZClassicModeService(player); };
+constexpr u64 g_ModeHooks = KZ::GetServiceHooks<KZClassicModeService, KZModeService>();
 PLUGIN_EXPOSE(KZClassicModePlugin, g_KZClassicModePlugin);
 
 bool KZClassicModePlugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t maxlen, bool late)
@@ -36,14 +37,23 @@ bool KZClassicModePlugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t m
 		V_snprintf(error, maxlen, "Failed to initialize interfaces");
 		return false;
 	}
+	if (!schema::ResolveFields())
+	{
+		Warning("Some schema fields could not be resolved.\n");
+	}
 
 	if (nullptr == (g_pGameConfig = g_pKZUtils->GetGameConfig()))
 	{
 		V_snprintf(error, maxlen, "Failed to get game config");
 		return false;
 	}
+	// Keys declared in this binary are separate from the core plugin's ones.
+	if (!g_pGameConfig->ResolveKeys(error, maxlen))
+	{
+		return false;
+	}
 
-	if (!g_pModeManager->RegisterMode(g_PLID, MODE_NAME_SHORT, MODE_NAME, g_ModeFactory))
+	if (!g_pModeManager->RegisterMode(g_PLID, MODE_NAME_SHORT, MODE_NAME, g_ModeFactory, g_ModeHooks))
 	{
 		V_snprintf(error, maxlen, "Failed to register mode");
 		return false;
@@ -66,7 +76,7 @@ bool KZClassicModePlugin::Pause(char *error, size_t maxlen)
 
 bool KZClassicModePlugin::Unpause(char *error, size_t maxlen)
 {
-	if (!g_pModeManager->RegisterMode(g_PLID, MODE_NAME_SHORT, MODE_NAME, g_ModeFactory))
+	if (!g_pModeManager->RegisterMode(g_PLID, MODE_NAME_SHORT, MODE_NAME, g_ModeFactory, g_ModeHooks))
 	{
 		return false;
 	}
@@ -287,7 +297,7 @@ void KZClassicModeService::OnProcessUsercmds(void *cmds, int numcmds)
 {
 	for (i32 i = 0; i < numcmds; i++)
 	{
-		auto address = reinterpret_cast<char *>(cmds) + i * (sizeof(CSGOUserCmdPB) + g_pGameConfig->GetOffset("UsercmdOffset"));
+		auto address = reinterpret_cast<char *>(cmds) + i * (sizeof(CSGOUserCmdPB) + g_pGameConfig->GetOffset(gamedata::usercmdOffset));
 		CSGOUserCmdPB *usercmdsPtr = reinterpret_cast<CSGOUserCmdPB *>(address);
 		for (i32 j = 0; j < usercmdsPtr->mutable_base()->subtick_moves_size(); j++)
 		{
@@ -452,148 +462,26 @@ void KZClassicModeService::ReduceDuckSlowdown()
 void KZClassicModeService::UpdateAngleHistory()
 {
 	CMoveData *mv = this->player->currentMoveData;
-	u32 oldEntries = 0;
-	FOR_EACH_VEC(this->angleHistory, i)
-	{
-		if (this->angleHistory[i].when + PS_TURN_RATE_WINDOW < g_pKZUtils->GetGlobals()->curtime)
-		{
-			oldEntries++;
-			continue;
-		}
-		break;
-	}
-	this->angleHistory.RemoveMultipleFromHead(oldEntries);
-	if ((this->player->GetPawn()->m_fFlags & FL_ONGROUND) == 0)
-	{
-		return;
-	}
-
-	AngleHistory *angHist = this->angleHistory.AddToTailGetPtr();
-	angHist->when = g_pKZUtils->GetGlobals()->curtime;
-	angHist->duration = g_pKZUtils->GetGlobals()->frametime;
-
-	// Not turning if velocity is null.
-	if (mv->m_vecVelocity.Length2D() == 0)
-	{
-		angHist->rate = 0;
-		return;
-	}
-
-	// Copying from WalkMove
-	Vector forward, right, up;
-	AngleVectors(mv->m_vecViewAngles, &forward, &right, &up);
-
-	f32 fmove = mv->m_flForwardMove;
-	f32 smove = -mv->m_flSideMove;
-
-	if (forward[2] != 0)
-	{
-		forward[2] = 0;
-		VectorNormalize(forward);
-	}
-
-	if (right[2] != 0)
-	{
-		right[2] = 0;
-		VectorNormalize(right);
-	}
-
-	Vector wishdir;
-	for (int i = 0; i < 2; i++)
-	{
-		wishdir[i] = forward[i] * fmove + right[i] * smove;
-	}
-	wishdir[2] = 0;
-
-	VectorNormalize(wishdir);
-
-	if (wishdir.Length() == 0)
-	{
-		angHist->rate = 0;
-		return;
-	}
-
-	Vector velocity = mv->m_vecVelocity;
-	velocity[2] = 0;
-	VectorNormalize(velocity);
-	QAngle accelAngle;
-	QAngle velAngle;
-	VectorAngles(wishdir, accelAngle);
-	VectorAngles(velocity, velAngle);
-	accelAngle.y = g_pKZUtils->NormalizeDeg(accelAngle.y);
-	velAngle.y = g_pKZUtils->NormalizeDeg(velAngle.y);
-	angHist->rate = g_pKZUtils->GetAngleDifference(velAngle.y, accelAngle.y, 180.0, true);
+	bool onGround = this->player->GetPawn()->m_fFlags & FL_ONGROUND;
+	KZ::ckz::UpdateAngleHistory(this->angleHistory, g_pKZUtils->GetGlobals()->curtime, g_pKZUtils->GetGlobals()->frametime, onGround,
+								mv->m_vecViewAngles, mv->m_flForwardMove, mv->m_flSideMove, mv->m_vecVelocity);
 }
 
 void KZClassicModeService::CalcPrestrafe()
 {
-	f32 totalDuration = 0;
-	f32 sumWeightedAngles = 0;
-	FOR_EACH_VEC(this->angleHistory, i)
-	{
-		sumWeightedAngles += this->angleHistory[i].rate * this->angleHistory[i].duration;
-		totalDuration += this->angleHistory[i].duration;
-	}
-	f32 averageRate;
-	if (totalDuration == 0)
-	{
-		averageRate = 0;
-	}
-	else
-	{
-		averageRate = sumWeightedAngles / totalDuration;
-	}
-
-	f32 rewardRate = Clamp(fabs(averageRate) / PS_MAX_REWARD_RATE, 0.0f, 1.0f) * g_pKZUtils->GetGlobals()->frametime;
-	f32 punishRate = 0.0f;
-	if (this->player->landingTime + PS_LANDING_GRACE_PERIOD < g_pKZUtils->GetGlobals()->curtime)
-	{
-		punishRate = g_pKZUtils->GetGlobals()->frametime * PS_DECREMENT_RATIO;
-	}
+	f32 averageRate = KZ::ckz::CalcAverageTurnRate(this->angleHistory);
 
-	if (this->player->GetPawn()->m_fFlags & FL_ONGROUND)
-	{
-		// Prevent instant full pre from crouched prestrafe.
-		Vector velocity;
-		this->player->GetVelocity(&velocity);
-
-		f32 currentPreRatio;
-		if (velocity.Length2D() <= 0.0f)
-		{
-			currentPreRatio = 0.0f;
-		}
-		else
-		{
-			currentPreRatio = pow(this->bonusSpeed / PS_SPEED_MAX * SPEED_NORMAL / velocity.Length2D(), 1 / PS_RATIO_TO_SPEED) * PS_MAX_PS_TIME;
-		}
-
-		this->leftPreRatio = MIN(this->leftPreRatio, currentPreRatio);
-		this->rightPreRatio = MIN(this->rightPreRatio, currentPreRatio);
-
-		this->leftPreRatio += averageRate > PS_MIN_REWARD_RATE ? rewardRate : -punishRate;
-		this->rightPreRatio += averageRate < -PS_MIN_REWARD_RATE ? rewardRate : -punishRate;
-		this->leftPreRatio = Clamp(leftPreRatio, 0.0f, PS_MAX_PS_TIME);
-		this->rightPreRatio = Clamp(rightPreRatio, 0.0f, PS_MAX_PS_TIME);
-		this->bonusSpeed = this->GetPrestrafeGain() / SPEED_NORMAL * velocity.Length2D();
-	}
-	else
-	{
-		rewardRate = g_pKZUtils->GetGlobals()->frametime;
-		// Raise both left and right pre to the same value as the player is in the air.
-		if (this->leftPreRatio < this->rightPreRatio)
-		{
-			this->leftPreRatio = Clamp(this->leftPreRatio + rewardRate, 0.0f, rightPreRatio);
-		}
-		else
-		{
-			this->rightPreRatio = Clamp(this->rightPreRatio + rewardRate, 0.0f, leftPreRatio);
-		}
-	}
+	Vector velocity;
+	this->player->GetVelocity(&velocity);
+	bool punish = this->player->landingTime + PS_LANDING_GRACE_PERIOD < g_pKZUtils->GetGlobals()->curtime;
+	bool onGround = this->player->GetPawn()->m_fFlags & FL_ONGROUND;
+	KZ::ckz::UpdatePrestrafeRatios(this->leftPreRatio, this->rightPreRatio, this->bonusSpeed, averageRate, g_pKZUtils->GetGlobals()->frametime,
+								   punish, onGround, velocity.Length2D());
 }
 
 f32 KZClassicModeService::GetPrestrafeGain()
 {
-	return PS_SPEED_MAX * pow(MAX(this->leftPreRatio, this->rightPreRatio) / PS_MAX_PS_TIME, PS_RATIO_TO_SPEED);
+	return KZ::ckz::CalcPrestrafeGain(this->leftPreRatio, this->rightPreRatio);
 }
 
 void KZClassicModeService::CheckVelocityQuantization()
@@ -635,34 +523,14 @@ void KZClassicModeService::SlopeFix()
 		return;
 	}
 	// TODO: Unhardcode sv_standable_normal
-	if (standableZ <= trace.planeNormal.z && trace.planeNormal.z < 1.0f)
-	{
-		// Copy the ClipVelocity function from sdk2013
-		float backoff;
-		float change;
-		Vector newVelocity;
-
-		backoff = DotProduct(this->player->landingVelocity, trace.planeNormal) * 1;
-
-		for (u32 i = 0; i < 3; i++)
-		{
-			change = trace.planeNormal[i] * backoff;
-			newVelocity[i] = this->player->landingVelocity[i] - change;
-		}
-
-		f32 adjust = DotProduct(newVelocity, trace.planeNormal);
-		if (adjust < 0.0f)
-		{
-			newVelocity -= (trace.planeNormal * adjust);
-		}
-		// Make sure the player is going down a ramp by checking if they actually will gain speed from the boost.
-		if (newVelocity.Length2D() >= this->player->landingVelocity.Length2D())
-		{
-			this->player->currentMoveData->m_vecVelocity.x = newVelocity.x;
-			this->player->currentMoveData->m_vecVelocity.y = newVelocity.y;
-			this->player->landingVelocity.x = newVelocity.x;
-			this->player->landingVelocity.y = newVelocity.y;
-		}
+	Vector newVelocity;
+	if (standableZ <= trace.planeNormal.z && trace.planeNormal.z < 1.0f
+		&& KZ::ckz::CalcSlopeFixVelocity(this->player->landingVelocity, trace.planeNormal, newVelocity))
+	{
+		this->player->currentMoveData->m_vecVelocity.x = newVelocity.x;
+		this->player->currentMoveData->m_vecVelocity.y = newVelocity.y;
+		this->player->landingVelocity.x = newVelocity.x;
+		this->player->landingVelocity.y = newVelocity.y;
 	}
 }
 
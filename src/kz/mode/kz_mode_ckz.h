@@ -33,6 +33,31 @@
 #define DUCK_SPEED_NORMAL  8.0f
 #define DUCK_SPEED_MINIMUM 6.0234375f // Equal to if you just ducked/unducked for the first time in a while
 
+// Mode math that doesn't need a player or the engine, also built into the benchmark (src/bench).
+namespace KZ::ckz
+{
+	struct AngleHistory
+	{
+		f32 rate;
+		f32 when;
+		f32 duration;
+	};
+
+	// Turn rate of the wish direction relative to the horizontal velocity in degrees, 0 if either of them is null.
+	f32 CalcTurnRate(const QAngle &viewAngles, f32 forwardMove, f32 sideMove, const Vector &velocity);
+	// Drop the entries older than PS_TURN_RATE_WINDOW, then add this tick's turn rate if the player is on the ground.
+	void UpdateAngleHistory(CUtlVector<AngleHistory> &angleHistory, f32 curtime, f32 frametime, bool onGround, const QAngle &viewAngles,
+							f32 forwardMove, f32 sideMove, const Vector &velocity);
+	// Turn rate averaged over the history weighted by duration, 0 if the history is empty.
+	f32 CalcAverageTurnRate(const CUtlVector<AngleHistory> &angleHistory);
+	// Reward or punish the prestrafe ratios with the average turn rate over the last PS_TURN_RATE_WINDOW.
+	void UpdatePrestrafeRatios(f32 &leftPreRatio, f32 &rightPreRatio, f32 &bonusSpeed, f32 averageRate, f32 frametime, bool punish, bool onGround,
+							   f32 speed2D);
+	f32 CalcPrestrafeGain(f32 leftPreRatio, f32 rightPreRatio);
+	// Clip the landing velocity to the slope, returns false if that doesn't make the player faster.
+	bool CalcSlopeFixVelocity(const Vector &landingVelocity, const Vector &planeNormal, Vector &newVelocity);
+} // namespace KZ::ckz
+
 class KZClassicModePlugin : public ISmmPlugin, public IMetamodListener
 {
 public:
@@ -105,14 +130,7 @@ class KZClassicModeService : public KZModeService
 	bool forcedUnduck {};
 	f32 postProcessMovementZSpeed {};
 
-	struct AngleHistory
-	{
-		f32 rate;
-		f32 when;
-		f32 duration;
-	};
-
-	CUtlVector<AngleHistory> angleHistory;
+	CUtlVector<KZ::ckz::AngleHistory> angleHistory;
 	f32 leftPreRatio {};
 	f32 rightPreRatio {};
 	f32 bonusSpeed {};
@@ -0,0 +1,173 @@
+#include "kz_mode_ckz.h"
+#include "utils/utils.h"
+
+#include "tier0/memdbgon.h"
+
+f32 KZ::ckz::CalcTurnRate(const QAngle &viewAngles, f32 forwardMove, f32 sideMove, const Vector &velocity)
+{
+	// Not turning if velocity is null.
+	if (velocity.Length2D() == 0)
+	{
+		return 0;
+	}
+
+	// Copying from WalkMove
+	Vector forward, right, up;
+	AngleVectors(viewAngles, &forward, &right, &up);
+
+	f32 fmove = forwardMove;
+	f32 smove = -sideMove;
+
+	if (forward[2] != 0)
+	{
+		forward[2] = 0;
+		VectorNormalize(forward);
+	}
+
+	if (right[2] != 0)
+	{
+		right[2] = 0;
+		VectorNormalize(right);
+	}
+
+	Vector wishdir;
+	for (int i = 0; i < 2; i++)
+	{
+		wishdir[i] = forward[i] * fmove + right[i] * smove;
+	}
+	wishdir[2] = 0;
+
+	VectorNormalize(wishdir);
+
+	if (wishdir.Length() == 0)
+	{
+		return 0;
+	}
+
+	Vector velocity2D = velocity;
+	velocity2D[2] = 0;
+	VectorNormalize(velocity2D);
+	QAngle accelAngle;
+	QAngle velAngle;
+	VectorAngles(wishdir, accelAngle);
+	VectorAngles(velocity2D, velAngle);
+	accelAngle.y = utils::NormalizeDeg(accelAngle.y);
+	velAngle.y = utils::NormalizeDeg(velAngle.y);
+	return utils::GetAngleDifference(velAngle.y, accelAngle.y, 180.0, true);
+}
+
+void KZ::ckz::UpdateAngleHistory(CUtlVector<AngleHistory> &angleHistory, f32 curtime, f32 frametime, bool onGround, const QAngle &viewAngles,
+								 f32 forwardMove, f32 sideMove, const Vector &velocity)
+{
+	u32 oldEntries = 0;
+	FOR_EACH_VEC(angleHistory, i)
+	{
+		if (angleHistory[i].when + PS_TURN_RATE_WINDOW < curtime)
+		{
+			oldEntries++;
+			continue;
+		}
+		break;
+	}
+	angleHistory.RemoveMultipleFromHead(oldEntries);
+	if (!onGround)
+	{
+		return;
+	}
+
+	AngleHistory *angHist = angleHistory.AddToTailGetPtr();
+	angHist->when = curtime;
+	angHist->duration = frametime;
+	angHist->rate = CalcTurnRate(viewAngles, forwardMove, sideMove, velocity);
+}
+
+f32 KZ::ckz::CalcAverageTurnRate(const CUtlVector<AngleHistory> &angleHistory)
+{
+	f32 totalDuration = 0;
+	f32 sumWeightedAngles = 0;
+	FOR_EACH_VEC(angleHistory, i)
+	{
+		sumWeightedAngles += angleHistory[i].rate * angleHistory[i].duration;
+		totalDuration += angleHistory[i].duration;
+	}
+	if (totalDuration == 0)
+	{
+		return 0;
+	}
+	return sumWeightedAngles / totalDuration;
+}
+
+void KZ::ckz::UpdatePrestrafeRatios(f32 &leftPreRatio, f32 &rightPreRatio, f32 &bonusSpeed, f32 averageRate, f32 frametime, bool punish,
+									bool onGround, f32 speed2D)
+{
+	f32 rewardRate = Clamp(fabs(averageRate) / PS_MAX_REWARD_RATE, 0.0f, 1.0f) * frametime;
+	f32 punishRate = 0.0f;
+	if (punish)
+	{
+		punishRate = frametime * PS_DECREMENT_RATIO;
+	}
+
+	if (onGround)
+	{
+		// Prevent instant full pre from crouched prestrafe.
+		f32 currentPreRatio;
+		if (speed2D <= 0.0f)
+		{
+			currentPreRatio = 0.0f;
+		}
+		else
+		{
+			currentPreRatio = pow(bonusSpeed / PS_SPEED_MAX * SPEED_NORMAL / speed2D, 1 / PS_RATIO_TO_SPEED) * PS_MAX_PS_TIME;
+		}
+
+		leftPreRatio = MIN(leftPreRatio, currentPreRatio);
+		rightPreRatio = MIN(rightPreRatio, currentPreRatio);
+
+		leftPreRatio += averageRate > PS_MIN_REWARD_RATE ? rewardRate : -punishRate;
+		rightPreRatio += averageRate < -PS_MIN_REWARD_RATE ? rewardRate : -punishRate;
+		leftPreRatio = Clamp(leftPreRatio, 0.0f, PS_MAX_PS_TIME);
+		rightPreRatio = Clamp(rightPreRatio, 0.0f, PS_MAX_PS_TIME);
+		bonusSpeed = CalcPrestrafeGain(leftPreRatio, rightPreRatio) / SPEED_NORMAL * speed2D;
+	}
+	else
+	{
+		rewardRate = frametime;
+		// Raise both left and right pre to the same value as the player is in the air.
+		if (leftPreRatio < rightPreRatio)
+		{
+			leftPreRatio = Clamp(leftPreRatio + rewardRate, 0.0f, rightPreRatio);
+		}
+		else
+		{
+			rightPreRatio = Clamp(rightPreRatio + rewardRate, 0.0f, leftPreRatio);
+		}
+	}
+}
+
+f32 KZ::ckz::CalcPrestrafeGain(f32 leftPreRatio, f32 rightPreRatio)
+{
+	return PS_SPEED_MAX * pow(MAX(leftPreRatio, rightPreRatio) / PS_MAX_PS_TIME, PS_RATIO_TO_SPEED);
+}
+
+bool KZ::ckz::CalcSlopeFixVelocity(const Vector &landingVelocity, const Vector &planeNormal, Vector &newVelocity)
+{
+	// Copy the ClipVelocity function from sdk2013
+	float backoff;
+	float change;
+
+	backoff = DotProduct(landingVelocity, planeNormal) * 1;
+
+	for (u32 i = 0; i < 3; i++)
+	{
+		change = planeNormal[i] * backoff;
+		newVelocity[i] = landingVelocity[i] - change;
+	}
+
+	f32 adjust = DotProduct(newVelocity, planeNormal);
+	if (adjust < 0.0f)
+	{
+		newVelocity -= (planeNormal * adjust);
+	}
+	// Make sure the player is going down a ramp by checking if they actually will gain speed from the boost.
+	return newVelocity.Length2D() >= landingVelocity.Length2D();
+}
@@ -9,6 +9,7 @@
 #include "../timer/kz_timer.h"
 #include "utils/simplecmds.h"
 #include "utils/plat.h"
+#include "movement/mv_perf.h"
 
 internal SCMD_CALLBACK(Command_KzModeShort);
 internal SCMD_CALLBACK(Command_KzMode);
@@ -41,7 +42,7 @@ void KZ::mode::InitModeManager()
 		return;
 	}
 	ModeServiceFactory vnlFactory = [](KZPlayer *player) -> KZModeService * { return new KZVanillaModeService(player); };
-	modeManager.RegisterMode(0, "VNL", "Vanilla", vnlFactory);
+	modeManager.RegisterMode(0, "VNL", "Vanilla", vnlFactory, KZ::GetServiceHooks<KZVanillaModeService, KZModeService>());
 	initialized = true;
 }
 
@@ -77,6 +78,9 @@ void KZ::mode::InitModeService(KZPlayer *player)
 {
 	delete player->modeService;
 	player->modeService = new KZVanillaModeService(player);
+	player->modeServiceHooks = KZ::GetServiceHooks<KZVanillaModeService, KZModeService>();
+	player->UpdateActiveHooks();
+	player->modeCvarValues = nullptr;
 }
 
 void KZ::mode::DisableReplicatedModeCvars()
@@ -97,38 +101,57 @@ void KZ::mode::EnableReplicatedModeCvars()
 	}
 }
 
-void KZ::mode::ApplyModeSettings(KZPlayer *player)
+void KZ::mode::ParseModeCvarValues(const char **strings, ModeCvarValues &out)
 {
 	for (u32 i = 0; i < numCvar; i++)
 	{
-		auto value = reinterpret_cast<CVValue_t *>(&(modeCvars[i]->values));
+		CVValue_t value {};
 		if (modeCvars[i]->m_eVarType == EConVarType_Float32)
 		{
-			f32 newValue = atof(player->modeService->GetModeConVarValues()[i]);
-			value->m_flValue = newValue;
+			value.m_flValue = atof(strings[i]);
+		}
+		else if (V_stricmp(strings[i], "true") == 0)
+		{
+			value.m_i32Value = 1;
+		}
+		else if (V_stricmp(strings[i], "false") == 0)
+		{
+			value.m_i32Value = 0;
 		}
 		else
 		{
-			i32 newValue;
-			if (V_stricmp(player->modeService->GetModeConVarValues()[i], "true") == 0)
-			{
-				newValue = 1;
-			}
-			else if (V_stricmp(player->modeService->GetModeConVarValues()[i], "false") == 0)
-			{
-				newValue = 0;
-			}
-			else
-			{
-				newValue = atoi(player->modeService->GetModeConVarValues()[i]);
-			}
-			value->m_i32Value = newValue;
+			value.m_i32Value = atoi(strings[i]);
+		}
+		out.values[i] = (u32)value.m_i32Value;
+	}
+}
+
+void KZ::mode::ApplyModeSettings(KZPlayer *player)
+{
+	if (!player->modeCvarValues)
+	{
+		g_pKZModeManager->UpdateModeCvarValues(player);
+	}
+	const ModeCvarValues *newValues = player->modeCvarValues;
+	ModeCvarValues parsedValues;
+	if (!newValues)
+	{
+		// The mode isn't registered, nothing to cache the values in.
+		ParseModeCvarValues(player->modeService->GetModeConVarValues(), parsedValues);
+		newValues = &parsedValues;
+	}
+	for (u32 i = 0; i < numCvar; i++)
+	{
+		auto value = reinterpret_cast<CVValue_t *>(&(modeCvars[i]->values));
+		if ((u32)value->m_i32Value != newValues->values[i])
+		{
+			value->m_i32Value = (i32)newValues->values[i];
 		}
 	}
 	player->enableWaterFix = player->modeService->EnableWaterFix();
 }
 
-bool KZModeManager::RegisterMode(PluginId id, const char *shortModeName, const char *longModeName, ModeServiceFactory factory)
+bool KZModeManager::RegisterMode(PluginId id, const char *shortModeName, const char *longModeName, ModeServiceFactory factory, u64 hooks)
 {
 	if (!shortModeName || V_strlen(shortModeName) == 0 || !longModeName || V_strlen(longModeName) == 0)
 	{
@@ -152,7 +175,7 @@ bool KZModeManager::RegisterMode(PluginId id, const char *shortModeName, const c
 	V_snprintf(shortModeCmd, 64, "kz_%s", shortModeName);
 	V_snprintf(shortModeCmdDesc, 64, "Switch to %s mode.", longModeName);
 	bool shortCmdRegistered = scmd::RegisterCmd(V_strlower(shortModeCmd), Command_KzModeShort, shortModeCmdDesc);
-	this->modeInfos.AddToTail({id, shortModeName, longModeName, factory, shortCmdRegistered});
+	this->modeInfos.AddToTail({id, shortModeName, longModeName, factory, shortCmdRegistered, hooks, nullptr});
 	return true;
 }
 
@@ -169,6 +192,7 @@ void KZModeManager::UnregisterMode(const char *modeName)
 		return;
 	}
 
+	KZ::mode::ModeCvarValues *cvarValues = nullptr;
 	FOR_EACH_VEC(this->modeInfos, i)
 	{
 		if (V_stricmp(this->modeInfos[i].shortModeName, modeName) == 0 || V_stricmp(this->modeInfos[i].longModeName, modeName) == 0)
@@ -176,6 +200,7 @@ void KZModeManager::UnregisterMode(const char *modeName)
 			char shortModeCmd[64];
 			V_snprintf(shortModeCmd, 64, "kz_%s", this->modeInfos[i].shortModeName);
 			scmd::UnregisterCmd(shortModeCmd);
+			cvarValues = this->modeInfos[i].cvarValues;
 			this->modeInfos.Remove(i);
 			break;
 		}
@@ -189,6 +214,8 @@ void KZModeManager::UnregisterMode(const char *modeName)
 			this->SwitchToMode(player, "VNL");
 		}
 	}
+	// Players are off the mode now, nothing points to its values anymore.
+	delete cvarValues;
 }
 
 bool KZModeManager::SwitchToMode(KZPlayer *player, const char *modeName, bool silent)
@@ -219,12 +246,14 @@ bool KZModeManager::SwitchToMode(KZPlayer *player, const char *modeName, bool si
 	}
 
 	ModeServiceFactory factory = nullptr;
+	u64 hooks = MV_HOOKS_ALL;
 
 	FOR_EACH_VEC(this->modeInfos, i)
 	{
 		if (V_stricmp(this->modeInfos[i].shortModeName, modeName) == 0 || V_stricmp(this->modeInfos[i].longModeName, modeName) == 0)
 		{
 			factory = this->modeInfos[i].factory;
+			hooks = this->modeInfos[i].hooks;
 			break;
 		}
 	}
@@ -239,8 +268,12 @@ bool KZModeManager::SwitchToMode(KZPlayer *player, const char *modeName, bool si
 	player->modeService->Cleanup();
 	delete player->modeService;
 	player->modeService = factory(player);
+	player->modeServiceHooks = hooks;
+	player->UpdateActiveHooks();
+	this->UpdateModeCvarValues(player);
 	player->timerService->TimerStop();
 	player->modeService->Init();
+	movement::perf::SetPlayerContext(player->index, player->modeService->GetModeShortName(), player->styleService->GetStyleShortName());
 
 	if (!silent)
 	{
@@ -251,22 +284,50 @@ bool KZModeManager::SwitchToMode(KZPlayer *player, const char *modeName, bool si
 	return true;
 }
 
+void KZModeManager::UpdateModeCvarValues(KZPlayer *player)
+{
+	const char *shortModeName = player->modeService->GetModeShortName();
+	FOR_EACH_VEC(this->modeInfos, i)
+	{
+		if (V_stricmp(this->modeInfos[i].shortModeName, shortModeName) == 0)
+		{
+			if (!this->modeInfos[i].cvarValues)
+			{
+				this->modeInfos[i].cvarValues = new KZ::mode::ModeCvarValues();
+				KZ::mode::ParseModeCvarValues(player->modeService->GetModeConVarValues(), *this->modeInfos[i].cvarValues);
+			}
+			player->modeCvarValues = this->modeInfos[i].cvarValues;
+			return;
+		}
+	}
+	player->modeCvarValues = nullptr;
+}
+
 void KZModeManager::Cleanup()
 {
 	int ret;
 	ISmmPluginManager *pluginManager = (ISmmPluginManager *)g_SMAPI->MetaFactory(MMIFACE_PLMANAGER, &ret, 0);
-	if (ret == META_IFACE_FAILED)
+	if (ret != META_IFACE_FAILED)
 	{
-		return;
+		char error[256];
+		FOR_EACH_VEC(this->modeInfos, i)
+		{
+			if (this->modeInfos[i].id == 0)
+			{
+				continue;
+			}
+			pluginManager->Unload(this->modeInfos[i].id, true, error, sizeof(error));
+		}
+	}
+	// Whatever is still registered (at least VNL) keeps its parsed values until here.
+	for (u32 i = 0; i < MAXPLAYERS + 1; i++)
+	{
+		g_pKZPlayerManager->ToPlayer(i)->modeCvarValues = nullptr;
 	}
-	char error[256];
 	FOR_EACH_VEC(this->modeInfos, i)
 	{
-		if (this->modeInfos[i].id == 0)
-		{
-			continue;
-		}
-		pluginManager->Unload(this->modeInfos[i].id, true, error, sizeof(error));
+		delete this->modeInfos[i].cvarValues;
+		this->modeInfos[i].cvarValues = nullptr;
 	}
 }
 
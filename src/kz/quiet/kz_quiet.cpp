@@ -8,15 +8,92 @@
 
 #include "utils/utils.h"
 
+// Bit per player slot, set if that player currently hides other players.
+internal u64 hidersMask;
+
+// Entities to remove from a transmit list. The words that have bits set are listed,
+// so applying the mask only touches those instead of the whole bit vector.
+struct TransmitHideMask
+{
+	u32 bits[MV_MAX_NETWORKED_ENTITIES / 32];
+	u16 usedWords[MV_MAX_NETWORKED_ENTITIES / 32];
+	u32 numUsedWords;
+
+	void Add(u32 entIndex)
+	{
+		u32 word = entIndex / 32;
+		if (!this->bits[word])
+		{
+			this->usedWords[this->numUsedWords++] = word;
+		}
+		this->bits[word] |= 1u << (entIndex % 32);
+	}
+
+	void Clear()
+	{
+		for (u32 i = 0; i < this->numUsedWords; i++)
+		{
+			this->bits[this->usedWords[i]] = 0;
+		}
+		this->numUsedWords = 0;
+	}
+
+	void ApplyTo(CBitVec<16384> *transmitEdict) const
+	{
+		u32 *words = transmitEdict->Base();
+		for (u32 i = 0; i < this->numUsedWords; i++)
+		{
+			words[this->usedWords[i]] &= ~this->bits[this->usedWords[i]];
+		}
+	}
+};
+
+// Pawns that must never be sent: dead or without a controller.
+internal TransmitHideMask unsafePawns;
+// Every other pawn, hidden from players using !hide.
+internal TransmitHideMask visiblePawns;
+
+internal void UpdateTransmitHideMasks()
+{
+	unsafePawns.Clear();
+	visiblePawns.Clear();
+
+	EntityInstanceByClassIter_t iter(NULL, "player");
+	// clang-format off
+	for (CCSPlayerPawn *pawn = static_cast<CCSPlayerPawn *>(iter.First());
+		 pawn != NULL;
+		 pawn = pawn->m_pEntity->m_pNextByClass ? static_cast<CCSPlayerPawn *>(pawn->m_pEntity->m_pNextByClass->m_pInstance) : nullptr)
+	// clang-format on
+	{
+		u32 entIndex = pawn->entindex();
+		if (entIndex >= MV_MAX_NETWORKED_ENTITIES)
+		{
+			continue;
+		}
+		// Do not transmit a pawn without any controller or a dead pawn to prevent crashes.
+		if (!pawn->m_hController().IsValid() || pawn->m_lifeState() != LIFE_ALIVE)
+		{
+			unsafePawns.Add(entIndex);
+		}
+		else
+		{
+			visiblePawns.Add(entIndex);
+		}
+	}
+}
+
 void KZ::quiet::OnCheckTransmit(CCheckTransmitInfo **pInfo, int infoCount)
 {
+	UpdateTransmitHideMasks();
+	i32 playerSlotOffset = g_pGameConfig->GetOffset(gamedata::quietPlayerSlot);
+
 	for (int i = 0; i < infoCount; i++)
 	{
 		// Cast it to our own TransmitInfo struct because CCheckTransmitInfo isn't correct.
 		TransmitInfo *pTransmitInfo = reinterpret_cast<TransmitInfo *>(pInfo[i]);
 
 		// Find out who this info will be sent to.
-		uintptr_t targetAddr = reinterpret_cast<uintptr_t>(pTransmitInfo) + g_pGameConfig->GetOffset("QuietPlayerSlot");
+		uintptr_t targetAddr = reinterpret_cast<uintptr_t>(pTransmitInfo) + playerSlotOffset;
 		CPlayerSlot targetSlot = CPlayerSlot(*reinterpret_cast<int *>(targetAddr));
 		KZPlayer *targetPlayer = g_pKZPlayerManager->ToPlayer(targetSlot);
 		// Make sure the target isn't CSTV.
@@ -27,56 +104,32 @@ void KZ::quiet::OnCheckTransmit(CCheckTransmitInfo **pInfo, int infoCount)
 		}
 		targetPlayer->quietService->UpdateHideState();
 		CCSPlayerPawn *targetPlayerPawn = targetPlayer->GetPawn();
+		CBitVec<16384> *transmitEdict = pTransmitInfo->m_pTransmitEdict;
+
+		// The target's own pawn is never hidden from them.
+		i32 ownIndex = targetPlayerPawn ? targetPlayerPawn->entindex() : -1;
+		bool ownPawnTransmitted = ownIndex >= 0 && ownIndex < MV_MAX_NETWORKED_ENTITIES && transmitEdict->IsBitSet(ownIndex);
+
+		unsafePawns.ApplyTo(transmitEdict);
+		if (targetPlayer->quietService->ShouldHide())
+		{
+			visiblePawns.ApplyTo(transmitEdict);
+		}
+		if (ownPawnTransmitted)
+		{
+			transmitEdict->Set(ownIndex);
+		}
 
-		EntityInstanceByClassIter_t iter(NULL, "player");
-		// clang-format off
-		for (CCSPlayerPawn *pawn = static_cast<CCSPlayerPawn *>(iter.First());
-			 pawn != NULL;
-			 pawn = pawn->m_pEntity->m_pNextByClass ? static_cast<CCSPlayerPawn *>(pawn->m_pEntity->m_pNextByClass->m_pInstance) : nullptr)
-		// clang-format on
+		// Hide weapon stuff.
+		if (targetPlayerPawn && targetPlayer->quietService->ShouldHideWeapon())
 		{
-			if (targetPlayerPawn == pawn)
+			for (u32 j = 0; j < 3; j++)
 			{
-				// Hide weapon stuff.
-				if (targetPlayer->quietService->ShouldHideWeapon())
+				if (!targetPlayerPawn->m_pViewModelServices->m_hViewModel[j].IsValid())
 				{
-					for (u32 j = 0; j < 3; j++)
-					{
-						if (!pawn->m_pViewModelServices->m_hViewModel[j].IsValid())
-						{
-							continue;
-						}
-						pTransmitInfo->m_pTransmitEdict->Clear(pawn->m_pViewModelServices->m_hViewModel[j].GetEntryIndex());
-					}
+					continue;
 				}
-				continue;
-			}
-			// Bit is not even set, don't bother.
-			if (!pTransmitInfo->m_pTransmitEdict->IsBitSet(pawn->entindex()))
-			{
-				continue;
-			}
-			// Do not transmit a pawn without any controller to prevent crashes.
-			if (!pawn->m_hController().IsValid())
-			{
-				pTransmitInfo->m_pTransmitEdict->Clear(pawn->entindex());
-				continue;
-			}
-			// Never send dead players to prevent crashes.
-			if (pawn->m_lifeState() != LIFE_ALIVE)
-			{
-				pTransmitInfo->m_pTransmitEdict->Clear(pawn->entindex());
-				continue;
-			}
-			// Finally check if player is using !hide.
-			if (!targetPlayer->quietService->ShouldHide())
-			{
-				continue;
-			}
-			u32 index = g_pKZPlayerManager->ToPlayer(pawn)->index;
-			if (targetPlayer->quietService->ShouldHideIndex(index))
-			{
-				pTransmitInfo->m_pTransmitEdict->Clear(pawn->entindex());
+				transmitEdict->Clear(targetPlayerPawn->m_pViewModelServices->m_hViewModel[j].GetEntryIndex());
 			}
 		}
 	}
@@ -85,7 +138,7 @@ void KZ::quiet::OnCheckTransmit(CCheckTransmitInfo **pInfo, int infoCount)
 void KZ::quiet::OnPostEvent(INetworkSerializable *pEvent, const void *pData, const uint64 *clients)
 {
 	NetMessageInfo_t *info = pEvent->GetNetMessageInfo();
-	u32 entIndex, playerIndex;
+	u32 entIndex;
 
 	switch (info->m_MessageId)
 	{
@@ -124,27 +177,16 @@ void KZ::quiet::OnPostEvent(INetworkSerializable *pEvent, const void *pData, con
 	// Convert this entindex into the index in the player controller.
 	if (ent->IsPawn())
 	{
-		CBasePlayerPawn *pawn = static_cast<CBasePlayerPawn *>(ent);
-		playerIndex = g_pKZPlayerManager->ToPlayer(utils::GetController(pawn))->index;
-		for (int i = 0; i < MAXPLAYERS; i++)
+		KZPlayer *player = g_pKZPlayerManager->ToPlayer(static_cast<CBasePlayerPawn *>(ent));
+		if (player)
 		{
-			if (g_pKZPlayerManager->ToPlayer(i)->quietService->ShouldHide()
-				&& g_pKZPlayerManager->ToPlayer(i)->quietService->ShouldHideIndex(playerIndex))
-			{
-				*(uint64 *)clients &= ~i;
-			}
+			*(uint64 *)clients &= ~player->quietService->GetHiddenByMask();
 		}
 	}
 	// Special case for the armor sound upon spawning/respawning.
 	else if (V_strcmp(ent->GetClassname(), "item_assaultsuit") == 0 || V_strstr(ent->GetClassname(), "weapon_"))
 	{
-		for (int i = 0; i < MAXPLAYERS; i++)
-		{
-			if (g_pKZPlayerManager->ToPlayer(i)->quietService->ShouldHide())
-			{
-				*(uint64 *)clients &= ~i;
-			}
-		}
+		*(uint64 *)clients &= ~hidersMask;
 	}
 }
 
@@ -152,12 +194,42 @@ void KZQuietService::Reset()
 {
 	this->hideOtherPlayers = false;
 	this->hideWeapon = false;
+	this->UpdateHidersMask();
+}
+
+void KZQuietService::UpdateHidersMask()
+{
+	i32 slot = this->player->GetPlayerSlot().Get();
+	if (slot < 0 || slot >= 64)
+	{
+		return;
+	}
+	u64 bit = 1ull << slot;
+	if (this->ShouldHide())
+	{
+		hidersMask |= bit;
+	}
+	else
+	{
+		hidersMask &= ~bit;
+	}
+}
+
+u64 KZQuietService::GetHiddenByMask()
+{
+	i32 slot = this->player->GetPlayerSlot().Get();
+	if (slot < 0 || slot >= 64)
+	{
+		return 0;
+	}
+	// Nobody hides themselves.
+	return hidersMask & ~(1ull << slot);
 }
 
 void KZQuietService::SendFullUpdate()
 {
-	auto slots = *(void ***)((char *)g_pNetworkServerService->GetIGameServer() + g_pGameConfig->GetOffset("ClientOffset"));
-	*(uint32_t *)((char *)slots[this->player->GetPlayerSlot().Get()] + g_pGameConfig->GetOffset("ACKOffset")) = -1;
+	auto slots = *(void ***)((char *)g_pNetworkServerService->GetIGameServer() + g_pGameConfig->GetOffset(gamedata::clientOffset));
+	*(uint32_t *)((char *)slots[this->player->GetPlayerSlot().Get()] + g_pGameConfig->GetOffset(gamedata::ackOffset)) = -1;
 }
 
 bool KZQuietService::ShouldHide()
@@ -190,10 +262,13 @@ bool KZQuietService::ShouldHideIndex(u32 targetIndex)
 void KZQuietService::ToggleHide()
 {
 	this->hideOtherPlayers = !this->hideOtherPlayers;
+	this->UpdateHidersMask();
 }
 
 void KZQuietService::UpdateHideState()
 {
+	// Catch life state changes that happen without a death or spawn event.
+	this->UpdateHidersMask();
 	CPlayer_ObserverServices *obsServices = this->player->GetController()->m_hPawn()->m_pObserverServices;
 	if (!obsServices)
 	{
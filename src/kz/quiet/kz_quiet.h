@@ -26,6 +26,10 @@ public:
 	void SendFullUpdate();
 	bool ShouldHide();
 	bool ShouldHideIndex(u32 targetIndex);
+	// Keeps this player's bit in the mask of players hiding others in sync with ShouldHide.
+	void UpdateHidersMask();
+	// Player slots that shouldn't receive events coming from this player.
+	u64 GetHiddenByMask();
 
 	bool ShouldHideWeapon()
 	{
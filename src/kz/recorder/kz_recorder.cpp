@@ -0,0 +1,501 @@
+#include "kz_recorder.h"
+#include "kz/style/kz_style.h"
+#include "kz/option/kz_option.h"
+#include "utils/utils.h"
+#include "utils/simplecmds.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <ctime>
+
+#include "tier0/memdbgon.h"
+
+// Encoded bytes collected before they are written to the file.
+#define KZ_RECORDER_WRITE_BUFFER_SIZE 65536
+// Upper bound of the encoded size of a single entry.
+#define KZ_RECORDER_MAX_RECORD_SIZE   1024
+
+struct RecorderWriterState
+{
+	FILE *file;
+	RecorderTick previous;
+	u32 droppedReported;
+};
+
+internal bool enabled;
+internal std::atomic<RecorderRing *> rings[MAXPLAYERS + 1];
+
+// Only touched by the writer thread after startup.
+internal RecorderWriterState writerStates[MAXPLAYERS + 1];
+internal u8 writeBuffer[KZ_RECORDER_WRITE_BUFFER_SIZE];
+
+internal std::thread writerThread;
+internal std::mutex writerMutex;
+internal std::condition_variable writerWakeup;
+internal bool writerStopping;
+
+internal SCMD_CALLBACK(Command_KzRecorder);
+
+internal u32 FloatBits(f32 value)
+{
+	u32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+internal void StoreVector(u32 *fields, const Vector &vec)
+{
+	fields[0] = FloatBits(vec.x);
+	fields[1] = FloatBits(vec.y);
+	fields[2] = FloatBits(vec.z);
+}
+
+internal void StoreAngles(u32 *fields, const QAngle &angles)
+{
+	fields[0] = FloatBits(angles.x);
+	fields[1] = FloatBits(angles.y);
+	fields[2] = FloatBits(angles.z);
+}
+
+internal u8 *WriteVarint(u8 *out, u64 value)
+{
+	while (value >= 0x80)
+	{
+		*out++ = (u8)(value | 0x80);
+		value >>= 7;
+	}
+	*out++ = (u8)value;
+	return out;
+}
+
+internal u64 ZigZag(i64 value)
+{
+	return ((u64)value << 1) ^ (u64)(value >> 63);
+}
+
+internal u8 *WriteBytes(u8 *out, const void *data, size_t size)
+{
+	memcpy(out, data, size);
+	return out + size;
+}
+
+internal u8 *WriteString(u8 *out, const char *string, size_t maxLength)
+{
+	size_t length = strnlen(string, maxLength - 1);
+	out = WriteBytes(out, string, length);
+	*out++ = 0;
+	return out;
+}
+
+internal u8 *EncodeTick(u8 *out, RecorderTick &previous, const RecorderTick &tick)
+{
+	*out++ = RecorderEntry_Tick;
+	out = WriteVarint(out, ZigZag((i64)tick.tick - previous.tick));
+
+	u32 deltas[RECORDERFIELD_COUNT];
+	u32 mask = 0;
+	for (u32 i = 0; i < RECORDERFIELD_COUNT; i++)
+	{
+		deltas[i] = tick.fields[i] - RecorderPredictField(previous, tick, i);
+		if (deltas[i])
+		{
+			mask |= 1 << i;
+		}
+	}
+	out = WriteVarint(out, mask);
+	for (u32 i = 0; i < RECORDERFIELD_COUNT; i++)
+	{
+		if (mask & (1 << i))
+		{
+			out = WriteVarint(out, ZigZag((i32)deltas[i]));
+		}
+	}
+
+	for (u32 i = 0; i < 3; i++)
+	{
+		out = WriteVarint(out, tick.buttons[i] ^ previous.buttons[i]);
+	}
+
+	u32 subtickMoveCount = MIN(tick.subtickMoveCount, KZ_RECORDER_MAX_SUBTICK_MOVES);
+	*out++ = (u8)subtickMoveCount;
+	for (u32 i = 0; i < subtickMoveCount; i++)
+	{
+		out = WriteBytes(out, &tick.subtickMoves[i].when, sizeof(f32));
+		out = WriteVarint(out, (tick.subtickMoves[i].button << 1) | (tick.subtickMoves[i].pressed ? 1 : 0));
+	}
+
+	previous = tick;
+	return out;
+}
+
+internal void CloseFile(RecorderWriterState &state)
+{
+	if (state.file)
+	{
+		fclose(state.file);
+		state.file = nullptr;
+	}
+}
+
+internal u8 *OpenFile(u8 *out, RecorderWriterState &state, const RecorderBegin &begin)
+{
+	CloseFile(state);
+
+	char path[1024];
+	g_SMAPI->PathFormat(path, sizeof(path), "%s/%s/%llu_%lld.%s", g_SMAPI->GetBaseDir(), KZ_RECORDER_DIRECTORY, begin.xuid, begin.time,
+						KZ_RECORDER_EXTENSION);
+	state.file = fopen(path, "wb");
+	if (!state.file)
+	{
+		Warning("[KZ] Failed to open %s for writing!\n", path);
+		return out;
+	}
+
+	u32 header[2] = {KZ_RECORDER_MAGIC, KZ_RECORDER_VERSION};
+	out = WriteBytes(out, header, sizeof(header));
+	*out++ = RecorderEntry_Begin;
+	out = WriteBytes(out, &begin.xuid, sizeof(begin.xuid));
+	out = WriteBytes(out, &begin.time, sizeof(begin.time));
+	out = WriteBytes(out, &begin.tickInterval, sizeof(begin.tickInterval));
+	out = WriteBytes(out, &begin.tick, sizeof(begin.tick));
+	out = WriteString(out, begin.name, sizeof(begin.name));
+
+	state.previous = {};
+	state.previous.tick = begin.tick;
+	return out;
+}
+
+// Encodes everything the game thread has committed so far, returns whether anything was drained.
+internal bool DrainRing(RecorderRing *ring, RecorderWriterState &state)
+{
+	u32 tail = ring->tail.load(std::memory_order_relaxed);
+	u32 head = ring->head.load(std::memory_order_acquire);
+	if (tail == head)
+	{
+		return false;
+	}
+
+	u8 *out = writeBuffer;
+	for (; tail != head; tail++)
+	{
+		const RecorderEntry &entry = ring->entries[tail & (KZ_RECORDER_RING_SIZE - 1)];
+		switch (entry.type)
+		{
+			case RecorderEntry_Begin:
+			{
+				// Anything still buffered belongs to the previous file.
+				if (state.file && out != writeBuffer)
+				{
+					fwrite(writeBuffer, 1, out - writeBuffer, state.file);
+				}
+				out = OpenFile(writeBuffer, state, entry.begin);
+				break;
+			}
+			case RecorderEntry_ModeCvars:
+			{
+				*out++ = RecorderEntry_ModeCvars;
+				out = WriteString(out, entry.cvars.mode, sizeof(entry.cvars.mode));
+				out = WriteString(out, entry.cvars.style, sizeof(entry.cvars.style));
+				*out++ = (u8)KZ::mode::numCvar;
+				out = WriteBytes(out, entry.cvars.values, sizeof(entry.cvars.values));
+				break;
+			}
+			case RecorderEntry_Tick:
+			{
+				out = EncodeTick(out, state.previous, entry.tick);
+				break;
+			}
+			case RecorderEntry_End:
+			{
+				*out++ = RecorderEntry_End;
+				if (state.file)
+				{
+					fwrite(writeBuffer, 1, out - writeBuffer, state.file);
+				}
+				CloseFile(state);
+				out = writeBuffer;
+				break;
+			}
+		}
+
+		// Without an open file there is nowhere to put the data, skip until the next Begin entry.
+		if (!state.file)
+		{
+			out = writeBuffer;
+		}
+		else if (out - writeBuffer > KZ_RECORDER_WRITE_BUFFER_SIZE - KZ_RECORDER_MAX_RECORD_SIZE)
+		{
+			fwrite(writeBuffer, 1, out - writeBuffer, state.file);
+			out = writeBuffer;
+		}
+	}
+	ring->tail.store(tail, std::memory_order_release);
+
+	if (state.file && out != writeBuffer)
+	{
+		fwrite(writeBuffer, 1, out - writeBuffer, state.file);
+	}
+	return true;
+}
+
+internal void DrainAllRings()
+{
+	for (i32 i = 0; i <= MAXPLAYERS; i++)
+	{
+		RecorderRing *ring = rings[i].load(std::memory_order_acquire);
+		if (!ring || !DrainRing(ring, writerStates[i]))
+		{
+			continue;
+		}
+		u32 dropped = ring->dropped.load(std::memory_order_relaxed);
+		if (dropped != writerStates[i].droppedReported)
+		{
+			Warning("[KZ] Movement recorder dropped %u entries of player %i, the writer thread is falling behind!\n",
+					dropped - writerStates[i].droppedReported, i);
+			writerStates[i].droppedReported = dropped;
+		}
+		if (writerStates[i].file)
+		{
+			fflush(writerStates[i].file);
+		}
+	}
+}
+
+internal void WriterThread()
+{
+	std::unique_lock<std::mutex> lock(writerMutex);
+	while (!writerStopping)
+	{
+		writerWakeup.wait_for(lock, std::chrono::milliseconds(KZ_RECORDER_FLUSH_INTERVAL_MS));
+		lock.unlock();
+		DrainAllRings();
+		lock.lock();
+	}
+	lock.unlock();
+
+	// Whatever was committed before stopping still makes it to disk.
+	DrainAllRings();
+	for (i32 i = 0; i <= MAXPLAYERS; i++)
+	{
+		CloseFile(writerStates[i]);
+	}
+}
+
+void KZRecorderService::Init()
+{
+	scmd::RegisterCmd("kz_recorder", Command_KzRecorder, "Movement recorder: on, off.", true, true);
+
+	g_pFullFileSystem->CreateDirHierarchy(KZ_RECORDER_DIRECTORY, "GAME");
+	writerStopping = false;
+	writerThread = std::thread(WriterThread);
+
+	SetEnabled(KZOptionService::GetOptionInt("recordMovement", 0) != 0);
+}
+
+void KZRecorderService::Cleanup()
+{
+	SetEnabled(false);
+	if (writerThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(writerMutex);
+			writerStopping = true;
+		}
+		writerWakeup.notify_one();
+		writerThread.join();
+	}
+	for (i32 i = 0; i <= MAXPLAYERS; i++)
+	{
+		delete rings[i].exchange(nullptr);
+	}
+}
+
+bool KZRecorderService::IsEnabled()
+{
+	return enabled;
+}
+
+void KZRecorderService::SetEnabled(bool enable)
+{
+	if (enabled == enable)
+	{
+		return;
+	}
+	enabled = enable;
+	if (!enable)
+	{
+		for (i32 i = 0; i <= MAXPLAYERS; i++)
+		{
+			g_pKZPlayerManager->ToPlayer(i)->recorderService->EndSession();
+		}
+	}
+}
+
+void KZRecorderService::Reset()
+{
+	this->EndSession();
+}
+
+RecorderEntry *KZRecorderService::BeginEntry(RecorderEntryType type)
+{
+	RecorderRing *ring = rings[this->player->index].load(std::memory_order_relaxed);
+	if (!ring)
+	{
+		ring = new RecorderRing();
+		rings[this->player->index].store(ring, std::memory_order_release);
+	}
+
+	u32 head = ring->head.load(std::memory_order_relaxed);
+	if (head - ring->tail.load(std::memory_order_acquire) >= KZ_RECORDER_RING_SIZE)
+	{
+		ring->dropped.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	RecorderEntry *entry = &ring->entries[head & (KZ_RECORDER_RING_SIZE - 1)];
+	entry->type = type;
+	return entry;
+}
+
+void KZRecorderService::CommitEntry()
+{
+	RecorderRing *ring = rings[this->player->index].load(std::memory_order_relaxed);
+	ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void KZRecorderService::BeginSession()
+{
+	CCSPlayerController *controller = this->player->GetController();
+	// Bots have no SteamID to name the file after.
+	if (!controller || !controller->m_steamID())
+	{
+		return;
+	}
+	RecorderEntry *entry = this->BeginEntry(RecorderEntry_Begin);
+	if (!entry)
+	{
+		return;
+	}
+	entry->begin.xuid = controller->m_steamID();
+	entry->begin.time = (i64)std::time(nullptr);
+	entry->begin.tickInterval = ENGINE_FIXED_TICK_INTERVAL;
+	entry->begin.tick = g_pKZUtils->GetServerGlobals()->tickcount;
+	V_strncpy(entry->begin.name, controller->m_iszPlayerName(), sizeof(entry->begin.name));
+	this->CommitEntry();
+
+	this->sessionActive = true;
+	this->RecordModeCvars(true);
+}
+
+void KZRecorderService::EndSession()
+{
+	if (!this->sessionActive)
+	{
+		return;
+	}
+	this->sessionActive = false;
+	if (this->BeginEntry(RecorderEntry_End))
+	{
+		this->CommitEntry();
+	}
+}
+
+void KZRecorderService::RecordModeCvars(bool force)
+{
+	RecorderModeCvars current;
+	for (u32 i = 0; i < KZ::mode::numCvar; i++)
+	{
+		// Float and integer cvars share the same 32 bits, see KZ::mode::ApplyModeSettings.
+		current.values[i] = (u32)reinterpret_cast<CVValue_t *>(&(KZ::mode::modeCvars[i]->values))->m_i32Value;
+	}
+	const char *modeName = this->player->modeService->GetModeShortName();
+	const char *styleName = this->player->styleService->GetStyleShortName();
+
+	// clang-format off
+	if (!force
+		&& !memcmp(current.values, this->lastCvars.values, sizeof(current.values))
+		&& !V_strncmp(modeName, this->lastCvars.mode, sizeof(this->lastCvars.mode) - 1)
+		&& !V_strncmp(styleName, this->lastCvars.style, sizeof(this->lastCvars.style) - 1))
+	// clang-format on
+	{
+		return;
+	}
+
+	RecorderEntry *entry = this->BeginEntry(RecorderEntry_ModeCvars);
+	if (!entry)
+	{
+		return;
+	}
+	V_strncpy(current.mode, modeName, sizeof(current.mode));
+	V_strncpy(current.style, styleName, sizeof(current.style));
+	entry->cvars = current;
+	this->lastCvars = current;
+	this->CommitEntry();
+}
+
+void KZRecorderService::OnProcessMovementPost()
+{
+	if (!enabled)
+	{
+		return;
+	}
+	if (!this->sessionActive)
+	{
+		this->BeginSession();
+		if (!this->sessionActive)
+		{
+			return;
+		}
+	}
+	this->RecordModeCvars(false);
+
+	RecorderEntry *entry = this->BeginEntry(RecorderEntry_Tick);
+	if (!entry)
+	{
+		return;
+	}
+	RecorderTick &tick = entry->tick;
+	const CMoveData &pre = this->player->moveDataPre;
+	const CMoveData &post = this->player->moveDataPost;
+
+	tick.tick = g_pKZUtils->GetServerGlobals()->tickcount;
+	StoreVector(&tick.fields[RecorderField_OriginX], pre.m_vecAbsOrigin);
+	StoreVector(&tick.fields[RecorderField_VelocityX], pre.m_vecVelocity);
+	StoreAngles(&tick.fields[RecorderField_ViewAngleX], pre.m_vecViewAngles);
+	tick.fields[RecorderField_ForwardMove] = FloatBits(pre.m_flForwardMove);
+	tick.fields[RecorderField_SideMove] = FloatBits(pre.m_flSideMove);
+	tick.fields[RecorderField_UpMove] = FloatBits(pre.m_flUpMove);
+	tick.fields[RecorderField_MaxSpeed] = FloatBits(pre.m_flMaxSpeed);
+	StoreVector(&tick.fields[RecorderField_PostOriginX], post.m_vecAbsOrigin);
+	StoreVector(&tick.fields[RecorderField_PostVelocityX], post.m_vecVelocity);
+
+	this->player->GetMoveServices()->m_nButtons()->GetButtons(tick.buttons);
+
+	tick.subtickMoveCount = MIN((u32)pre.m_SubtickMoves.Count(), KZ_RECORDER_MAX_SUBTICK_MOVES);
+	for (u32 i = 0; i < tick.subtickMoveCount; i++)
+	{
+		tick.subtickMoves[i].when = pre.m_SubtickMoves[i].when;
+		tick.subtickMoves[i].button = pre.m_SubtickMoves[i].button;
+		tick.subtickMoves[i].pressed = pre.m_SubtickMoves[i].pressed;
+	}
+	this->CommitEntry();
+}
+
+void KZRecorderService::OnClientDisconnect()
+{
+	this->EndSession();
+}
+
+internal SCMD_CALLBACK(Command_KzRecorder)
+{
+	const char *arg = args->Arg(1);
+	CBaseEntity2 *entity = controller;
+	if (!V_stricmp(arg, "on") || !V_stricmp(arg, "off"))
+	{
+		KZRecorderService::SetEnabled(!V_stricmp(arg, "on"));
+	}
+	utils::PrintConsole(entity, "Movement recorder is %s, files are written to %s.", KZRecorderService::IsEnabled() ? "enabled" : "disabled",
+						KZ_RECORDER_DIRECTORY);
+	return MRES_SUPERCEDE;
+}
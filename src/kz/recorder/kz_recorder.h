@@ -0,0 +1,175 @@
+#pragma once
+#include "../kz.h"
+#include "kz/mode/kz_mode.h"
+#include <atomic>
+
+// Entries buffered per player between two flushes of the writer thread, must be a power of two.
+// 512 entries hold 8 seconds of movement at 64 tick.
+#define KZ_RECORDER_RING_SIZE         512
+#define KZ_RECORDER_MAX_SUBTICK_MOVES 12
+#define KZ_RECORDER_NAME_LEN          32
+#define KZ_RECORDER_FLUSH_INTERVAL_MS 250
+
+#define KZ_RECORDER_DIRECTORY "addons/cs2kz/recordings"
+#define KZ_RECORDER_EXTENSION "kzmr"
+#define KZ_RECORDER_MAGIC     0x524D5A4B // "KZMR"
+#define KZ_RECORDER_VERSION   1
+
+/*
+ * Movement recorder, meant for debugging movement reports after the fact.
+ *
+ * Every tick, the state around ProcessMovement is copied into a per-player single producer/single consumer ring.
+ * A background thread drains the rings and writes one file per player session:
+ *
+ *   u32 magic, u32 version, then a stream of records, each starting with a RecorderEntryType byte.
+ *
+ *   Begin:     u64 xuid, i64 unix time, f32 tick interval, i32 tick, then the player name as a null terminated string.
+ *   ModeCvars: mode and style short names as null terminated strings, u8 count, then count raw u32 cvar values
+ *              in the order of KZ::mode::modeCvarNames.
+ *   Tick:      varint zigzag tick delta, varint field mask, the fields present in the mask as varint zigzag deltas of
+ *              their 32 bit patterns, varint xor of each button state against the previous tick, u8 subtick move count,
+ *              then per subtick move the raw f32 when and varint (button << 1 | pressed).
+ *   End:       no payload.
+ *
+ * Deltas are taken against a prediction made from the previous tick (see RecorderField),
+ * fields that match their prediction are left out of the mask. A dropped tick shows up as a tick delta larger than 1.
+ */
+
+enum RecorderEntryType : u8
+{
+	RecorderEntry_Begin,
+	RecorderEntry_ModeCvars,
+	RecorderEntry_Tick,
+	RecorderEntry_End,
+};
+
+struct RecorderSubtickMove
+{
+	f32 when;
+	u32 pressed;
+	u64 button;
+};
+
+// 32 bit fields of a tick, stored as raw bit patterns.
+enum RecorderField : u8
+{
+	// moveDataPre, origin and velocity are predicted from the post values of the previous tick.
+	RecorderField_OriginX,
+	RecorderField_OriginY,
+	RecorderField_OriginZ,
+	RecorderField_VelocityX,
+	RecorderField_VelocityY,
+	RecorderField_VelocityZ,
+	// Predicted from the previous tick.
+	RecorderField_ViewAngleX,
+	RecorderField_ViewAngleY,
+	RecorderField_ViewAngleZ,
+	RecorderField_ForwardMove,
+	RecorderField_SideMove,
+	RecorderField_UpMove,
+	RecorderField_MaxSpeed,
+	// moveDataPost, predicted by adding the change of the previous tick to the pre values of this tick.
+	RecorderField_PostOriginX,
+	RecorderField_PostOriginY,
+	RecorderField_PostOriginZ,
+	RecorderField_PostVelocityX,
+	RecorderField_PostVelocityY,
+	RecorderField_PostVelocityZ,
+	RECORDERFIELD_COUNT
+};
+
+struct RecorderTick
+{
+	i32 tick;
+	u32 fields[RECORDERFIELD_COUNT];
+	u64 buttons[3];
+	u32 subtickMoveCount;
+	RecorderSubtickMove subtickMoves[KZ_RECORDER_MAX_SUBTICK_MOVES];
+};
+
+// Value the encoder compares a field against, decoders have to use this to undo the delta.
+inline u32 RecorderPredictField(const RecorderTick &previous, const RecorderTick &current, u32 field)
+{
+	auto asFloat = [](u32 bits)
+	{
+		f32 value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	};
+	if (field <= RecorderField_VelocityZ)
+	{
+		return previous.fields[field + RecorderField_PostOriginX];
+	}
+	if (field >= RecorderField_PostOriginX)
+	{
+		u32 pre = field - RecorderField_PostOriginX;
+		f32 predicted = asFloat(current.fields[pre]) + (asFloat(previous.fields[field]) - asFloat(previous.fields[pre]));
+		u32 bits;
+		memcpy(&bits, &predicted, sizeof(bits));
+		return bits;
+	}
+	return previous.fields[field];
+}
+
+struct RecorderBegin
+{
+	u64 xuid;
+	i64 time;
+	f32 tickInterval;
+	i32 tick;
+	char name[KZ_RECORDER_NAME_LEN * 2];
+};
+
+struct RecorderModeCvars
+{
+	char mode[KZ_RECORDER_NAME_LEN];
+	char style[KZ_RECORDER_NAME_LEN];
+	u32 values[KZ::mode::numCvar];
+};
+
+struct RecorderEntry
+{
+	RecorderEntryType type;
+
+	union
+	{
+		RecorderTick tick;
+		RecorderBegin begin;
+		RecorderModeCvars cvars;
+	};
+};
+
+struct RecorderRing
+{
+	RecorderEntry entries[KZ_RECORDER_RING_SIZE];
+	// Written by the game thread.
+	std::atomic<u32> head;
+	// Written by the writer thread.
+	std::atomic<u32> tail;
+	std::atomic<u32> dropped;
+};
+
+class KZRecorderService : public KZBaseService
+{
+	using KZBaseService::KZBaseService;
+
+private:
+	bool sessionActive {};
+	RecorderModeCvars lastCvars {};
+
+	RecorderEntry *BeginEntry(RecorderEntryType type);
+	void CommitEntry();
+	void BeginSession();
+	void RecordModeCvars(bool force);
+
+public:
+	static_global void Init();
+	static_global void Cleanup();
+	static_global bool IsEnabled();
+	static_global void SetEnabled(bool enable);
+
+	virtual void Reset() override;
+	void OnProcessMovementPost();
+	void OnClientDisconnect();
+	void EndSession();
+};
@@ -1,7 +1,7 @@
 #pragma once
 #include "../kz.h"
 
-#define KZ_STYLE_MANAGER_INTERFACE "KZStyleManagerInterface"
+#define KZ_STYLE_MANAGER_INTERFACE "KZStyleManagerInterface002"
 
 // TODO styles: normal, backwards, sw, hsw, w only, lowgrav, autobhop, 250 speed, high gravity, notrigger, alivestrafe
 class KZStyleService : public KZBaseService
@@ -159,10 +159,12 @@ class KZStyleManager
 		const char *shortName;
 		const char *longName;
 		StyleServiceFactory factory;
+		u64 hooks;
 	};
 
 public:
-	virtual bool RegisterStyle(PluginId id, const char *shortName, const char *longName, StyleServiceFactory factory);
+	// hooks: Hooks implemented by the style service, usually KZ::GetServiceHooks<Service, KZStyleService>().
+	virtual bool RegisterStyle(PluginId id, const char *shortName, const char *longName, StyleServiceFactory factory, u64 hooks = MV_HOOKS_ALL);
 	virtual void UnregisterStyle(const char *styleName);
 	bool SwitchToStyle(KZPlayer *player, const char *styleName, bool silent = false);
 	void Cleanup();
@@ -11,6 +11,7 @@ CGameConfig *g_pGameConfig = NULL;
 KZUtils *g_pKZUtils = NULL;
 KZStyleManager *g_pStyleManager = NULL;
 StyleServiceFactory g_StyleFactory = [](KZPlayer *player) -> KZStyleService * { return new KZAutoBhopStyleService(player); };
+constexpr u64 g_StyleHooks = KZ::GetServiceHooks<KZAutoBhopStyleService, KZStyleService>();
 PLUGIN_EXPOSE(KZAutoBhopStylePlugin, g_KZAutoBhopStylePlugin);
 
 ConVar *sv_autobunnyhopping;
@@ -38,14 +39,23 @@ bool KZAutoBhopStylePlugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t
 		V_snprintf(error, maxlen, "Failed to initialize interfaces");
 		return false;
 	}
+	if (!schema::ResolveFields())
+	{
+		Warning("Some schema fields could not be resolved.\n");
+	}
 
 	if (nullptr == (g_pGameConfig = g_pKZUtils->GetGameConfig()))
 	{
 		V_snprintf(error, maxlen, "Failed to get game config");
 		return false;
 	}
+	// Keys declared in this binary are separate from the core plugin's ones.
+	if (!g_pGameConfig->ResolveKeys(error, maxlen))
+	{
+		return false;
+	}
 
-	if (!g_pStyleManager->RegisterStyle(g_PLID, STYLE_NAME_SHORT, STYLE_NAME, g_StyleFactory))
+	if (!g_pStyleManager->RegisterStyle(g_PLID, STYLE_NAME_SHORT, STYLE_NAME, g_StyleFactory, g_StyleHooks))
 	{
 		V_snprintf(error, maxlen, "Failed to register style");
 		return false;
@@ -74,7 +84,7 @@ bool KZAutoBhopStylePlugin::Pause(char *error, size_t maxlen)
 
 bool KZAutoBhopStylePlugin::Unpause(char *error, size_t maxlen)
 {
-	if (!g_pStyleManager->RegisterStyle(g_PLID, STYLE_NAME_SHORT, STYLE_NAME, g_StyleFactory))
+	if (!g_pStyleManager->RegisterStyle(g_PLID, STYLE_NAME_SHORT, STYLE_NAME, g_StyleFactory, g_StyleHooks))
 	{
 		return false;
 	}
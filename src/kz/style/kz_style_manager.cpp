@@ -10,6 +10,7 @@
 
 #include "../timer/kz_timer.h"
 #include "utils/plat.h"
+#include "movement/mv_perf.h"
 
 internal SCMD_CALLBACK(Command_KzStyle);
 
@@ -24,7 +25,7 @@ void KZ::style::InitStyleManager()
 		return;
 	}
 	StyleServiceFactory vnlFactory = [](KZPlayer *player) -> KZStyleService * { return new KZNormalStyleService(player); };
-	styleManager.RegisterStyle(0, "NRM", "Normal", vnlFactory);
+	styleManager.RegisterStyle(0, "NRM", "Normal", vnlFactory, KZ::GetServiceHooks<KZNormalStyleService, KZStyleService>());
 	initialized = true;
 }
 
@@ -56,7 +57,7 @@ void KZ::style::LoadStylePlugins()
 	}
 }
 
-bool KZStyleManager::RegisterStyle(PluginId id, const char *shortName, const char *longName, StyleServiceFactory factory)
+bool KZStyleManager::RegisterStyle(PluginId id, const char *shortName, const char *longName, StyleServiceFactory factory, u64 hooks)
 {
 	if (!shortName || V_strlen(shortName) == 0 || !shortName || V_strlen(longName) == 0)
 	{
@@ -74,7 +75,7 @@ bool KZStyleManager::RegisterStyle(PluginId id, const char *shortName, const cha
 		}
 	}
 
-	this->styleInfos.AddToTail({id, shortName, longName, factory});
+	this->styleInfos.AddToTail({id, shortName, longName, factory, hooks});
 	return true;
 }
 
@@ -138,12 +139,14 @@ bool KZStyleManager::SwitchToStyle(KZPlayer *player, const char *styleName, bool
 	}
 
 	StyleServiceFactory factory = nullptr;
+	u64 hooks = MV_HOOKS_ALL;
 
 	FOR_EACH_VEC(this->styleInfos, i)
 	{
 		if (V_stricmp(this->styleInfos[i].shortName, styleName) == 0 || V_stricmp(this->styleInfos[i].longName, styleName) == 0)
 		{
 			factory = this->styleInfos[i].factory;
+			hooks = this->styleInfos[i].hooks;
 			break;
 		}
 	}
@@ -158,8 +161,11 @@ bool KZStyleManager::SwitchToStyle(KZPlayer *player, const char *styleName, bool
 	player->styleService->Cleanup();
 	delete player->styleService;
 	player->styleService = factory(player);
+	player->styleServiceHooks = hooks;
+	player->UpdateActiveHooks();
 	player->timerService->TimerStop();
 	player->styleService->Init();
+	movement::perf::SetPlayerContext(player->index, player->modeService->GetModeShortName(), player->styleService->GetStyleShortName());
 
 	if (!silent)
 	{
@@ -192,6 +198,8 @@ void KZ::style::InitStyleService(KZPlayer *player)
 {
 	delete player->styleService;
 	player->styleService = new KZNormalStyleService(player);
+	player->styleServiceHooks = KZ::GetServiceHooks<KZNormalStyleService, KZStyleService>();
+	player->UpdateActiveHooks();
 }
 
 internal SCMD_CALLBACK(Command_KzStyle)
@@ -4,6 +4,7 @@
 #include "../noclip/kz_noclip.h"
 #include "utils/utils.h"
 #include "utils/simplecmds.h"
+#include "utils/stringbuilder.h"
 
 internal CUtlVector<KZTimerServiceEventListener *> eventListeners;
 
@@ -234,6 +235,12 @@ void KZTimerService::PlayTimerStopSound()
 }
 
 void KZTimerService::FormatTime(f64 time, char *output, u32 length, bool precise)
+{
+	StringBuilder builder(output, length);
+	KZTimerService::FormatTime(time, builder, precise);
+}
+
+void KZTimerService::FormatTime(f64 time, StringBuilder &builder, bool precise)
 {
 	int roundedTime = RoundFloatToInt(time * 1000); // Time rounded to number of ms
 
@@ -247,57 +254,43 @@ void KZTimerService::FormatTime(f64 time, char *output, u32 length, bool precise
 
 	if (hours == 0)
 	{
-		if (precise)
-		{
-			snprintf(output, length, "%02i:%02i.%03i", minutes, seconds, milliseconds);
-		}
-		else
-		{
-			snprintf(output, length, "%i:%02i", minutes, seconds);
-		}
+		builder.AppendInt(minutes, precise ? 2 : 0);
 	}
 	else
 	{
-		if (precise)
-		{
-			snprintf(output, length, "%i:%02i:%02i.%03i", hours, minutes, seconds, milliseconds);
-		}
-		else
-		{
-			snprintf(output, length, "%i:%02i:%02i", hours, minutes, seconds);
-		}
+		builder.AppendInt(hours).Append(':').AppendInt(minutes, 2);
+	}
+	builder.Append(':').AppendInt(seconds, 2);
+	if (precise)
+	{
+		builder.Append('.').AppendInt(milliseconds, 3);
 	}
 }
 
 void KZTimerService::PrintEndTimeString()
 {
-	CCSPlayerController *controller = this->player->GetController();
 	char time[32];
 	KZTimerService::FormatTime(this->GetTime(), time, sizeof(time));
-	char tpCountStr[128] = "";
+
+	char tpCountStr[128];
+	StringBuilder tpCountBuilder(tpCountStr, sizeof(tpCountStr));
 	u32 tpCount = this->player->checkpointService->GetTeleportCount();
+	tpCountBuilder.Append("{purple}").Append(this->player->modeService->GetModeShortName());
+	tpCountBuilder.Append(" {grey}|{purple} ").Append(this->player->styleService->GetStyleShortName());
 	if (!tpCount)
 	{
-		// clang-format off
-		snprintf(tpCountStr, sizeof(tpCountStr), "{purple}%s {grey}|{purple} %s{grey}",
-				 this->player->modeService->GetModeShortName(),
-				 this->player->styleService->GetStyleShortName());
-		// clang-format on
+		tpCountBuilder.Append("{grey}");
 	}
 	else
 	{
-		// clang-format off
-		snprintf(tpCountStr, sizeof(tpCountStr), "{purple}%s {grey}|{purple} %s {grey}|{purple} %i {grey}TPs",
-				 this->player->modeService->GetModeShortName(),
-				 this->player->styleService->GetStyleShortName(),
-				 tpCount);
-		// clang-format on
+		tpCountBuilder.Append(" {grey}|{purple} ").AppendInt(tpCount).Append(" {grey}TPs");
 	}
 
-	char courseStr[KZ_MAX_COURSE_NAME_LENGTH + 16] = "";
-	if (strlen(this->currentCourse) > 0)
+	char courseStr[KZ_MAX_COURSE_NAME_LENGTH + 16];
+	StringBuilder courseBuilder(courseStr, sizeof(courseStr));
+	if (this->currentCourse[0])
 	{
-		snprintf(courseStr, sizeof(courseStr), " course {default}%s{grey} ", this->currentCourse);
+		courseBuilder.Append(" course {default}").Append(this->currentCourse).Append("{grey} ");
 	}
 
 	// clang-format off
@@ -2,6 +2,8 @@
 #include "../kz.h"
 #include "../checkpoint/kz_checkpoint.h"
 
+class StringBuilder;
+
 #define KZ_MAX_COURSE_NAME_LENGTH 128
 #define KZ_MAX_MODE_NAME_LENGTH   128
 
@@ -95,6 +97,7 @@ public:
 	}
 
 	static_global void FormatTime(f64 time, char *output, u32 length, bool precise = true);
+	static_global void FormatTime(f64 time, StringBuilder &builder, bool precise = true);
 
 	void SetTime(f64 time)
 	{
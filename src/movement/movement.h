@@ -5,6 +5,7 @@ class CCSPlayer_MovementServices;
 
 #include "sdk/datatypes.h"
 #include "sdk/services.h"
+#include "utils/entityhandleset.h"
 // TODO: better error sound
 #define MV_SND_ERROR       "Buttons.snd8"
 #define MV_SND_TIMER_START "Buttons.snd9"
@@ -13,6 +14,48 @@ class CCSPlayer_MovementServices;
 class CCSPlayerController;
 class MovementPlayer;
 
+// One entry per movement detour, in the same order as movement::InitDetours.
+enum MovementHook : u8
+{
+	MovementHook_PhysicsSimulate,
+	MovementHook_GetMaxSpeed,
+	MovementHook_ProcessUsercmds,
+	MovementHook_ProcessMovement,
+	MovementHook_PlayerMoveNew,
+	MovementHook_CheckParameters,
+	MovementHook_CanMove,
+	MovementHook_FullWalkMove,
+	MovementHook_MoveInit,
+	MovementHook_CheckWater,
+	MovementHook_WaterMove,
+	MovementHook_CheckVelocity,
+	MovementHook_Duck,
+	MovementHook_CanUnduck,
+	MovementHook_LadderMove,
+	MovementHook_CheckJumpButton,
+	MovementHook_OnJump,
+	MovementHook_AirMove,
+	MovementHook_AirAccelerate,
+	MovementHook_Friction,
+	MovementHook_WalkMove,
+	MovementHook_TryPlayerMove,
+	MovementHook_CategorizePosition,
+	MovementHook_FinishGravity,
+	MovementHook_CheckFalling,
+	MovementHook_PostPlayerMove,
+	MovementHook_PostThink,
+	MOVEMENTHOOK_COUNT
+};
+
+// Bits of a hook mask, every detour has one bit for its pre hook and one for its post hook.
+#define MV_HOOK_PRE(hook)  (1ull << ((hook) * 2))
+#define MV_HOOK_POST(hook) (1ull << ((hook) * 2 + 1))
+#define MV_HOOK_BOTH(hook) (MV_HOOK_PRE(hook) | MV_HOOK_POST(hook))
+#define MV_HOOKS_ALL       (~0ull)
+
+// Pawns are networked, so their entity index always fits in here.
+#define MV_MAX_NETWORKED_ENTITIES 16384
+
 namespace movement
 {
 	void InitDetours();
@@ -61,6 +104,21 @@ public:
 
 	virtual CCSPlayer_MovementServices *GetMoveServices();
 
+	// The entity getters above return these pointers without touching the entity system until the cache is invalidated.
+	// Refreshed at the start of PhysicsSimulate/ProcessMovement, invalidated on spawn, death, team change and disconnect.
+	void RefreshEntityCache();
+	void InvalidateEntityCache();
+
+	bool IsCachedPawn(CBasePlayerPawn *pawn)
+	{
+		return this->entityCache.valid && this->entityCache.pawn == pawn;
+	}
+
+	bool IsCachedMoveServices(CCSPlayer_MovementServices *ms)
+	{
+		return this->entityCache.valid && this->entityCache.moveServices == ms;
+	}
+
 	// This doesn't work during movement processing!
 	virtual void Teleport(const Vector *origin, const QAngle *angles, const Vector *velocity);
 
@@ -216,6 +274,21 @@ public:
 		return true;
 	}
 
+	bool HasPreHook(MovementHook hook)
+	{
+		return this->activeHooks & MV_HOOK_PRE(hook);
+	}
+
+	bool HasPostHook(MovementHook hook)
+	{
+		return this->activeHooks & MV_HOOK_POST(hook);
+	}
+
+	bool HasHooks(MovementHook hook)
+	{
+		return this->activeHooks & MV_HOOK_BOTH(hook);
+	}
+
 	bool IsAlive()
 	{
 		return this->GetPawn() ? this->GetPawn()->IsAlive() : false;
@@ -247,6 +320,9 @@ public:
 	// General
 	const i32 index;
 
+	// Detours skip the On* calls whose bit is not set, see MV_HOOK_PRE/MV_HOOK_POST.
+	u64 activeHooks = MV_HOOKS_ALL;
+
 	bool processingMovement {};
 	CMoveData *currentMoveData {};
 	CMoveData moveDataPre;
@@ -277,11 +353,21 @@ public:
 	bool enableWaterFix {};
 	bool ignoreNextCategorizePosition {};
 
-	CUtlVector<CEntityHandle> pendingStartTouchTriggers;
-	CUtlVector<CEntityHandle> pendingEndTouchTriggers;
-	CUtlVector<CEntityHandle> touchedTriggers;
+	EntityHandleSet pendingStartTouchTriggers;
+	EntityHandleSet pendingEndTouchTriggers;
+	EntityHandleSet touchedTriggers;
 
 private:
+	struct
+	{
+		bool valid;
+		CCSPlayerController *controller;
+		CCSPlayerPawn *pawn;
+		CCSPlayer_MovementServices *moveServices;
+	} entityCache {};
+
+	CCSPlayerController *ResolveController();
+
 	bool collidingWithWorld {};
 	// Movetype changes that occur outside of movement processing
 	MoveType_t lastKnownMoveType;
@@ -315,8 +401,13 @@ public:
 	MovementPlayer *ToPlayer(CEntityIndex entIndex);
 	MovementPlayer *ToPlayer(CPlayerUserId userID);
 
+	void OnEntityDeleted(CEntityInstance *entity);
+
 public:
 	MovementPlayer *players[MAXPLAYERS + 1];
+
+	// Index of the player whose entity cache holds the pawn with this entity index, 0 if none.
+	u8 pawnOwners[MV_MAX_NETWORKED_ENTITIES] {};
 };
 
 extern CMovementPlayerManager *g_pPlayerManager;
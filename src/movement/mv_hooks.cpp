@@ -1,4 +1,5 @@
 #include "movement.h"
+#include "mv_perf.h"
 #include "utils/detours.h"
 #include "utils/gameconfig.h"
 #include "tier0/memdbgon.h"
@@ -43,18 +44,30 @@ void FASTCALL movement::Detour_PhysicsSimulate(CCSPlayerController *controller)
 	{
 		return;
 	}
-	player->OnPhysicsSimulate();
+	player->RefreshEntityCache();
+	perf::Scope sample(player->index, MovementHook_PhysicsSimulate);
+	if (player->HasPreHook(MovementHook_PhysicsSimulate))
+	{
+		player->OnPhysicsSimulate();
+	}
+	sample.Next();
 	PhysicsSimulate(controller);
-	player->OnPhysicsSimulatePost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_PhysicsSimulate))
+	{
+		player->OnPhysicsSimulatePost();
+	}
 }
 
 f32 FASTCALL movement::Detour_GetMaxSpeed(CCSPlayerPawn *pawn)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(pawn);
+	perf::Scope sample(player->index, MovementHook_GetMaxSpeed, perf::PerfPhase_Original);
 	f32 maxSpeed = GetMaxSpeed(pawn);
+	sample.Next();
 	f32 newMaxSpeed = maxSpeed;
 
-	if (player->GetPlayerMaxSpeed(newMaxSpeed) != MRES_IGNORED)
+	if (player->HasPostHook(MovementHook_GetMaxSpeed) && player->GetPlayerMaxSpeed(newMaxSpeed) != MRES_IGNORED)
 	{
 		return newMaxSpeed;
 	}
@@ -64,72 +77,148 @@ f32 FASTCALL movement::Detour_GetMaxSpeed(CCSPlayerPawn *pawn)
 i32 FASTCALL movement::Detour_ProcessUsercmds(CBasePlayerPawn *pawn, void *cmds, int numcmds, bool paused, float margin)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(pawn);
-	player->OnProcessUsercmds(cmds, numcmds);
+	perf::Scope sample(player->index, MovementHook_ProcessUsercmds);
+	if (player->HasPreHook(MovementHook_ProcessUsercmds))
+	{
+		player->OnProcessUsercmds(cmds, numcmds);
+	}
+	sample.Next();
 	auto retValue = ProcessUsercmds(pawn, cmds, numcmds, paused, margin);
-	player->OnProcessUsercmdsPost(cmds, numcmds);
+	sample.Next();
+	if (player->HasPostHook(MovementHook_ProcessUsercmds))
+	{
+		player->OnProcessUsercmdsPost(cmds, numcmds);
+	}
 	return retValue;
 }
 
 void FASTCALL movement::Detour_ProcessMovement(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
+	if (!player->IsCachedMoveServices(ms))
+	{
+		player->RefreshEntityCache();
+	}
+	perf::Scope sample(player->index, MovementHook_ProcessMovement);
 	player->currentMoveData = mv;
 	player->moveDataPre = CMoveData(*mv);
-	player->OnProcessMovement();
+	if (player->HasPreHook(MovementHook_ProcessMovement))
+	{
+		player->OnProcessMovement();
+	}
+	sample.Next();
 	ProcessMovement(ms, mv);
+	sample.Next();
 	player->moveDataPost = CMoveData(*mv);
-	player->OnProcessMovementPost();
+	if (player->HasPostHook(MovementHook_ProcessMovement))
+	{
+		player->OnProcessMovementPost();
+	}
 }
 
 bool FASTCALL movement::Detour_PlayerMoveNew(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnPlayerMove();
+	perf::Scope sample(player->index, MovementHook_PlayerMoveNew);
+	if (player->HasPreHook(MovementHook_PlayerMoveNew))
+	{
+		player->OnPlayerMove();
+	}
+	sample.Next();
 	auto retValue = PlayerMoveNew(ms, mv);
-	player->OnPlayerMovePost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_PlayerMoveNew))
+	{
+		player->OnPlayerMovePost();
+	}
 	return retValue;
 }
 
 void FASTCALL movement::Detour_CheckParameters(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnCheckParameters();
+	perf::Scope sample(player->index, MovementHook_CheckParameters);
+	if (player->HasPreHook(MovementHook_CheckParameters))
+	{
+		player->OnCheckParameters();
+	}
+	sample.Next();
 	CheckParameters(ms, mv);
-	player->OnCheckParametersPost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_CheckParameters))
+	{
+		player->OnCheckParametersPost();
+	}
 }
 
 bool FASTCALL movement::Detour_CanMove(CCSPlayerPawnBase *pawn)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(pawn);
-	player->OnCanMove();
+	perf::Scope sample(player->index, MovementHook_CanMove);
+	if (player->HasPreHook(MovementHook_CanMove))
+	{
+		player->OnCanMove();
+	}
+	sample.Next();
 	auto retValue = CanMove(pawn);
-	player->OnCanMovePost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_CanMove))
+	{
+		player->OnCanMovePost();
+	}
 	return retValue;
 }
 
 void FASTCALL movement::Detour_FullWalkMove(CCSPlayer_MovementServices *ms, CMoveData *mv, bool ground)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnFullWalkMove(ground);
+	perf::Scope sample(player->index, MovementHook_FullWalkMove);
+	if (player->HasPreHook(MovementHook_FullWalkMove))
+	{
+		player->OnFullWalkMove(ground);
+	}
+	sample.Next();
 	FullWalkMove(ms, mv, ground);
-	player->OnFullWalkMovePost(ground);
+	sample.Next();
+	if (player->HasPostHook(MovementHook_FullWalkMove))
+	{
+		player->OnFullWalkMovePost(ground);
+	}
 }
 
 bool FASTCALL movement::Detour_MoveInit(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnMoveInit();
+	perf::Scope sample(player->index, MovementHook_MoveInit);
+	if (player->HasPreHook(MovementHook_MoveInit))
+	{
+		player->OnMoveInit();
+	}
+	sample.Next();
 	auto retValue = MoveInit(ms, mv);
-	player->OnMoveInitPost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_MoveInit))
+	{
+		player->OnMoveInitPost();
+	}
 	return retValue;
 }
 
 bool FASTCALL movement::Detour_CheckWater(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnCheckWater();
+	perf::Scope sample(player->index, MovementHook_CheckWater);
+	if (player->HasPreHook(MovementHook_CheckWater))
+	{
+		player->OnCheckWater();
+	}
+	sample.Next();
 	auto retValue = CheckWater(ms, mv);
-	player->OnCheckWaterPost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_CheckWater))
+	{
+		player->OnCheckWaterPost();
+	}
 #ifdef WATER_FIX
 	if (player->enableWaterFix)
 	{
@@ -142,51 +231,93 @@ bool FASTCALL movement::Detour_CheckWater(CCSPlayer_MovementServices *ms, CMoveD
 void FASTCALL movement::Detour_WaterMove(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnWaterMove();
+	perf::Scope sample(player->index, MovementHook_WaterMove);
+	if (player->HasPreHook(MovementHook_WaterMove))
+	{
+		player->OnWaterMove();
+	}
 #ifdef WATER_FIX
 	if (player->enableWaterFix)
 	{
 		player->ignoreNextCategorizePosition = true;
 	}
 #endif
+	sample.Next();
 	WaterMove(ms, mv);
-	player->OnWaterMovePost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_WaterMove))
+	{
+		player->OnWaterMovePost();
+	}
 }
 
 void FASTCALL movement::Detour_CheckVelocity(CCSPlayer_MovementServices *ms, CMoveData *mv, const char *a3)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnCheckVelocity(a3);
+	perf::Scope sample(player->index, MovementHook_CheckVelocity);
+	if (player->HasPreHook(MovementHook_CheckVelocity))
+	{
+		player->OnCheckVelocity(a3);
+	}
+	sample.Next();
 	CheckVelocity(ms, mv, a3);
-	player->OnCheckVelocityPost(a3);
+	sample.Next();
+	if (player->HasPostHook(MovementHook_CheckVelocity))
+	{
+		player->OnCheckVelocityPost(a3);
+	}
 }
 
 void FASTCALL movement::Detour_Duck(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnDuck();
+	perf::Scope sample(player->index, MovementHook_Duck);
+	if (player->HasPreHook(MovementHook_Duck))
+	{
+		player->OnDuck();
+	}
 	player->processingDuck = true;
+	sample.Next();
 	Duck(ms, mv);
+	sample.Next();
 	player->processingDuck = false;
-	player->OnDuckPost();
+	if (player->HasPostHook(MovementHook_Duck))
+	{
+		player->OnDuckPost();
+	}
 }
 
 bool FASTCALL movement::Detour_CanUnduck(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnCanUnduck();
+	perf::Scope sample(player->index, MovementHook_CanUnduck);
+	if (player->HasPreHook(MovementHook_CanUnduck))
+	{
+		player->OnCanUnduck();
+	}
+	sample.Next();
 	bool canUnduck = CanUnduck(ms, mv);
-	player->OnCanUnduckPost(canUnduck);
+	sample.Next();
+	if (player->HasPostHook(MovementHook_CanUnduck))
+	{
+		player->OnCanUnduckPost(canUnduck);
+	}
 	return canUnduck;
 }
 
 bool FASTCALL movement::Detour_LadderMove(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnLadderMove();
+	perf::Scope sample(player->index, MovementHook_LadderMove);
+	if (player->HasPreHook(MovementHook_LadderMove))
+	{
+		player->OnLadderMove();
+	}
 	Vector oldVelocity = mv->m_vecVelocity;
 	MoveType_t oldMoveType = player->GetPawn()->m_MoveType();
+	sample.Next();
 	bool result = LadderMove(ms, mv);
+	sample.Next();
 	if (player->GetPawn()->m_lifeState() != LIFE_DEAD && !result && oldMoveType == MOVETYPE_LADDER)
 	{
 		// Do the setting part ourselves as well.
@@ -220,13 +351,17 @@ bool FASTCALL movement::Detour_LadderMove(CCSPlayer_MovementServices *ms, CMoveD
 	{
 		player->GetOrigin(&player->lastValidLadderOrigin);
 	}
-	player->OnLadderMovePost();
+	if (player->HasPostHook(MovementHook_LadderMove))
+	{
+		player->OnLadderMovePost();
+	}
 	return result;
 }
 
 void FASTCALL movement::Detour_CheckJumpButton(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
+	perf::Scope sample(player->index, MovementHook_CheckJumpButton);
 #ifdef WATER_FIX
 	if (player->enableWaterFix && ms->pawn->m_MoveType() == MOVETYPE_WALK && ms->pawn->m_flWaterLevel() > 0.5f)
 	{
@@ -237,66 +372,125 @@ void FASTCALL movement::Detour_CheckJumpButton(CCSPlayer_MovementServices *ms, C
 		movement::Detour_Duck(ms, mv);
 	}
 #endif
-	player->OnCheckJumpButton();
+	if (player->HasPreHook(MovementHook_CheckJumpButton))
+	{
+		player->OnCheckJumpButton();
+	}
+	sample.Next();
 	CheckJumpButton(ms, mv);
-	player->OnCheckJumpButtonPost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_CheckJumpButton))
+	{
+		player->OnCheckJumpButtonPost();
+	}
 }
 
 void FASTCALL movement::Detour_OnJump(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnJump();
+	perf::Scope sample(player->index, MovementHook_OnJump);
+	if (player->HasPreHook(MovementHook_OnJump))
+	{
+		player->OnJump();
+	}
 	f32 oldJumpUntil = ms->m_flJumpUntil();
 	MoveType_t oldMoveType = player->GetPawn()->m_MoveType();
+	sample.Next();
 	OnJump(ms, mv);
+	sample.Next();
 	if (ms->m_flJumpUntil() != oldJumpUntil)
 	{
 		player->hitPerf = (oldMoveType != MOVETYPE_LADDER && !player->oldWalkMoved);
 		player->RegisterTakeoff(true);
 		player->OnStopTouchGround();
 	}
-	player->OnJumpPost();
+	if (player->HasPostHook(MovementHook_OnJump))
+	{
+		player->OnJumpPost();
+	}
 }
 
 void FASTCALL movement::Detour_AirMove(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnAirMove();
+	perf::Scope sample(player->index, MovementHook_AirMove);
+	if (player->HasPreHook(MovementHook_AirMove))
+	{
+		player->OnAirMove();
+	}
+	sample.Next();
 	AirMove(ms, mv);
-	player->OnAirMovePost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_AirMove))
+	{
+		player->OnAirMovePost();
+	}
 }
 
 void FASTCALL movement::Detour_AirAccelerate(CCSPlayer_MovementServices *ms, CMoveData *mv, Vector &wishdir, f32 wishspeed, f32 accel)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnAirAccelerate(wishdir, wishspeed, accel);
+	perf::Scope sample(player->index, MovementHook_AirAccelerate);
+	if (player->HasPreHook(MovementHook_AirAccelerate))
+	{
+		player->OnAirAccelerate(wishdir, wishspeed, accel);
+	}
+	sample.Next();
 	AirAccelerate(ms, mv, wishdir, wishspeed, accel);
-	player->OnAirAcceleratePost(wishdir, wishspeed, accel);
+	sample.Next();
+	if (player->HasPostHook(MovementHook_AirAccelerate))
+	{
+		player->OnAirAcceleratePost(wishdir, wishspeed, accel);
+	}
 }
 
 void FASTCALL movement::Detour_Friction(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnFriction();
+	perf::Scope sample(player->index, MovementHook_Friction);
+	if (player->HasPreHook(MovementHook_Friction))
+	{
+		player->OnFriction();
+	}
+	sample.Next();
 	Friction(ms, mv);
-	player->OnFrictionPost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_Friction))
+	{
+		player->OnFrictionPost();
+	}
 }
 
 void FASTCALL movement::Detour_WalkMove(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnWalkMove();
+	perf::Scope sample(player->index, MovementHook_WalkMove);
+	if (player->HasPreHook(MovementHook_WalkMove))
+	{
+		player->OnWalkMove();
+	}
+	sample.Next();
 	WalkMove(ms, mv);
+	sample.Next();
 	player->walkMoved = true;
-	player->OnWalkMovePost();
+	if (player->HasPostHook(MovementHook_WalkMove))
+	{
+		player->OnWalkMovePost();
+	}
 }
 
 void FASTCALL movement::Detour_TryPlayerMove(CCSPlayer_MovementServices *ms, CMoveData *mv, Vector *pFirstDest, trace_t_s2 *pFirstTrace)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnTryPlayerMove(pFirstDest, pFirstTrace);
+	perf::Scope sample(player->index, MovementHook_TryPlayerMove);
+	if (player->HasPreHook(MovementHook_TryPlayerMove))
+	{
+		player->OnTryPlayerMove(pFirstDest, pFirstTrace);
+	}
 	Vector oldVelocity = mv->m_vecVelocity;
+	sample.Next();
 	TryPlayerMove(ms, mv, pFirstDest, pFirstTrace);
+	sample.Next();
 	if (mv->m_vecVelocity != oldVelocity)
 	{
 		// Velocity changed, must have collided with something.
@@ -304,7 +498,10 @@ void FASTCALL movement::Detour_TryPlayerMove(CCSPlayer_MovementServices *ms, CMo
 		// but for now this doesn't matter.
 		player->SetCollidingWithWorld();
 	}
-	player->OnTryPlayerMovePost(pFirstDest, pFirstTrace);
+	if (player->HasPostHook(MovementHook_TryPlayerMove))
+	{
+		player->OnTryPlayerMovePost(pFirstDest, pFirstTrace);
+	}
 }
 
 void FASTCALL movement::Detour_CategorizePosition(CCSPlayer_MovementServices *ms, CMoveData *mv, bool bStayOnGround)
@@ -317,11 +514,17 @@ void FASTCALL movement::Detour_CategorizePosition(CCSPlayer_MovementServices *ms
 		return;
 	}
 #endif
-	player->OnCategorizePosition(bStayOnGround);
+	perf::Scope sample(player->index, MovementHook_CategorizePosition);
+	if (player->HasPreHook(MovementHook_CategorizePosition))
+	{
+		player->OnCategorizePosition(bStayOnGround);
+	}
 	Vector oldVelocity = mv->m_vecVelocity;
 	bool oldOnGround = !!(player->GetPawn()->m_fFlags() & FL_ONGROUND);
 
+	sample.Next();
 	CategorizePosition(ms, mv, bStayOnGround);
+	sample.Next();
 
 	bool ground = !!(player->GetPawn()->m_fFlags() & FL_ONGROUND);
 
@@ -339,37 +542,76 @@ void FASTCALL movement::Detour_CategorizePosition(CCSPlayer_MovementServices *ms
 			player->OnStopTouchGround();
 		}
 	}
-	player->OnCategorizePositionPost(bStayOnGround);
+	if (player->HasPostHook(MovementHook_CategorizePosition))
+	{
+		player->OnCategorizePositionPost(bStayOnGround);
+	}
 }
 
 void FASTCALL movement::Detour_FinishGravity(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnFinishGravity();
+	perf::Scope sample(player->index, MovementHook_FinishGravity);
+	if (player->HasPreHook(MovementHook_FinishGravity))
+	{
+		player->OnFinishGravity();
+	}
+	sample.Next();
 	FinishGravity(ms, mv);
-	player->OnFinishGravityPost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_FinishGravity))
+	{
+		player->OnFinishGravityPost();
+	}
 }
 
 void FASTCALL movement::Detour_CheckFalling(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnCheckFalling();
+	perf::Scope sample(player->index, MovementHook_CheckFalling);
+	if (player->HasPreHook(MovementHook_CheckFalling))
+	{
+		player->OnCheckFalling();
+	}
+	sample.Next();
 	CheckFalling(ms, mv);
-	player->OnCheckFallingPost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_CheckFalling))
+	{
+		player->OnCheckFallingPost();
+	}
 }
 
 void FASTCALL movement::Detour_PostPlayerMove(CCSPlayer_MovementServices *ms, CMoveData *mv)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(ms);
-	player->OnPostPlayerMove();
+	perf::Scope sample(player->index, MovementHook_PostPlayerMove);
+	if (player->HasPreHook(MovementHook_PostPlayerMove))
+	{
+		player->OnPostPlayerMove();
+	}
+	sample.Next();
 	PostPlayerMove(ms, mv);
-	player->OnPostPlayerMovePost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_PostPlayerMove))
+	{
+		player->OnPostPlayerMovePost();
+	}
 }
 
 void FASTCALL movement::Detour_PostThink(CCSPlayerPawnBase *pawn)
 {
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(pawn);
-	player->OnPostThink();
+	perf::Scope sample(player->index, MovementHook_PostThink);
+	if (player->HasPreHook(MovementHook_PostThink))
+	{
+		player->OnPostThink();
+	}
+	sample.Next();
 	PostThink(pawn);
-	player->OnPostThinkPost();
+	sample.Next();
+	if (player->HasPostHook(MovementHook_PostThink))
+	{
+		player->OnPostThinkPost();
+	}
 }
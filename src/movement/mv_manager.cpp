@@ -5,7 +5,20 @@
 
 MovementPlayer *CMovementPlayerManager::ToPlayer(CCSPlayer_MovementServices *ms)
 {
-	return this->ToPlayer(ms->pawn);
+	CBasePlayerPawn *pawn = ms->pawn;
+	if (pawn)
+	{
+		i32 pawnIndex = pawn->entindex();
+		if (pawnIndex >= 0 && pawnIndex < MV_MAX_NETWORKED_ENTITIES)
+		{
+			MovementPlayer *player = this->players[this->pawnOwners[pawnIndex]];
+			if (player->IsCachedMoveServices(ms))
+			{
+				return player;
+			}
+		}
+	}
+	return this->ToPlayer(pawn);
 }
 
 MovementPlayer *CMovementPlayerManager::ToPlayer(CBasePlayerController *controller)
@@ -25,6 +38,15 @@ MovementPlayer *CMovementPlayerManager::ToPlayer(CBasePlayerPawn *pawn)
 	{
 		return nullptr;
 	}
+	i32 pawnIndex = pawn->entindex();
+	if (pawnIndex >= 0 && pawnIndex < MV_MAX_NETWORKED_ENTITIES)
+	{
+		MovementPlayer *player = this->players[this->pawnOwners[pawnIndex]];
+		if (player->IsCachedPawn(pawn))
+		{
+			return player;
+		}
+	}
 	CBasePlayerController *controller = utils::GetController(pawn);
 	if (!controller)
 	{
@@ -74,3 +96,17 @@ MovementPlayer *CMovementPlayerManager::ToPlayer(CPlayerUserId userID)
 	}
 	return nullptr;
 }
+
+void CMovementPlayerManager::OnEntityDeleted(CEntityInstance *entity)
+{
+	i32 entIndex = entity->GetEntityIndex().Get();
+	if (entIndex < 0 || entIndex >= MV_MAX_NETWORKED_ENTITIES || !this->pawnOwners[entIndex])
+	{
+		return;
+	}
+	MovementPlayer *player = this->players[this->pawnOwners[entIndex]];
+	if (player->IsCachedPawn(static_cast<CBasePlayerPawn *>(entity)))
+	{
+		player->InvalidateEntityCache();
+	}
+}
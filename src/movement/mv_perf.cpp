@@ -0,0 +1,415 @@
+#include "mv_perf.h"
+#include "movement.h"
+#include "utils/utils.h"
+#include "utils/ctimer.h"
+#include "utils/simplecmds.h"
+
+#ifdef _WIN32
+#include <intrin.h>
+#endif
+
+#include "tier0/memdbgon.h"
+
+struct PerfStats
+{
+	std::atomic<u64> count;
+	std::atomic<u64> total;
+	std::atomic<u64> max;
+};
+
+struct PerfHistogram
+{
+	std::atomic<u64> buckets[MV_PERF_BUCKET_COUNT];
+	PerfStats stats;
+};
+
+typedef void (*PerfLineFn)(void *data, const char *line);
+
+// clang-format off
+internal const char *hookNames[MOVEMENTHOOK_COUNT] =
+{
+	"PhysicsSimulate",
+	"GetMaxSpeed",
+	"ProcessUsercmds",
+	"ProcessMovement",
+	"PlayerMoveNew",
+	"CheckParameters",
+	"CanMove",
+	"FullWalkMove",
+	"MoveInit",
+	"CheckWater",
+	"WaterMove",
+	"CheckVelocity",
+	"Duck",
+	"CanUnduck",
+	"LadderMove",
+	"CheckJumpButton",
+	"OnJump",
+	"AirMove",
+	"AirAccelerate",
+	"Friction",
+	"WalkMove",
+	"TryPlayerMove",
+	"CategorizePosition",
+	"FinishGravity",
+	"CheckFalling",
+	"PostPlayerMove",
+	"PostThink"
+};
+
+internal const char *phaseNames[movement::perf::PERFPHASE_COUNT] = {"pre", "orig", "post"};
+
+// clang-format on
+
+std::atomic<bool> movement::perf::enabled;
+
+internal PerfHistogram histograms[MV_PERF_MAX_CONTEXTS][MOVEMENTHOOK_COUNT][movement::perf::PERFPHASE_COUNT];
+internal PerfStats playerStats[MAXPLAYERS + 1][MOVEMENTHOOK_COUNT][movement::perf::PERFPHASE_COUNT];
+internal std::atomic<u8> playerContexts[MAXPLAYERS + 1];
+internal char contextNames[MV_PERF_MAX_CONTEXTS][MV_PERF_CONTEXT_NAME_LEN] = {"-"};
+internal i32 contextCount = 1;
+internal bool otherContextUsed;
+
+// End of the contexts that can have samples.
+internal i32 GetContextEnd()
+{
+	return otherContextUsed ? MV_PERF_MAX_CONTEXTS : contextCount;
+}
+
+internal SCMD_CALLBACK(Command_KzPerf);
+
+internal u32 HighestBit(u64 value)
+{
+#ifdef _WIN32
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return index;
+#else
+	return 63 - __builtin_clzll(value);
+#endif
+}
+
+internal u32 BucketIndex(u64 nanoseconds)
+{
+	if (nanoseconds < (1 << MV_PERF_SUB_BUCKET_BITS))
+	{
+		return (u32)nanoseconds;
+	}
+	u32 msb = HighestBit(nanoseconds);
+	u32 subBucket = (nanoseconds >> (msb - MV_PERF_SUB_BUCKET_BITS)) & ((1 << MV_PERF_SUB_BUCKET_BITS) - 1);
+	u32 index = ((msb - 1) << MV_PERF_SUB_BUCKET_BITS) | subBucket;
+	return MIN(index, MV_PERF_BUCKET_COUNT - 1);
+}
+
+// Exclusive upper bound of the values that end up in this bucket.
+internal u64 BucketUpperBound(u32 index)
+{
+	if (index < (1 << MV_PERF_SUB_BUCKET_BITS))
+	{
+		return index + 1;
+	}
+	u32 shift = (index >> MV_PERF_SUB_BUCKET_BITS) - 1;
+	u64 lower = (u64)((1 << MV_PERF_SUB_BUCKET_BITS) | (index & ((1 << MV_PERF_SUB_BUCKET_BITS) - 1))) << shift;
+	return lower + (1ull << shift);
+}
+
+internal void AddSample(PerfStats &stats, u64 nanoseconds)
+{
+	stats.count.fetch_add(1, std::memory_order_relaxed);
+	stats.total.fetch_add(nanoseconds, std::memory_order_relaxed);
+	u64 max = stats.max.load(std::memory_order_relaxed);
+	while (nanoseconds > max && !stats.max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+	{
+	}
+}
+
+internal void ResetStats(PerfStats &stats)
+{
+	stats.count.store(0, std::memory_order_relaxed);
+	stats.total.store(0, std::memory_order_relaxed);
+	stats.max.store(0, std::memory_order_relaxed);
+}
+
+internal u64 Percentile(const u64 *buckets, u64 count, u64 max, f64 percentile)
+{
+	u64 target = (u64)ceil(count * percentile);
+	u64 seen = 0;
+	for (u32 i = 0; i < MV_PERF_BUCKET_COUNT; i++)
+	{
+		seen += buckets[i];
+		if (seen >= target)
+		{
+			return MIN(BucketUpperBound(i), max);
+		}
+	}
+	return max;
+}
+
+// Merges the histograms of the contexts in [contextStart, contextEnd) and prints one line per hook and phase.
+internal void ReportHistograms(PerfLineFn print, void *data, i32 contextStart, i32 contextEnd)
+{
+	char line[256];
+	V_snprintf(line, sizeof(line), "%-20s %-5s %10s %10s %10s %10s %12s", "hook", "phase", "count", "p50 (us)", "p99 (us)", "max (us)",
+			   "total (ms)");
+	print(data, line);
+
+	for (u32 hook = 0; hook < MOVEMENTHOOK_COUNT; hook++)
+	{
+		for (u32 phase = 0; phase < movement::perf::PERFPHASE_COUNT; phase++)
+		{
+			u64 buckets[MV_PERF_BUCKET_COUNT] = {};
+			u64 count = 0;
+			u64 total = 0;
+			u64 max = 0;
+			for (i32 context = contextStart; context < contextEnd; context++)
+			{
+				PerfHistogram &histogram = histograms[context][hook][phase];
+				for (u32 i = 0; i < MV_PERF_BUCKET_COUNT; i++)
+				{
+					buckets[i] += histogram.buckets[i].load(std::memory_order_relaxed);
+				}
+				count += histogram.stats.count.load(std::memory_order_relaxed);
+				total += histogram.stats.total.load(std::memory_order_relaxed);
+				max = MAX(max, histogram.stats.max.load(std::memory_order_relaxed));
+			}
+			if (count == 0)
+			{
+				continue;
+			}
+			// clang-format off
+			V_snprintf(line, sizeof(line), "%-20s %-5s %10llu %10.2f %10.2f %10.2f %12.3f",
+					   hookNames[hook],
+					   phaseNames[phase],
+					   count,
+					   Percentile(buckets, count, max, 0.5) / 1000.0,
+					   Percentile(buckets, count, max, 0.99) / 1000.0,
+					   max / 1000.0,
+					   total / 1000000.0);
+			// clang-format on
+			print(data, line);
+		}
+	}
+}
+
+internal void ReportContexts(PerfLineFn print, void *data)
+{
+	char line[256];
+	for (i32 context = 0; context < GetContextEnd(); context++)
+	{
+		if (context >= contextCount && context != MV_PERF_OTHER_CONTEXT)
+		{
+			continue;
+		}
+		V_snprintf(line, sizeof(line), "[%s]", contextNames[context]);
+		print(data, line);
+		ReportHistograms(print, data, context, context + 1);
+	}
+}
+
+internal void ReportPlayers(PerfLineFn print, void *data)
+{
+	char line[256];
+	V_snprintf(line, sizeof(line), "%-3s %-32s %-16s %10s %14s %-20s", "#", "name", "mode/style", "total (ms)", "per tick (us)", "worst hook");
+	print(data, line);
+
+	for (i32 i = 1; i <= MAXPLAYERS; i++)
+	{
+		u64 total = 0;
+		u64 worstTotal = 0;
+		u32 worstHook = 0;
+		for (u32 hook = 0; hook < MOVEMENTHOOK_COUNT; hook++)
+		{
+			u64 hookTotal = 0;
+			for (u32 phase = 0; phase < movement::perf::PERFPHASE_COUNT; phase++)
+			{
+				hookTotal += playerStats[i][hook][phase].total.load(std::memory_order_relaxed);
+			}
+			if (hookTotal > worstTotal)
+			{
+				worstTotal = hookTotal;
+				worstHook = hook;
+			}
+			total += hookTotal;
+		}
+		if (total == 0)
+		{
+			continue;
+		}
+		// PhysicsSimulate runs once per player per tick.
+		u64 ticks = playerStats[i][MovementHook_PhysicsSimulate][movement::perf::PerfPhase_Pre].count.load(std::memory_order_relaxed);
+		CCSPlayerController *controller = g_pPlayerManager->players[i]->GetController();
+		// clang-format off
+		V_snprintf(line, sizeof(line), "%-3i %-32s %-16s %10.3f %14.2f %-20s",
+				   i,
+				   controller ? controller->m_iszPlayerName() : "-",
+				   contextNames[playerContexts[i].load(std::memory_order_relaxed)],
+				   total / 1000000.0,
+				   ticks ? total / 1000.0 / ticks : 0.0,
+				   hookNames[worstHook]);
+		// clang-format on
+		print(data, line);
+	}
+}
+
+internal void PrintToFile(void *data, const char *line)
+{
+	fprintf((FILE *)data, "%s\n", line);
+}
+
+internal void PrintToConsole(void *data, const char *line)
+{
+	utils::PrintConsole((CBaseEntity2 *)data, "%s", line);
+}
+
+internal f64 DumpTimer()
+{
+	if (movement::perf::IsEnabled())
+	{
+		movement::perf::WriteDumpFile();
+	}
+	return MV_PERF_DUMP_INTERVAL;
+}
+
+void movement::perf::Init()
+{
+	scmd::RegisterCmd("kz_perf", Command_KzPerf, "Movement profiler: on, off, reset, modes, players, dump.", true, true);
+	StartTimer(DumpTimer, true, true);
+}
+
+void movement::perf::SetEnabled(bool enable)
+{
+	enabled.store(enable, std::memory_order_relaxed);
+}
+
+void movement::perf::Reset()
+{
+	for (u32 context = 0; context < MV_PERF_MAX_CONTEXTS; context++)
+	{
+		for (u32 hook = 0; hook < MOVEMENTHOOK_COUNT; hook++)
+		{
+			for (u32 phase = 0; phase < PERFPHASE_COUNT; phase++)
+			{
+				for (u32 i = 0; i < MV_PERF_BUCKET_COUNT; i++)
+				{
+					histograms[context][hook][phase].buckets[i].store(0, std::memory_order_relaxed);
+				}
+				ResetStats(histograms[context][hook][phase].stats);
+			}
+		}
+	}
+	for (u32 i = 0; i <= MAXPLAYERS; i++)
+	{
+		for (u32 hook = 0; hook < MOVEMENTHOOK_COUNT; hook++)
+		{
+			for (u32 phase = 0; phase < PERFPHASE_COUNT; phase++)
+			{
+				ResetStats(playerStats[i][hook][phase]);
+			}
+		}
+	}
+}
+
+void movement::perf::SetPlayerContext(i32 playerIndex, const char *modeName, const char *styleName)
+{
+	if (playerIndex < 0 || playerIndex > MAXPLAYERS)
+	{
+		return;
+	}
+	char name[MV_PERF_CONTEXT_NAME_LEN];
+	V_snprintf(name, sizeof(name), "%s/%s", modeName, styleName);
+
+	i32 context = 1;
+	for (; context < contextCount; context++)
+	{
+		if (!V_stricmp(contextNames[context], name))
+		{
+			break;
+		}
+	}
+	if (context == contextCount)
+	{
+		if (contextCount < MV_PERF_OTHER_CONTEXT)
+		{
+			V_strncpy(contextNames[contextCount++], name, MV_PERF_CONTEXT_NAME_LEN);
+		}
+		else
+		{
+			context = MV_PERF_OTHER_CONTEXT;
+			V_strncpy(contextNames[context], "other", MV_PERF_CONTEXT_NAME_LEN);
+			otherContextUsed = true;
+		}
+	}
+	playerContexts[playerIndex].store((u8)context, std::memory_order_relaxed);
+}
+
+void movement::perf::Record(i32 playerIndex, MovementHook hook, Phase phase, u64 nanoseconds)
+{
+	bool validPlayer = playerIndex >= 0 && playerIndex <= MAXPLAYERS;
+	u8 context = validPlayer ? playerContexts[playerIndex].load(std::memory_order_relaxed) : 0;
+
+	PerfHistogram &histogram = histograms[context][hook][phase];
+	histogram.buckets[BucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+	AddSample(histogram.stats, nanoseconds);
+	if (validPlayer)
+	{
+		AddSample(playerStats[playerIndex][hook][phase], nanoseconds);
+	}
+}
+
+bool movement::perf::WriteDumpFile()
+{
+	char path[1024];
+	g_SMAPI->PathFormat(path, sizeof(path), "%s/%s", g_SMAPI->GetBaseDir(), MV_PERF_DUMP_FILE);
+	FILE *file = fopen(path, "w");
+	if (!file)
+	{
+		META_CONPRINTF("[KZ] Failed to open %s for writing!\n", path);
+		return false;
+	}
+	fprintf(file, "Movement profiler dump, tick %i\n\n", g_pKZUtils->GetServerGlobals()->tickcount);
+	ReportHistograms(PrintToFile, file, 0, GetContextEnd());
+	fprintf(file, "\n");
+	ReportContexts(PrintToFile, file);
+	fprintf(file, "\n");
+	ReportPlayers(PrintToFile, file);
+	fclose(file);
+	return true;
+}
+
+internal SCMD_CALLBACK(Command_KzPerf)
+{
+	const char *arg = args->Arg(1);
+	CBaseEntity2 *entity = controller;
+	if (!V_stricmp(arg, "on") || !V_stricmp(arg, "off"))
+	{
+		movement::perf::SetEnabled(!V_stricmp(arg, "on"));
+		utils::PrintConsole(entity, "Movement profiler %s.", movement::perf::IsEnabled() ? "enabled" : "disabled");
+	}
+	else if (!V_stricmp(arg, "reset"))
+	{
+		movement::perf::Reset();
+		utils::PrintConsole(entity, "Movement profiler data cleared.");
+	}
+	else if (!V_stricmp(arg, "modes"))
+	{
+		ReportContexts(PrintToConsole, entity);
+	}
+	else if (!V_stricmp(arg, "players"))
+	{
+		ReportPlayers(PrintToConsole, entity);
+	}
+	else if (!V_stricmp(arg, "dump"))
+	{
+		if (movement::perf::WriteDumpFile())
+		{
+			utils::PrintConsole(entity, "Movement profiler data written to %s.", MV_PERF_DUMP_FILE);
+		}
+	}
+	else
+	{
+		utils::PrintConsole(entity, "Movement profiler is %s. Usage: kz_perf [on|off|reset|modes|players|dump]",
+							movement::perf::IsEnabled() ? "enabled" : "disabled");
+		ReportHistograms(PrintToConsole, entity, 0, GetContextEnd());
+	}
+	return MRES_SUPERCEDE;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "common.h"
+#include "movement.h"
+#include <atomic>
+#include <chrono>
+
+// Mode/style combinations tracked separately, slot 0 is for players without one. Extra combinations share the last slot, "other".
+#define MV_PERF_MAX_CONTEXTS     8
+#define MV_PERF_OTHER_CONTEXT    (MV_PERF_MAX_CONTEXTS - 1)
+#define MV_PERF_CONTEXT_NAME_LEN 64
+
+// Log2-spaced buckets with 4 linear sub-buckets each, covering 0ns to ~8.6s.
+#define MV_PERF_SUB_BUCKET_BITS 2
+#define MV_PERF_BUCKET_COUNT    132
+
+#define MV_PERF_DUMP_INTERVAL 60.0
+#define MV_PERF_DUMP_FILE     "addons/cs2kz/perf.txt"
+
+/*
+ * Timing of every movement detour, split into the pre hook, the original function and the post hook.
+ * Always compiled in, a disabled profiler costs one relaxed atomic load per detour.
+ */
+namespace movement::perf
+{
+	enum Phase : u8
+	{
+		PerfPhase_Pre,
+		PerfPhase_Original,
+		PerfPhase_Post,
+		PERFPHASE_COUNT
+	};
+
+	extern std::atomic<bool> enabled;
+
+	void Init();
+
+	inline bool IsEnabled()
+	{
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	void SetEnabled(bool enable);
+	void Reset();
+
+	// Samples of this player are attributed to the given mode/style combination from now on.
+	void SetPlayerContext(i32 playerIndex, const char *modeName, const char *styleName);
+	void Record(i32 playerIndex, MovementHook hook, Phase phase, u64 nanoseconds);
+	bool WriteDumpFile();
+
+	inline u64 Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Call Next() between the phases of a detour, the phase still open is recorded when the scope ends.
+	class Scope
+	{
+	public:
+		Scope(i32 playerIndex, MovementHook hook, Phase phase = PerfPhase_Pre)
+			: active(IsEnabled()), playerIndex(playerIndex), hook(hook), phase(phase), start(active ? Now() : 0)
+		{
+		}
+
+		~Scope()
+		{
+			if (this->active)
+			{
+				Record(this->playerIndex, this->hook, this->phase, Now() - this->start);
+			}
+		}
+
+		void Next()
+		{
+			if (!this->active || this->phase + 1 >= PERFPHASE_COUNT)
+			{
+				return;
+			}
+			u64 now = Now();
+			Record(this->playerIndex, this->hook, this->phase, now - this->start);
+			this->start = now;
+			this->phase = (Phase)(this->phase + 1);
+		}
+
+	private:
+		bool active;
+		i32 playerIndex;
+		MovementHook hook;
+		Phase phase;
+		u64 start;
+	};
+} // namespace movement::perf
@@ -23,7 +23,7 @@ void MovementPlayer::OnProcessMovementPost()
 	this->oldWalkMoved = this->walkMoved;
 }
 
-CCSPlayerController *MovementPlayer::GetController()
+CCSPlayerController *MovementPlayer::ResolveController()
 {
 	if (!GameEntitySystem())
 	{
@@ -37,9 +37,22 @@ CCSPlayerController *MovementPlayer::GetController()
 	return ent->IsController() ? static_cast<CCSPlayerController *>(ent) : nullptr;
 }
 
+CCSPlayerController *MovementPlayer::GetController()
+{
+	if (this->entityCache.valid)
+	{
+		return this->entityCache.controller;
+	}
+	return this->ResolveController();
+}
+
 CCSPlayerPawn *MovementPlayer::GetPawn()
 {
-	CCSPlayerController *controller = this->GetController();
+	if (this->entityCache.valid)
+	{
+		return this->entityCache.pawn;
+	}
+	CCSPlayerController *controller = this->ResolveController();
 	if (!controller)
 	{
 		return nullptr;
@@ -49,13 +62,54 @@ CCSPlayerPawn *MovementPlayer::GetPawn()
 
 CCSPlayer_MovementServices *MovementPlayer::GetMoveServices()
 {
-	if (!this->GetPawn())
+	if (this->entityCache.valid)
+	{
+		return this->entityCache.moveServices;
+	}
+	CCSPlayerPawn *pawn = this->GetPawn();
+	if (!pawn)
 	{
 		return nullptr;
 	}
-	return static_cast<CCSPlayer_MovementServices *>(this->GetPawn()->m_pMovementServices());
+	return static_cast<CCSPlayer_MovementServices *>(pawn->m_pMovementServices());
 };
 
+void MovementPlayer::RefreshEntityCache()
+{
+	this->InvalidateEntityCache();
+
+	CCSPlayerController *controller = this->ResolveController();
+	CCSPlayerPawn *pawn = controller ? controller->m_hPlayerPawn().Get() : nullptr;
+	if (!pawn)
+	{
+		return;
+	}
+	i32 pawnIndex = pawn->entindex();
+	if (pawnIndex < 0 || pawnIndex >= MV_MAX_NETWORKED_ENTITIES)
+	{
+		return;
+	}
+	this->entityCache.controller = controller;
+	this->entityCache.pawn = pawn;
+	this->entityCache.moveServices = static_cast<CCSPlayer_MovementServices *>(pawn->m_pMovementServices());
+	this->entityCache.valid = true;
+	g_pPlayerManager->pawnOwners[pawnIndex] = this->index;
+}
+
+void MovementPlayer::InvalidateEntityCache()
+{
+	if (!this->entityCache.valid)
+	{
+		return;
+	}
+	i32 pawnIndex = this->entityCache.pawn->entindex();
+	if (g_pPlayerManager->pawnOwners[pawnIndex] == this->index)
+	{
+		g_pPlayerManager->pawnOwners[pawnIndex] = 0;
+	}
+	this->entityCache = {};
+}
+
 void MovementPlayer::GetOrigin(Vector *origin)
 {
 	if (this->processingMovement && this->currentMoveData)
@@ -341,6 +395,7 @@ void MovementPlayer::Reset()
 	this->pendingEndTouchTriggers.RemoveAll();
 	this->touchedTriggers.RemoveAll();
 	this->collidingWithWorld = false;
+	this->InvalidateEntityCache();
 }
 
 META_RES MovementPlayer::GetPlayerMaxSpeed(f32 &maxSpeed)
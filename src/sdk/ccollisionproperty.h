@@ -16,7 +16,10 @@ public:
 	DECLARE_SCHEMA_CLASS_INLINE(CCollisionProperty)
 
 	SCHEMA_FIELD(VPhysicsCollisionAttribute_t, m_collisionAttribute)
+	SCHEMA_FIELD(Vector, m_vecMins)
+	SCHEMA_FIELD(Vector, m_vecMaxs)
 	SCHEMA_FIELD(SolidType_t, m_nSolidType)
 	SCHEMA_FIELD(uint8, m_usSolidFlags)
 	SCHEMA_FIELD(uint8, m_CollisionGroup)
+	SCHEMA_FIELD(uint8, m_triggerBloat)
 };
@@ -10,6 +10,6 @@ class CGameResourceService
 public:
 	CGameEntitySystem *GetGameEntitySystem()
 	{
-		return *reinterpret_cast<CGameEntitySystem **>((uintptr_t)(this) + g_pGameConfig->GetOffset("GameEntitySystem"));
+		return *reinterpret_cast<CGameEntitySystem **>((uintptr_t)(this) + g_pGameConfig->GetOffset(gamedata::gameEntitySystem));
 	}
 };
@@ -9,6 +9,7 @@
 #include "ehandle.h"
 #include "sdk/entity/ccsplayercontroller.h"
 #include "sdk/entity/cbasetrigger.h"
+#include "utils/entityhandleset.h"
 struct TransmitInfo
 {
 	CBitVec<16384> *m_pTransmitEdict;
@@ -369,11 +370,11 @@ public:
 		attr.m_nCollisionGroup = COLLISION_GROUP_DEBRIS;
 		attr.m_bHitTrigger = true;
 	}
-	CUtlVector<CEntityHandle> hitTriggerHandles;
+	EntityHandleSet hitTriggerHandles;
 	virtual ~CTraceFilterHitAllTriggers() { hitTriggerHandles.Purge(); }
 	virtual bool ShouldHitEntity(CBaseEntity2 *other)
 	{
-		hitTriggerHandles.AddToTail(other->GetRefEHandle());
+		hitTriggerHandles.Insert(other->GetRefEHandle());
 		return false;
 	}
 };
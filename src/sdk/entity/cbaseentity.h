@@ -55,6 +55,7 @@ public:
 	SCHEMA_FIELD(float, m_flScale)
 	SCHEMA_FIELD(float, m_flAbsScale)
 	SCHEMA_FIELD(Vector, m_vecAbsOrigin)
+	SCHEMA_FIELD(QAngle, m_angAbsRotation)
 	SCHEMA_FIELD(Vector, m_vRenderOrigin)
 };
 
@@ -95,20 +96,20 @@ public:
 
 	int entindex() { return m_pEntity->m_EHandle.GetEntryIndex(); }
 
-	bool IsPawn() { return CALL_VIRTUAL(bool, g_pGameConfig->GetOffset("IsEntityPawn"), this); }
-	bool IsController() { return CALL_VIRTUAL(bool, g_pGameConfig->GetOffset("IsEntityController"), this); }
+	bool IsPawn() { return CALL_VIRTUAL(bool, g_pGameConfig->GetOffset(gamedata::isEntityPawn), this); }
+	bool IsController() { return CALL_VIRTUAL(bool, g_pGameConfig->GetOffset(gamedata::isEntityController), this); }
 
 	bool IsAlive() { return this->m_lifeState() == LIFE_ALIVE; }
 
 	void SetMoveType(MoveType_t movetype) { this->m_MoveType(movetype); this->m_nActualMoveType(movetype); }
 
-	void CollisionRulesChanged() { CALL_VIRTUAL(void, g_pGameConfig->GetOffset("CollisionRulesChanged"), this); }
+	void CollisionRulesChanged() { CALL_VIRTUAL(void, g_pGameConfig->GetOffset(gamedata::collisionRulesChanged), this); }
 
 	int GetTeam() { return m_iTeamNum(); }
 
-	void StartTouch(CBaseEntity2 *pOther) { CALL_VIRTUAL(bool, g_pGameConfig->GetOffset("StartTouch"), this, pOther); }
-	void Touch(CBaseEntity2 *pOther) { CALL_VIRTUAL(bool, g_pGameConfig->GetOffset("Touch"), this, pOther); }
-	void EndTouch(CBaseEntity2 *pOther) { CALL_VIRTUAL(bool, g_pGameConfig->GetOffset("EndTouch"), this, pOther); }
+	void StartTouch(CBaseEntity2 *pOther) { CALL_VIRTUAL(bool, g_pGameConfig->GetOffset(gamedata::startTouch), this, pOther); }
+	void Touch(CBaseEntity2 *pOther) { CALL_VIRTUAL(bool, g_pGameConfig->GetOffset(gamedata::touch), this, pOther); }
+	void EndTouch(CBaseEntity2 *pOther) { CALL_VIRTUAL(bool, g_pGameConfig->GetOffset(gamedata::endTouch), this, pOther); }
 
-	void Teleport(const Vector *newPosition, const QAngle *newAngles, const Vector *newVelocity) { CALL_VIRTUAL(bool, g_pGameConfig->GetOffset("Teleport"), this, newPosition, newAngles, newVelocity); }
+	void Teleport(const Vector *newPosition, const QAngle *newAngles, const Vector *newVelocity) { CALL_VIRTUAL(bool, g_pGameConfig->GetOffset(gamedata::teleport), this, newPosition, newAngles, newVelocity); }
 };
@@ -19,7 +19,7 @@ public:
 
 	void CommitSuicide(bool bExplode, bool bForce)
 	{
-		CALL_VIRTUAL(void, g_pGameConfig->GetOffset("CommitSuicide"), this, bExplode, bForce);
+		CALL_VIRTUAL(void, g_pGameConfig->GetOffset(gamedata::commitSuicide), this, bExplode, bForce);
 	}
 	bool IsBot() { return !!(this->m_fFlags() & FL_PAWN_FAKECLIENT); }
 };
@@ -1,7 +1,7 @@
 #pragma once
-#include "cbaseentity.h"
+#include "cbasemodelentity.h"
 
-class CBaseTrigger : public CBaseEntity2
+class CBaseTrigger : public CBaseModelEntity
 {
 public:
 	DECLARE_SCHEMA_CLASS(CBaseTrigger)
@@ -12,7 +12,7 @@ public:
 
 	void ChangeTeam(int iTeam)
 	{
-		CALL_VIRTUAL(void, g_pGameConfig->GetOffset("ControllerChangeTeam"), this, iTeam);
+		CALL_VIRTUAL(void, g_pGameConfig->GetOffset(gamedata::controllerChangeTeam), this, iTeam);
 	}
 
 	void SwitchTeam(int iTeam)
@@ -42,6 +42,6 @@ public:
 		{
 			SwitchTeam(RandomInt(CS_TEAM_T, CS_TEAM_CT));
 		}
-		CALL_VIRTUAL(void, g_pGameConfig->GetOffset("ControllerRespawn"), this);
+		CALL_VIRTUAL(void, g_pGameConfig->GetOffset(gamedata::controllerRespawn), this);
 	}
 };
@@ -19,5 +19,5 @@ class CCSPlayerPawn : public CCSPlayerPawnBase
 public:
 	DECLARE_SCHEMA_CLASS(CCSPlayerPawn);
 
-	void Respawn() { CALL_VIRTUAL(void, g_pGameConfig->GetOffset("Respawn"), this); }
+	void Respawn() { CALL_VIRTUAL(void, g_pGameConfig->GetOffset(gamedata::respawn), this); }
 };
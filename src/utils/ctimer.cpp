@@ -1,41 +1,99 @@
 #include "ctimer.h"
 
-CUtlVector<CTimerBase *> g_PersistentTimers;
-CUtlVector<CTimerBase *> g_NonPersistentTimers;
+#include <algorithm>
 
-internal void ProcessTimerList(CUtlVector<CTimerBase *> &timers)
+// Min-heaps on the next execution time, one per clock.
+internal CUtlVector<CTimerBase *> gameTimeTimers;
+internal CUtlVector<CTimerBase *> realTimeTimers;
+// Timers started since the last ProcessTimers, they run on the next one.
+internal CUtlVector<CTimerBase *> newTimers;
+// Popped off its heap while it executes, so map changes from inside a timer can still reach it.
+internal CTimerBase *runningTimer;
+
+internal bool FiresLater(const CTimerBase *a, const CTimerBase *b)
+{
+	return a->nextExecute > b->nextExecute;
+}
+
+internal void PushTimer(CUtlVector<CTimerBase *> &timers, CTimerBase *timer)
 {
-	for (int i = timers.Count() - 1; i >= 0; i--)
+	timers.AddToTail(timer);
+	std::push_heap(timers.Base(), timers.Base() + timers.Count(), FiresLater);
+}
+
+internal void ProcessTimerHeap(CUtlVector<CTimerBase *> &timers, f64 currentTime)
+{
+	while (timers.Count() && timers[0]->nextExecute <= currentTime)
 	{
-		auto timer = g_PersistentTimers[i];
-		f64 currentTime = timer->useRealTime ? g_pKZUtils->GetGlobals()->realtime : g_pKZUtils->GetGlobals()->curtime;
-		if (timer->lastExecute == -1)
-		{
-			timer->lastExecute = currentTime;
-		}
+		std::pop_heap(timers.Base(), timers.Base() + timers.Count(), FiresLater);
+		CTimerBase *timer = timers.Tail();
+		timers.RemoveMultipleFromTail(1);
 
-		if (timer->lastExecute + timer->interval <= currentTime)
+		runningTimer = timer;
+		bool repeat = !timer->cancelled && timer->Execute();
+		runningTimer = nullptr;
+		if (!repeat || timer->cancelled)
 		{
-			if (!timer->Execute())
-			{
-				delete timer;
-				timers.Remove(i);
-			}
-			else
-			{
-				timer->lastExecute = currentTime;
-			}
+			delete timer;
+			continue;
 		}
+		timer->nextExecute = currentTime + timer->interval;
+		PushTimer(timers, timer);
 	}
 }
 
 void ProcessTimers()
 {
-	ProcessTimerList(g_PersistentTimers);
-	ProcessTimerList(g_NonPersistentTimers);
+	f64 gameTime = g_pKZUtils->GetGlobals()->curtime;
+	f64 realTime = g_pKZUtils->GetGlobals()->realtime;
+
+	FOR_EACH_VEC(newTimers, i)
+	{
+		CTimerBase *timer = newTimers[i];
+		timer->nextExecute = timer->useRealTime ? realTime : gameTime;
+		PushTimer(timer->useRealTime ? realTimeTimers : gameTimeTimers, timer);
+	}
+	newTimers.RemoveAll();
+
+	ProcessTimerHeap(gameTimeTimers, gameTime);
+	ProcessTimerHeap(realTimeTimers, realTime);
+}
+
+internal void FreeNonPersistentTimers(CUtlVector<CTimerBase *> &timers, bool heap)
+{
+	FOR_EACH_VEC_BACK(timers, i)
+	{
+		if (!timers[i]->preserveMapChange)
+		{
+			delete timers[i];
+			timers.FastRemove(i);
+		}
+	}
+	if (heap)
+	{
+		std::make_heap(timers.Base(), timers.Base() + timers.Count(), FiresLater);
+	}
 }
 
 void RemoveNonPersistentTimers()
 {
-	g_NonPersistentTimers.PurgeAndDeleteElements();
+	FreeNonPersistentTimers(gameTimeTimers, true);
+	FreeNonPersistentTimers(realTimeTimers, true);
+	FreeNonPersistentTimers(newTimers, false);
+	if (runningTimer && !runningTimer->preserveMapChange)
+	{
+		runningTimer->cancelled = true;
+	}
+}
+
+void ScheduleTimer(CTimerBase *timer, bool preserveMapChange)
+{
+	timer->preserveMapChange = preserveMapChange;
+	timer->nextExecute = -1;
+	newTimers.AddToTail(timer);
+}
+
+void CancelTimer(CTimerBase *timer)
+{
+	timer->cancelled = true;
 }
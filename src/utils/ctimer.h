@@ -9,23 +9,87 @@
  * Credit to Szwagi
  */
 
+// Timers are small and come and go often, so they are recycled through a free list instead of the heap.
+// The pool is per binary, which works because a timer is always freed through its own virtual destructor.
+#define CTIMER_POOL_SLOT_SIZE   128
+#define CTIMER_POOL_CHUNK_SLOTS 64
+
+class CTimerPool
+{
+public:
+	static void *Alloc(size_t size)
+	{
+		if (size > CTIMER_POOL_SLOT_SIZE)
+		{
+			return ::operator new(size);
+		}
+		if (!freeSlots)
+		{
+			byte *chunk = static_cast<byte *>(::operator new(CTIMER_POOL_SLOT_SIZE * CTIMER_POOL_CHUNK_SLOTS));
+			for (u32 i = 0; i < CTIMER_POOL_CHUNK_SLOTS; i++)
+			{
+				Free(chunk + i * CTIMER_POOL_SLOT_SIZE, CTIMER_POOL_SLOT_SIZE);
+			}
+		}
+		FreeSlot *slot = freeSlots;
+		freeSlots = slot->next;
+		return slot;
+	}
+
+	static void Free(void *ptr, size_t size)
+	{
+		if (size > CTIMER_POOL_SLOT_SIZE)
+		{
+			::operator delete(ptr);
+			return;
+		}
+		FreeSlot *slot = static_cast<FreeSlot *>(ptr);
+		slot->next = freeSlots;
+		freeSlots = slot;
+	}
+
+private:
+	struct FreeSlot
+	{
+		FreeSlot *next;
+	};
+
+	static inline FreeSlot *freeSlots;
+};
+
 class CTimerBase
 {
 public:
 	CTimerBase(f64 initialInterval, bool useRealTime) : interval(initialInterval), useRealTime(useRealTime) {};
 
+	virtual ~CTimerBase() = default;
+
 	virtual bool Execute() = 0;
 
+	static void *operator new(size_t size)
+	{
+		return CTimerPool::Alloc(size);
+	}
+
+	static void operator delete(void *ptr, size_t size)
+	{
+		CTimerPool::Free(ptr, size);
+	}
+
 	f64 interval {};
-	f64 lastExecute = -1;
+	// Time of the next execution on the timer's clock, -1 until the scheduler picks it up.
+	f64 nextExecute = -1;
 	bool useRealTime {};
+	bool preserveMapChange = true;
+	// Cancelled timers are only freed once they come up in the scheduler, so cancelling is O(1).
+	bool cancelled {};
 };
 
 void ProcessTimers();
 void RemoveNonPersistentTimers();
-
-extern CUtlVector<CTimerBase *> g_PersistentTimers;
-extern CUtlVector<CTimerBase *> g_NonPersistentTimers;
+// Backends of KZUtils::AddTimer and KZUtils::RemoveTimer. A removed timer must not be used afterwards.
+void ScheduleTimer(CTimerBase *timer, bool preserveMapChange);
+void CancelTimer(CTimerBase *timer);
 
 template<typename... Args>
 class CTimer : public CTimerBase
@@ -0,0 +1,291 @@
+#pragma once
+#include "common.h"
+#include "entityhandle.h"
+
+// Sets up to this size live inside the object and are searched linearly.
+#define ENTITYHANDLESET_INLINE_SIZE 8
+
+/*
+ * Set of entity handles for the handful of triggers a player touches at once.
+ *
+ * Handles are kept sorted in one contiguous array (inline until it outgrows ENTITYHANDLESET_INLINE_SIZE), so that
+ * iterating is a plain array walk and two sets can be compared in a single merge pass, see Diff.
+ * Past the inline size, an open-addressed hash table is kept next to the array to answer HasElement in constant time.
+ */
+class EntityHandleSet
+{
+public:
+	EntityHandleSet() = default;
+	EntityHandleSet(const EntityHandleSet &) = delete;
+	EntityHandleSet &operator=(const EntityHandleSet &) = delete;
+
+	~EntityHandleSet()
+	{
+		this->Purge();
+	}
+
+	i32 Count() const
+	{
+		return this->count;
+	}
+
+	CEntityHandle operator[](i32 i) const
+	{
+		return this->Base()[i];
+	}
+
+	bool HasElement(CEntityHandle handle) const
+	{
+		if (this->table)
+		{
+			return this->FindSlot(handle.ToInt()) != -1;
+		}
+		const CEntityHandle *base = this->Base();
+		for (i32 i = 0; i < this->count; i++)
+		{
+			if (base[i] == handle)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Returns false if the handle was already in the set.
+	bool Insert(CEntityHandle handle)
+	{
+		u32 key = handle.ToInt();
+		i32 index = this->LowerBound(key);
+		CEntityHandle *base = this->Base();
+		if (index < this->count && base[index] == handle)
+		{
+			return false;
+		}
+		if (this->count == this->capacity)
+		{
+			this->Grow();
+			base = this->Base();
+		}
+		memmove(base + index + 1, base + index, (this->count - index) * sizeof(CEntityHandle));
+		base[index] = handle;
+		this->count++;
+
+		if (this->table && (u32)this->count * 2 <= this->tableMask + 1)
+		{
+			this->InsertSlot(key);
+		}
+		else if (this->count > ENTITYHANDLESET_INLINE_SIZE)
+		{
+			this->RebuildTable();
+		}
+		return true;
+	}
+
+	// Returns false if the handle wasn't in the set.
+	bool FindAndRemove(CEntityHandle handle)
+	{
+		u32 key = handle.ToInt();
+		i32 index = this->LowerBound(key);
+		CEntityHandle *base = this->Base();
+		if (index == this->count || base[index] != handle)
+		{
+			return false;
+		}
+		memmove(base + index, base + index + 1, (this->count - index - 1) * sizeof(CEntityHandle));
+		this->count--;
+
+		if (this->table)
+		{
+			if (this->count < ENTITYHANDLESET_INLINE_SIZE / 2)
+			{
+				this->FreeTable();
+			}
+			else
+			{
+				this->RemoveSlot(this->FindSlot(key));
+			}
+		}
+		return true;
+	}
+
+	void RemoveAll()
+	{
+		this->count = 0;
+		this->FreeTable();
+	}
+
+	void Purge()
+	{
+		this->RemoveAll();
+		delete[] this->heap;
+		this->heap = nullptr;
+		this->capacity = ENTITYHANDLESET_INLINE_SIZE;
+	}
+
+	// Walks both sets once, calling onlyInA/onlyInB for the handles that are only in one of them.
+	// The callbacks must not modify either set.
+	template<typename OnlyInA, typename OnlyInB>
+	static void Diff(const EntityHandleSet &a, const EntityHandleSet &b, OnlyInA onlyInA, OnlyInB onlyInB)
+	{
+		const CEntityHandle *baseA = a.Base();
+		const CEntityHandle *baseB = b.Base();
+		i32 i = 0;
+		i32 j = 0;
+		while (i < a.count && j < b.count)
+		{
+			u32 keyA = baseA[i].ToInt();
+			u32 keyB = baseB[j].ToInt();
+			if (keyA == keyB)
+			{
+				i++;
+				j++;
+			}
+			else if (keyA < keyB)
+			{
+				onlyInA(baseA[i++]);
+			}
+			else
+			{
+				onlyInB(baseB[j++]);
+			}
+		}
+		while (i < a.count)
+		{
+			onlyInA(baseA[i++]);
+		}
+		while (j < b.count)
+		{
+			onlyInB(baseB[j++]);
+		}
+	}
+
+private:
+	static constexpr u32 emptySlot = 0xFFFFFFFF;
+
+	CEntityHandle *Base()
+	{
+		return this->heap ? this->heap : this->inlineHandles;
+	}
+
+	const CEntityHandle *Base() const
+	{
+		return this->heap ? this->heap : this->inlineHandles;
+	}
+
+	// Index of the first handle that doesn't sort before key.
+	i32 LowerBound(u32 key) const
+	{
+		const CEntityHandle *base = this->Base();
+		i32 low = 0;
+		i32 high = this->count;
+		while (low < high)
+		{
+			i32 middle = (low + high) / 2;
+			if (base[middle].ToInt() < key)
+			{
+				low = middle + 1;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+		return low;
+	}
+
+	void Grow()
+	{
+		i32 newCapacity = this->capacity * 2;
+		CEntityHandle *newHeap = new CEntityHandle[newCapacity];
+		memcpy(newHeap, this->Base(), this->count * sizeof(CEntityHandle));
+		delete[] this->heap;
+		this->heap = newHeap;
+		this->capacity = newCapacity;
+	}
+
+	u32 HomeSlot(u32 key) const
+	{
+		return (key * 2654435761u) & this->tableMask;
+	}
+
+	i32 FindSlot(u32 key) const
+	{
+		for (u32 slot = this->HomeSlot(key);; slot = (slot + 1) & this->tableMask)
+		{
+			if (this->table[slot] == key)
+			{
+				return slot;
+			}
+			if (this->table[slot] == emptySlot)
+			{
+				return -1;
+			}
+		}
+	}
+
+	void InsertSlot(u32 key)
+	{
+		u32 slot = this->HomeSlot(key);
+		while (this->table[slot] != emptySlot)
+		{
+			slot = (slot + 1) & this->tableMask;
+		}
+		this->table[slot] = key;
+	}
+
+	// Backward shift deletion, so that probing never needs tombstones.
+	void RemoveSlot(u32 slot)
+	{
+		u32 next = slot;
+		while (true)
+		{
+			next = (next + 1) & this->tableMask;
+			u32 key = this->table[next];
+			if (key == emptySlot)
+			{
+				break;
+			}
+			u32 home = this->HomeSlot(key);
+			// Leave the key where it is if its home slot lies cyclically in (slot, next].
+			if (slot <= next ? (slot < home && home <= next) : (slot < home || home <= next))
+			{
+				continue;
+			}
+			this->table[slot] = key;
+			slot = next;
+		}
+		this->table[slot] = emptySlot;
+	}
+
+	void RebuildTable()
+	{
+		u32 size = ENTITYHANDLESET_INLINE_SIZE * 4;
+		while (size < (u32)this->count * 4)
+		{
+			size *= 2;
+		}
+		this->FreeTable();
+		this->table = new u32[size];
+		this->tableMask = size - 1;
+		memset(this->table, 0xFF, size * sizeof(u32));
+		const CEntityHandle *base = this->Base();
+		for (i32 i = 0; i < this->count; i++)
+		{
+			this->InsertSlot(base[i].ToInt());
+		}
+	}
+
+	void FreeTable()
+	{
+		delete[] this->table;
+		this->table = nullptr;
+		this->tableMask = 0;
+	}
+
+	CEntityHandle inlineHandles[ENTITYHANDLESET_INLINE_SIZE];
+	CEntityHandle *heap {};
+	i32 capacity = ENTITYHANDLESET_INLINE_SIZE;
+	i32 count {};
+	u32 *table {};
+	u32 tableMask {};
+};
@@ -0,0 +1,53 @@
+#include "entitykind.h"
+
+#include "tier0/memdbgon.h"
+
+EntityKind utils::ClassifyEntity(CEntityInstance *entity)
+{
+	const char *classname = entity->GetClassname();
+	EntityKind kind = EntityKind_Other;
+	if (!V_stricmp(classname, "player"))
+	{
+		kind = EntityKind_Player;
+	}
+	else if (!V_stricmp(classname, "cs_player_controller"))
+	{
+		kind = EntityKind_PlayerController;
+	}
+	else if (!V_stricmp(classname, "trigger_multiple"))
+	{
+		if (entity->m_pEntity->NameMatches("timer_startzone"))
+		{
+			kind = EntityKind_StartZone;
+		}
+		else if (entity->m_pEntity->NameMatches("timer_endzone"))
+		{
+			kind = EntityKind_EndZone;
+		}
+		else
+		{
+			kind = EntityKind_TriggerMultiple;
+		}
+	}
+	else if (V_strstr(classname, "trigger_"))
+	{
+		kind = EntityKind_Trigger;
+	}
+
+	const CEntityHandle &handle = entity->m_pEntity->m_EHandle;
+	u32 index = handle.GetEntryIndex();
+	if (index < ENTITYKIND_MAX_ENTITIES)
+	{
+		entityKinds[index] = {handle, kind};
+	}
+	return kind;
+}
+
+void utils::ForgetEntityKind(CEntityInstance *entity)
+{
+	u32 index = entity->m_pEntity->m_EHandle.GetEntryIndex();
+	if (index < ENTITYKIND_MAX_ENTITIES)
+	{
+		entityKinds[index] = {};
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "common.h"
+#include "entityinstance.h"
+
+// What the plugin cares about for an entity, so that hot paths don't have to look at classnames.
+enum EntityKind : u8
+{
+	// Not classified yet.
+	EntityKind_Unknown,
+	EntityKind_Other,
+	EntityKind_Player,
+	EntityKind_PlayerController,
+	// Everything below is a trigger_*.
+	EntityKind_Trigger,
+	EntityKind_TriggerMultiple,
+	EntityKind_StartZone,
+	EntityKind_EndZone,
+};
+
+// Covers networked and server only entity indices.
+#define ENTITYKIND_MAX_ENTITIES (1 << 15)
+
+namespace utils
+{
+	struct EntityKindEntry
+	{
+		// The entity the kind belongs to, a different serial means the index got reused.
+		CEntityHandle handle;
+		EntityKind kind;
+	};
+
+	inline EntityKindEntry entityKinds[ENTITYKIND_MAX_ENTITIES];
+
+	// Looks at the classname (and name for zones) and stores the result, called when an entity spawns.
+	EntityKind ClassifyEntity(CEntityInstance *entity);
+	void ForgetEntityKind(CEntityInstance *entity);
+
+	inline EntityKind GetEntityKind(CEntityInstance *entity)
+	{
+		const CEntityHandle &handle = entity->m_pEntity->m_EHandle;
+		u32 index = handle.GetEntryIndex();
+		if (index < ENTITYKIND_MAX_ENTITIES && entityKinds[index].handle == handle && entityKinds[index].kind != EntityKind_Unknown)
+		{
+			return entityKinds[index].kind;
+		}
+		// Spawned before we started listening.
+		return ClassifyEntity(entity);
+	}
+
+	inline bool IsTriggerKind(EntityKind kind)
+	{
+		return kind >= EntityKind_Trigger;
+	}
+} // namespace utils
@@ -5,6 +5,10 @@
 #include <cstdint>
 #include "gameconfig.h"
 #include "addresses.h"
+#include "sigscanner.h"
+#include "filesystem.h"
+
+#include <algorithm>
 
 CGameConfig::CGameConfig(const std::string &gameDir, const std::string &path)
 {
@@ -68,6 +72,50 @@ bool CGameConfig::Init(IFileSystem *filesystem, char *conf_error, int conf_error
 		snprintf(conf_error, conf_error_size, "Failed to find game: %s", m_szGameDir.c_str());
 		return false;
 	}
+	return this->ResolveKeys(conf_error, conf_error_size);
+}
+
+bool CGameConfig::ResolveKeys(char *conf_error, int conf_error_size)
+{
+	std::string missing;
+	for (GameDataKey *key = GameDataKey::first; key; key = key->next)
+	{
+		bool found = false;
+		switch (key->type)
+		{
+			case GameDataKey_Offset:
+			{
+				s_resolvedOffsets[key->index] = this->GetOffset(key->name);
+				found = s_resolvedOffsets[key->index] != -1;
+				break;
+			}
+			case GameDataKey_Signature:
+			{
+				s_resolvedSignatures[key->index] = this->GetSignature(key->name);
+				found = s_resolvedSignatures[key->index] && s_resolvedSignatures[key->index][0];
+				break;
+			}
+			case GameDataKey_Patch:
+			{
+				s_resolvedPatches[key->index] = this->GetPatch(key->name);
+				found = s_resolvedPatches[key->index] && s_resolvedPatches[key->index][0];
+				break;
+			}
+			default:
+			{
+				break;
+			}
+		}
+		if (!found)
+		{
+			missing += missing.empty() ? key->name : std::string(", ") + key->name;
+		}
+	}
+	if (!missing.empty())
+	{
+		snprintf(conf_error, conf_error_size, "Missing gamedata keys: %s", missing.c_str());
+		return false;
+	}
 	return true;
 }
 
@@ -199,13 +247,23 @@ void *CGameConfig::ResolveSignature(const char *name)
 			return nullptr;
 		}
 
-		size_t iLength = 0;
-		byte *pSignature = HexToByte(signature, iLength);
-		if (!pSignature)
+		auto scanned = m_umScannedSignatures.find(name);
+		if (scanned != m_umScannedSignatures.end())
 		{
-			return nullptr;
+			address = scanned->second.address;
+			error = scanned->second.error;
+		}
+		else
+		{
+			size_t iLength = 0;
+			byte *pSignature = HexToByte(signature, iLength);
+			if (!pSignature)
+			{
+				return nullptr;
+			}
+			address = (*module)->FindSignature(pSignature, iLength, error);
+			delete[] pSignature;
 		}
-		address = (*module)->FindSignature(pSignature, iLength, error);
 		if (error == SIG_FOUND_MULTIPLE)
 		{
 			Warning("Multiple addresses found for %s, defaulting to nullptr\n", name);
@@ -221,6 +279,164 @@ void *CGameConfig::ResolveSignature(const char *name)
 	return address;
 }
 
+static uint64_t HashSignature(const std::string &signature)
+{
+	// FNV-1a, only used to notice that a cached signature changed in the gamedata.
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : signature)
+	{
+		hash = (hash ^ (uint8_t)c) * 1099511628211ull;
+	}
+	return hash;
+}
+
+void CGameConfig::ScanSignatures(IFileSystem *filesystem, const char *cachePath)
+{
+	struct SignatureEntry
+	{
+		const std::string *name;
+		std::vector<byte> bytes;
+		uint64_t hash;
+		// Index in the module's scanner, -1 if the cache had it.
+		int pattern;
+	};
+
+	struct ModuleScan
+	{
+		CModule *module;
+		SignatureScanner scanner;
+		std::vector<SignatureEntry> entries;
+	};
+
+	std::vector<ModuleScan> scans;
+	for (const auto &[name, signature] : m_umSignatures)
+	{
+		if (signature.empty() || signature[0] == '@')
+		{
+			continue;
+		}
+		CModule **module = this->GetModule(name.c_str());
+		if (!module || !(*module))
+		{
+			continue;
+		}
+		size_t iLength = 0;
+		byte *pSignature = HexToByte(signature.c_str(), iLength);
+		if (!pSignature)
+		{
+			continue;
+		}
+		auto scan = std::find_if(scans.begin(), scans.end(), [&](const ModuleScan &other) { return other.module == *module; });
+		if (scan == scans.end())
+		{
+			scan = scans.insert(scans.end(), ModuleScan {*module});
+		}
+		scan->entries.push_back({&name, std::vector<byte>(pSignature, pSignature + iLength), HashSignature(signature), -1});
+		delete[] pSignature;
+	}
+
+	KeyValues *cache = new KeyValues("SignatureCache");
+	// A missing or broken cache just means everything gets scanned.
+	if (!cache->LoadFromFile(filesystem, cachePath, nullptr))
+	{
+		cache->Clear();
+	}
+	bool cacheChanged = false;
+
+	for (ModuleScan &scan : scans)
+	{
+		// Functions only live in .text, no need to look at the rest of the image.
+		Section *text = scan.module->GetSection(".text");
+		byte *base = (byte *)(text ? text->m_pBase : scan.module->m_base);
+		size_t size = text ? text->m_iSize : scan.module->m_size;
+
+		// Cached addresses are only trusted for the exact same binary.
+		KeyValues *moduleCache = nullptr;
+		std::string buildId;
+		if (GetModuleBuildId(scan.module->m_hModule, buildId))
+		{
+			std::string path = std::string(scan.module->m_pszPath) + scan.module->m_pszModule;
+			moduleCache = cache->FindKey(scan.module->m_pszModule, true);
+			if (strcmp(moduleCache->GetString("path"), path.c_str()) != 0 || strcmp(moduleCache->GetString("build_id"), buildId.c_str()) != 0)
+			{
+				moduleCache->Clear();
+				moduleCache->SetString("path", path.c_str());
+				moduleCache->SetString("build_id", buildId.c_str());
+				cacheChanged = true;
+			}
+		}
+
+		for (SignatureEntry &entry : scan.entries)
+		{
+			KeyValues *entryCache = moduleCache ? moduleCache->FindKey(entry.name->c_str()) : nullptr;
+			if (entryCache && strtoull(entryCache->GetString("hash"), nullptr, 16) == entry.hash)
+			{
+				// Cheap check that the cached offset still points at the signature.
+				uint64_t offset = strtoull(entryCache->GetString("offset"), nullptr, 16);
+				if (offset < size && size - offset >= entry.bytes.size()
+					&& SignatureScanner::MatchesAt(base + offset, entry.bytes.data(), entry.bytes.size()))
+				{
+					m_umScannedSignatures[*entry.name] = {base + offset, SIG_OK};
+					continue;
+				}
+			}
+			entry.pattern = scan.scanner.AddPattern(entry.bytes.data(), entry.bytes.size());
+		}
+
+		if (!scan.scanner.GetPatternCount())
+		{
+			continue;
+		}
+		scan.scanner.Scan(base, size, SignatureScanner::GetDefaultThreadCount(size));
+		for (SignatureEntry &entry : scan.entries)
+		{
+			if (entry.pattern == -1)
+			{
+				continue;
+			}
+			ScannedSignature &result = m_umScannedSignatures[*entry.name];
+			result.address = scan.scanner.GetResult(entry.pattern, result.error);
+			if (!moduleCache)
+			{
+				continue;
+			}
+			// Only unique matches are worth remembering.
+			KeyValues *entryCache = moduleCache->FindKey(entry.name->c_str(), result.error == SIG_OK);
+			if (result.error == SIG_OK)
+			{
+				char value[32];
+				V_snprintf(value, sizeof(value), "%llx", (unsigned long long)entry.hash);
+				entryCache->SetString("hash", value);
+				V_snprintf(value, sizeof(value), "%llx", (unsigned long long)((byte *)result.address - base));
+				entryCache->SetString("offset", value);
+				cacheChanged = true;
+			}
+			else if (entryCache)
+			{
+				moduleCache->RemoveSubKey(entryCache);
+				entryCache->deleteThis();
+				cacheChanged = true;
+			}
+		}
+	}
+
+	if (cacheChanged)
+	{
+		std::string directory = cachePath;
+		size_t slash = directory.find_last_of("/\\");
+		if (slash != std::string::npos)
+		{
+			directory.resize(slash);
+			filesystem->CreateDirHierarchy(directory.c_str(), "GAME");
+		}
+		if (!cache->SaveToFile(filesystem, cachePath, "GAME"))
+		{
+			Warning("Failed to save signature cache %s\n", cachePath);
+		}
+	}
+	delete cache;
+}
+
 // Static functions
 std::string CGameConfig::GetDirectoryName(const std::string &directoryPathInput)
 {
@@ -7,6 +7,39 @@
 
 class CModule;
 
+// Maximum number of keys of one type declared in a single binary.
+#define GAMEDATA_MAX_KEYS 64
+
+enum GameDataKeyType
+{
+	GameDataKey_Offset,
+	GameDataKey_Signature,
+	GameDataKey_Patch,
+	GameDataKey_Count
+};
+
+// Gamedata entry looked up once by CGameConfig::ResolveKeys instead of by name on every use.
+// Keys must be globals: each one links itself into a list and takes the next slot of its type.
+// Every binary gets its own list and slots, so each binary resolves its own keys.
+class GameDataKey
+{
+public:
+	GameDataKey(GameDataKeyType type, const char *name) : type(type), name(name), next(GameDataKey::first)
+	{
+		GameDataKey::first = this;
+		this->index = GameDataKey::counts[type]++;
+		assert(this->index < GAMEDATA_MAX_KEYS);
+	}
+
+	GameDataKeyType type;
+	const char *name;
+	int index;
+	GameDataKey *next;
+
+	static inline GameDataKey *first;
+	static inline int counts[GameDataKey_Count];
+};
+
 class CGameConfig
 {
 public:
@@ -14,16 +47,39 @@ public:
 	~CGameConfig();
 
 	bool Init(IFileSystem *filesystem, char *conf_error, int conf_error_size);
+	// Fills the resolved arrays for every key declared in the calling binary, reporting all missing keys at once.
+	// Init does this for the core plugin, mode and style plugins call it on the game config they get from it.
+	bool ResolveKeys(char *conf_error, int conf_error_size);
 	const std::string GetPath();
 	const char *GetLibrary(const std::string &name);
 	const char *GetSignature(const std::string &name);
 	const char *GetSymbol(const char *name);
 	const char *GetPatch(const std::string &name);
 	int GetOffset(const std::string &name);
+
+	int GetOffset(const GameDataKey &key)
+	{
+		return s_resolvedOffsets[key.index];
+	}
+
+	const char *GetSignature(const GameDataKey &key)
+	{
+		return s_resolvedSignatures[key.index];
+	}
+
+	const char *GetPatch(const GameDataKey &key)
+	{
+		return s_resolvedPatches[key.index];
+	}
+
 	void *GetAddress(const std::string &name, void *engine, void *server, char *error, int maxlen);
 	CModule **GetModule(const char *name);
 	bool IsSymbol(const char *name);
 	void *ResolveSignature(const char *name);
+	// Finds every signature of the gamedata in one pass per module, so that ResolveSignature doesn't scan each time.
+	// Offsets found before are read from cachePath and only checked against the signature bytes, as long as the module
+	// build is the same. Requires the modules to be initialized.
+	void ScanSignatures(IFileSystem *filesystem, const char *cachePath);
 	static std::string GetDirectoryName(const std::string &directoryPathInput);
 	static int HexStringToUint8Array(const char *hexString, uint8_t *byteArray, size_t maxBytes);
 	static byte *HexToByte(const char *src, size_t &length);
@@ -37,4 +93,39 @@ private:
 	std::unordered_map<std::string, void *> m_umAddresses;
 	std::unordered_map<std::string, std::string> m_umLibraries;
 	std::unordered_map<std::string, std::string> m_umPatches;
+
+	struct ScannedSignature
+	{
+		void *address;
+		int error;
+	};
+
+	std::unordered_map<std::string, ScannedSignature> m_umScannedSignatures;
+
+	// Per binary, indexed by GameDataKey::index.
+	static inline int s_resolvedOffsets[GAMEDATA_MAX_KEYS];
+	static inline const char *s_resolvedSignatures[GAMEDATA_MAX_KEYS];
+	static inline const char *s_resolvedPatches[GAMEDATA_MAX_KEYS];
 };
+
+// Keys used by the plugins, declared here so that each binary registers the same set.
+namespace gamedata
+{
+	inline GameDataKey gameEntitySystem(GameDataKey_Offset, "GameEntitySystem");
+	inline GameDataKey gameEventManager(GameDataKey_Offset, "GameEventManager");
+	inline GameDataKey isEntityPawn(GameDataKey_Offset, "IsEntityPawn");
+	inline GameDataKey isEntityController(GameDataKey_Offset, "IsEntityController");
+	inline GameDataKey collisionRulesChanged(GameDataKey_Offset, "CollisionRulesChanged");
+	inline GameDataKey startTouch(GameDataKey_Offset, "StartTouch");
+	inline GameDataKey touch(GameDataKey_Offset, "Touch");
+	inline GameDataKey endTouch(GameDataKey_Offset, "EndTouch");
+	inline GameDataKey teleport(GameDataKey_Offset, "Teleport");
+	inline GameDataKey respawn(GameDataKey_Offset, "Respawn");
+	inline GameDataKey commitSuicide(GameDataKey_Offset, "CommitSuicide");
+	inline GameDataKey controllerChangeTeam(GameDataKey_Offset, "ControllerChangeTeam");
+	inline GameDataKey controllerRespawn(GameDataKey_Offset, "ControllerRespawn");
+	inline GameDataKey quietPlayerSlot(GameDataKey_Offset, "QuietPlayerSlot");
+	inline GameDataKey clientOffset(GameDataKey_Offset, "ClientOffset");
+	inline GameDataKey ackOffset(GameDataKey_Offset, "ACKOffset");
+	inline GameDataKey usercmdOffset(GameDataKey_Offset, "UsercmdOffset");
+} // namespace gamedata
@@ -42,4 +42,5 @@ bool InitGameSystems()
 GS_EVENT_MEMBER(CGameSystem, ServerGamePostSimulate)
 {
 	ProcessTimers();
+	utils::FlushPrints();
 }
@@ -6,6 +6,8 @@
 #include "kz/quiet/kz_quiet.h"
 #include "kz/timer/kz_timer.h"
 #include "utils/utils.h"
+#include "utils/entitykind.h"
+#include "utils/triggerindex.h"
 #include "entityclass.h"
 
 class GameSessionConfiguration_t
@@ -59,6 +61,11 @@ SH_DECL_MANUALHOOK1_void(StartTouch, 0, 0, 0, CBaseEntity2 *);
 SH_DECL_MANUALHOOK1_void(Touch, 0, 0, 0, CBaseEntity2 *);
 SH_DECL_MANUALHOOK1_void(EndTouch, 0, 0, 0, CBaseEntity2 *);
 
+// Vtables that already have the touch hooks, the hooks apply to every entity of that class.
+internal CUtlVector<void *> hookedVTables;
+// Entity system our listener is registered to and whose entity list has been walked.
+internal CGameEntitySystem *listenedEntitySystem;
+
 internal int changeTeamHook;
 SH_DECL_MANUALHOOK1_void(ChangeTeam, 0, 0, 0, int);
 
@@ -66,11 +73,11 @@ SH_DECL_MANUALHOOK3_void(Teleport, 0, 0, 0, const Vector *, const QAngle *, cons
 
 void hooks::Initialize()
 {
-	SH_MANUALHOOK_RECONFIGURE(StartTouch, g_pGameConfig->GetOffset("StartTouch"), 0, 0);
-	SH_MANUALHOOK_RECONFIGURE(Touch, g_pGameConfig->GetOffset("Touch"), 0, 0);
-	SH_MANUALHOOK_RECONFIGURE(EndTouch, g_pGameConfig->GetOffset("EndTouch"), 0, 0);
-	SH_MANUALHOOK_RECONFIGURE(Teleport, g_pGameConfig->GetOffset("Teleport"), 0, 0);
-	SH_MANUALHOOK_RECONFIGURE(ChangeTeam, g_pGameConfig->GetOffset("ControllerChangeTeam"), 0, 0);
+	SH_MANUALHOOK_RECONFIGURE(StartTouch, g_pGameConfig->GetOffset(gamedata::startTouch), 0, 0);
+	SH_MANUALHOOK_RECONFIGURE(Touch, g_pGameConfig->GetOffset(gamedata::touch), 0, 0);
+	SH_MANUALHOOK_RECONFIGURE(EndTouch, g_pGameConfig->GetOffset(gamedata::endTouch), 0, 0);
+	SH_MANUALHOOK_RECONFIGURE(Teleport, g_pGameConfig->GetOffset(gamedata::teleport), 0, 0);
+	SH_MANUALHOOK_RECONFIGURE(ChangeTeam, g_pGameConfig->GetOffset(gamedata::controllerChangeTeam), 0, 0);
 
 	SH_ADD_HOOK(ISource2GameClients, ClientCommand, g_pSource2GameClients, SH_STATIC(Hook_ClientCommand), false);
 	SH_ADD_HOOK(ISource2Server, GameFrame, interfaces::pServer, SH_STATIC(Hook_GameFrame), false);
@@ -96,66 +103,85 @@ void hooks::Cleanup()
 	SH_REMOVE_HOOK(ICvar, DispatchConCommand, g_pCVar, SH_STATIC(Hook_DispatchConCommand), false);
 	SH_REMOVE_HOOK(IGameEventSystem, PostEventAbstract, interfaces::pGameEventSystem, SH_STATIC(Hook_PostEvent), false);
 	SH_REMOVE_HOOK_ID(changeTeamHook);
+	FOR_EACH_VEC(hooks::entityTouchHooks, i)
+	{
+		SH_REMOVE_HOOK_ID(hooks::entityTouchHooks[i]);
+	}
+	hooks::entityTouchHooks.Purge();
+	hookedVTables.Purge();
+	if (listenedEntitySystem == GameEntitySystem() && GameEntitySystem())
+	{
+		GameEntitySystem()->RemoveListenerEntity(&entityListener);
+	}
+	listenedEntitySystem = nullptr;
+}
+
+internal void ClearTouchLists(MovementPlayer *player)
+{
+	player->pendingEndTouchTriggers.RemoveAll();
+	player->pendingStartTouchTriggers.RemoveAll();
+	player->touchedTriggers.RemoveAll();
 }
 
 internal void AddEntityHooks(CBaseEntity2 *entity)
 {
-	if (!V_stricmp(entity->GetClassname(), "cs_player_controller") && !changeTeamHook)
+	EntityKind kind = utils::GetEntityKind(entity);
+	if (kind == EntityKind_PlayerController && !changeTeamHook)
 	{
 		changeTeamHook = SH_ADD_MANUALVPHOOK(ChangeTeam, entity, SH_STATIC(Hook_OnChangeTeamPost), true);
 	}
-	else if (V_strstr(entity->GetClassname(), "trigger_") || !V_stricmp(entity->GetClassname(), "player"))
+	else if (utils::IsTriggerKind(kind) || kind == EntityKind_Player)
 	{
-		hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALHOOK(StartTouch, entity, SH_STATIC(OnStartTouch), false));
-		hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALHOOK(Touch, entity, SH_STATIC(OnTouch), false));
-		hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALHOOK(EndTouch, entity, SH_STATIC(OnEndTouch), false));
-		hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALHOOK(StartTouch, entity, SH_STATIC(OnStartTouchPost), true));
-		hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALHOOK(Touch, entity, SH_STATIC(OnTouchPost), true));
-		hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALHOOK(EndTouch, entity, SH_STATIC(OnEndTouchPost), true));
-		CCSPlayerPawn *pawn = static_cast<CCSPlayerPawn *>(entity);
-		if (!V_stricmp(entity->GetClassname(), "player") && g_pPlayerManager->ToPlayer(pawn))
+		void *vtable = *(void **)entity;
+		if (!hookedVTables.HasElement(vtable))
+		{
+			hookedVTables.AddToTail(vtable);
+			hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALVPHOOK(StartTouch, entity, SH_STATIC(OnStartTouch), false));
+			hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALVPHOOK(Touch, entity, SH_STATIC(OnTouch), false));
+			hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALVPHOOK(EndTouch, entity, SH_STATIC(OnEndTouch), false));
+			hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALVPHOOK(StartTouch, entity, SH_STATIC(OnStartTouchPost), true));
+			hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALVPHOOK(Touch, entity, SH_STATIC(OnTouchPost), true));
+			hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALVPHOOK(EndTouch, entity, SH_STATIC(OnEndTouchPost), true));
+			// Players to track teleports, triggers so that the trigger index can stop trusting their indexed bounds.
+			hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALVPHOOK(Teleport, entity, SH_STATIC(OnTeleport), false));
+		}
+		MovementPlayer *player = kind == EntityKind_Player ? g_pPlayerManager->ToPlayer(static_cast<CCSPlayerPawn *>(entity)) : nullptr;
+		if (player)
 		{
-			hooks::entityTouchHooks.AddToTail(SH_ADD_MANUALHOOK(Teleport, pawn, SH_STATIC(OnTeleport), false));
-			g_pPlayerManager->ToPlayer(pawn)->pendingEndTouchTriggers.RemoveAll();
-			g_pPlayerManager->ToPlayer(pawn)->pendingStartTouchTriggers.RemoveAll();
-			g_pPlayerManager->ToPlayer(pawn)->touchedTriggers.RemoveAll();
+			ClearTouchLists(player);
 		}
 	}
 }
 
+// The class hooks stay in place, only forget the touches involving this entity.
 internal void RemoveEntityHooks(CBaseEntity2 *entity)
 {
-	if (V_strstr(entity->GetClassname(), "trigger_") || !V_stricmp(entity->GetClassname(), "player"))
-	{
-		SH_REMOVE_MANUALHOOK(StartTouch, entity, SH_STATIC(OnStartTouch), false);
-		SH_REMOVE_MANUALHOOK(Touch, entity, SH_STATIC(OnTouch), false);
-		SH_REMOVE_MANUALHOOK(EndTouch, entity, SH_STATIC(OnEndTouch), false);
-		SH_REMOVE_MANUALHOOK(StartTouch, entity, SH_STATIC(OnStartTouchPost), true);
-		SH_REMOVE_MANUALHOOK(Touch, entity, SH_STATIC(OnTouchPost), true);
-		SH_REMOVE_MANUALHOOK(EndTouch, entity, SH_STATIC(OnEndTouchPost), true);
-		if (V_strstr(entity->GetClassname(), "trigger_"))
-		{
-			for (u32 i = 0; i <= MAXPLAYERS; i++)
-			{
-				g_pPlayerManager->players[i]->pendingEndTouchTriggers.FindAndRemove(entity->GetRefEHandle());
-				g_pPlayerManager->players[i]->pendingStartTouchTriggers.FindAndRemove(entity->GetRefEHandle());
-				g_pPlayerManager->players[i]->touchedTriggers.FindAndRemove(entity->GetRefEHandle());
-			}
-		}
-		else
+	EntityKind kind = utils::GetEntityKind(entity);
+	if (utils::IsTriggerKind(kind))
+	{
+		for (u32 i = 0; i <= MAXPLAYERS; i++)
 		{
-			SH_REMOVE_MANUALHOOK(Teleport, static_cast<CCSPlayerPawn *>(entity), SH_STATIC(OnTeleport), false);
+			g_pPlayerManager->players[i]->pendingEndTouchTriggers.FindAndRemove(entity->GetRefEHandle());
+			g_pPlayerManager->players[i]->pendingStartTouchTriggers.FindAndRemove(entity->GetRefEHandle());
+			g_pPlayerManager->players[i]->touchedTriggers.FindAndRemove(entity->GetRefEHandle());
 		}
 	}
 }
 
 void hooks::HookEntities()
 {
-	FOR_EACH_VEC(hooks::entityTouchHooks, i)
+	// Touches don't carry over to the new round.
+	for (u32 i = 0; i <= MAXPLAYERS; i++)
 	{
-		SH_REMOVE_HOOK_ID(hooks::entityTouchHooks[i]);
+		ClearTouchLists(g_pPlayerManager->players[i]);
 	}
-	hooks::entityTouchHooks.Purge();
+	// Entities spawned while listening are hooked by the listener, so the entity list only needs to be walked
+	// once for what existed before that.
+	if (listenedEntitySystem == GameEntitySystem())
+	{
+		return;
+	}
+	listenedEntitySystem = GameEntitySystem();
 	GameEntitySystem()->RemoveListenerEntity(&entityListener);
 	for (CEntityIdentity *entID = GameEntitySystem()->m_EntityList.m_pFirstActiveEntity; entID != NULL; entID = entID->m_pNext)
 	{
@@ -185,6 +211,7 @@ internal void Hook_GameFrame(bool simulating, bool bFirstTick, bool bLastTick)
 	{
 		entitySystemHook = SH_ADD_HOOK(CEntitySystem, Spawn, GameEntitySystem(), SH_STATIC(Hook_CEntitySystem_Spawn_Post), true);
 	}
+	triggers::Refresh();
 	RETURN_META(MRES_IGNORED);
 }
 
@@ -230,7 +257,9 @@ internal void Hook_ClientDisconnect(CPlayerSlot slot, ENetworkDisconnectionReaso
 	{
 		Warning("WARNING: Player pawn for slot %i not found!\n", slot.Get());
 	}
+	player->InvalidateEntityCache();
 	player->timerService->OnClientDisconnect();
+	player->recorderService->OnClientDisconnect();
 	RETURN_META(MRES_IGNORED);
 }
 
@@ -238,6 +267,9 @@ internal void Hook_StartupServer(const GameSessionConfiguration_t &config, ISour
 {
 	interfaces::pEngine->ServerCommand("exec cs2kz.cfg");
 	g_KZPlugin.AddonInit();
+	triggers::Clear();
+	// The new map's entity system can be allocated at the old address, walk it and listen to it again.
+	listenedEntitySystem = nullptr;
 }
 
 internal bool Hook_FireEvent(IGameEvent *event, bool bDontBroadcast)
@@ -250,8 +282,10 @@ internal bool Hook_FireEvent(IGameEvent *event, bool bDontBroadcast)
 			KZPlayer *player = g_pKZPlayerManager->ToPlayer(instance->GetEntityIndex());
 			if (player)
 			{
+				player->InvalidateEntityCache();
 				player->timerService->OnPlayerDeath();
 				player->quietService->SendFullUpdate();
+				player->quietService->UpdateHidersMask();
 			}
 		}
 		else if (V_stricmp(event->GetName(), "round_start") == 0)
@@ -259,6 +293,7 @@ internal bool Hook_FireEvent(IGameEvent *event, bool bDontBroadcast)
 			interfaces::pEngine->ServerCommand("sv_full_alltalk 1");
 			KZTimerService::OnRoundStart();
 			hooks::HookEntities();
+			triggers::Rebuild();
 		}
 		else if (V_stricmp(event->GetName(), "player_team") == 0)
 		{
@@ -272,7 +307,9 @@ internal bool Hook_FireEvent(IGameEvent *event, bool bDontBroadcast)
 				KZPlayer *player = g_pKZPlayerManager->ToPlayer(instance->GetEntityIndex());
 				if (player)
 				{
+					player->InvalidateEntityCache();
 					player->timerService->OnPlayerSpawn();
+					player->quietService->UpdateHidersMask();
 				}
 			}
 		}
@@ -298,7 +335,7 @@ internal void OnStartTouch(CBaseEntity2 *pOther)
 	CBaseEntity2 *pThis = META_IFACEPTR(CBaseEntity2);
 	CCSPlayerPawn *pawn = NULL;
 	CBaseTrigger *trigger = NULL;
-	if (!V_stricmp(pThis->GetClassname(), "player"))
+	if (utils::GetEntityKind(pThis) == EntityKind_Player)
 	{
 		pawn = static_cast<CCSPlayerPawn *>(pThis);
 		trigger = static_cast<CBaseTrigger *>(pOther);
@@ -308,7 +345,7 @@ internal void OnStartTouch(CBaseEntity2 *pOther)
 		pawn = static_cast<CCSPlayerPawn *>(pOther);
 		trigger = static_cast<CBaseTrigger *>(pThis);
 	}
-	if (V_stricmp(pawn->GetClassname(), "player") != 0 || !V_strstr(trigger->GetClassname(), "trigger_"))
+	if (utils::GetEntityKind(pawn) != EntityKind_Player || !utils::IsTriggerKind(utils::GetEntityKind(trigger)))
 	{
 		RETURN_META(MRES_IGNORED);
 	}
@@ -327,12 +364,12 @@ internal void OnStartTouch(CBaseEntity2 *pOther)
 	// StartTouch is a two way interaction. Are we waiting for this trigger?
 	if (player->pendingStartTouchTriggers.HasElement(trigger->GetRefEHandle()))
 	{
-		player->touchedTriggers.AddToTail(trigger->GetRefEHandle());
+		player->touchedTriggers.Insert(trigger->GetRefEHandle());
 		player->pendingStartTouchTriggers.FindAndRemove(trigger->GetRefEHandle());
 		RETURN_META(MRES_IGNORED);
 	}
 	// Must be a new interaction!
-	player->pendingStartTouchTriggers.AddToTail(trigger->GetRefEHandle());
+	player->pendingStartTouchTriggers.Insert(trigger->GetRefEHandle());
 	RETURN_META(MRES_IGNORED);
 }
 
@@ -341,7 +378,7 @@ internal void OnTouch(CBaseEntity2 *pOther)
 	CBaseEntity2 *pThis = META_IFACEPTR(CBaseEntity2);
 	CCSPlayerPawn *pawn = NULL;
 	CBaseTrigger *trigger = NULL;
-	if (!V_stricmp(pThis->GetClassname(), "player"))
+	if (utils::GetEntityKind(pThis) == EntityKind_Player)
 	{
 		pawn = static_cast<CCSPlayerPawn *>(pThis);
 		trigger = static_cast<CBaseTrigger *>(pOther);
@@ -351,7 +388,7 @@ internal void OnTouch(CBaseEntity2 *pOther)
 		pawn = static_cast<CCSPlayerPawn *>(pOther);
 		trigger = static_cast<CBaseTrigger *>(pThis);
 	}
-	if (V_stricmp(pawn->GetClassname(), "player") != 0 || !V_strstr(trigger->GetClassname(), "trigger_"))
+	if (utils::GetEntityKind(pawn) != EntityKind_Player || !utils::IsTriggerKind(utils::GetEntityKind(trigger)))
 	{
 		RETURN_META(MRES_IGNORED);
 	}
@@ -381,7 +418,7 @@ internal void OnEndTouch(CBaseEntity2 *pOther)
 	CBaseEntity2 *pThis = META_IFACEPTR(CBaseEntity2);
 	CCSPlayerPawn *pawn = NULL;
 	CBaseTrigger *trigger = NULL;
-	if (!V_stricmp(pThis->GetClassname(), "player"))
+	if (utils::GetEntityKind(pThis) == EntityKind_Player)
 	{
 		pawn = static_cast<CCSPlayerPawn *>(pThis);
 		trigger = static_cast<CBaseTrigger *>(pOther);
@@ -391,7 +428,7 @@ internal void OnEndTouch(CBaseEntity2 *pOther)
 		pawn = static_cast<CCSPlayerPawn *>(pOther);
 		trigger = static_cast<CBaseTrigger *>(pThis);
 	}
-	if (V_stricmp(pawn->GetClassname(), "player") != 0 || !V_strstr(trigger->GetClassname(), "trigger_"))
+	if (utils::GetEntityKind(pawn) != EntityKind_Player || !utils::IsTriggerKind(utils::GetEntityKind(trigger)))
 	{
 		RETURN_META(MRES_IGNORED);
 	}
@@ -408,7 +445,7 @@ internal void OnEndTouch(CBaseEntity2 *pOther)
 	}
 	if (player->touchedTriggers.FindAndRemove(trigger->GetRefEHandle()))
 	{
-		player->pendingEndTouchTriggers.AddToTail(trigger->GetRefEHandle());
+		player->pendingEndTouchTriggers.Insert(trigger->GetRefEHandle());
 		RETURN_META(MRES_IGNORED);
 	}
 	if (player->pendingEndTouchTriggers.FindAndRemove(trigger->GetRefEHandle()))
@@ -429,7 +466,7 @@ internal void OnStartTouchPost(CBaseEntity2 *pOther)
 	}
 
 	ignoreTouchEvent = false;
-	if (V_stricmp(pOther->GetClassname(), "player"))
+	if (utils::GetEntityKind(pOther) != EntityKind_Player)
 	{
 		RETURN_META(MRES_IGNORED);
 	}
@@ -440,17 +477,14 @@ internal void OnStartTouchPost(CBaseEntity2 *pOther)
 		RETURN_META(MRES_IGNORED);
 	}
 	CBaseEntity2 *pThis = META_IFACEPTR(CBaseEntity2);
-	if (player && !V_stricmp(pThis->GetClassname(), "trigger_multiple"))
+	EntityKind kind = utils::GetEntityKind(pThis);
+	if (kind == EntityKind_EndZone)
 	{
-		CBaseTrigger *trigger = static_cast<CBaseTrigger *>(pThis);
-		if (trigger->IsEndZone())
-		{
-			player->EndZoneStartTouch();
-		}
-		else if (trigger->IsStartZone())
-		{
-			player->StartZoneStartTouch();
-		}
+		player->EndZoneStartTouch();
+	}
+	else if (kind == EntityKind_StartZone)
+	{
+		player->StartZoneStartTouch();
 	}
 	RETURN_META(MRES_IGNORED);
 }
@@ -475,7 +509,7 @@ internal void OnEndTouchPost(CBaseEntity2 *pOther)
 	}
 
 	ignoreTouchEvent = false;
-	if (V_stricmp(pOther->GetClassname(), "player"))
+	if (utils::GetEntityKind(pOther) != EntityKind_Player)
 	{
 		RETURN_META(MRES_IGNORED);
 	}
@@ -486,7 +520,7 @@ internal void OnEndTouchPost(CBaseEntity2 *pOther)
 		RETURN_META(MRES_IGNORED);
 	}
 	CBaseEntity2 *pThis = META_IFACEPTR(CBaseEntity2);
-	if (player && !V_stricmp(pThis->GetClassname(), "trigger_multiple") && static_cast<CBaseTrigger *>(pThis)->IsStartZone())
+	if (utils::GetEntityKind(pThis) == EntityKind_StartZone)
 	{
 		player->StartZoneEndTouch();
 	}
@@ -496,29 +530,41 @@ internal void OnEndTouchPost(CBaseEntity2 *pOther)
 internal void OnTeleport(const Vector *newPosition, const QAngle *newAngles, const Vector *newVelocity)
 {
 	CBaseEntity2 *this_ = META_IFACEPTR(CBaseEntity2);
+	if (utils::IsTriggerKind(utils::GetEntityKind(this_)))
+	{
+		triggers::OnTriggerTeleported(this_);
+	}
 	// Just to be sure.
-	if (this_->IsPawn())
+	else if (this_->IsPawn())
 	{
 		MovementPlayer *player = g_pPlayerManager->ToPlayer(static_cast<CBasePlayerPawn *>(this_));
-		player->OnTeleport(newPosition, newAngles, newVelocity);
+		// The hook covers every pawn, including the ones without a controller.
+		if (player)
+		{
+			player->OnTeleport(newPosition, newAngles, newVelocity);
+		}
 	}
 	RETURN_META(MRES_IGNORED);
 }
 
 void EntListener::OnEntitySpawned(CEntityInstance *pEntity)
 {
-	if (V_strstr(pEntity->GetClassname(), "trigger_"))
+	if (utils::IsTriggerKind(utils::ClassifyEntity(pEntity)))
 	{
 		AddEntityHooks(static_cast<CBaseEntity2 *>(pEntity));
+		triggers::OnTriggerSpawned(static_cast<CBaseEntity2 *>(pEntity));
 	}
 }
 
 void EntListener::OnEntityDeleted(CEntityInstance *pEntity)
 {
-	if (V_strstr(pEntity->GetClassname(), "trigger_"))
+	g_pPlayerManager->OnEntityDeleted(pEntity);
+	if (utils::IsTriggerKind(utils::GetEntityKind(pEntity)))
 	{
 		RemoveEntityHooks(static_cast<CBaseEntity2 *>(pEntity));
+		triggers::OnTriggerDeleted(static_cast<CBaseEntity2 *>(pEntity));
 	}
+	utils::ForgetEntityKind(pEntity);
 }
 
 internal void Hook_OnChangeTeamPost(int team)
@@ -527,6 +573,7 @@ internal void Hook_OnChangeTeamPost(int team)
 	MovementPlayer *player = g_pPlayerManager->ToPlayer(controller);
 	if (player)
 	{
+		player->InvalidateEntityCache();
 		player->OnChangeTeamPost(team);
 	}
 }
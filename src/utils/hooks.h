@@ -5,9 +5,11 @@
 
 namespace hooks
 {
+	// Touch and teleport hooks, one set per hooked entity class.
 	inline CUtlVector<int> entityTouchHooks;
 
 	void Initialize();
 	void Cleanup();
+	// Resets touch lists for the new round, and hooks existing entities the first time an entity system is seen.
 	void HookEntities();
 } // namespace hooks
@@ -31,20 +31,34 @@ public:
 
 	void *FindNext(bool allowWildcard)
 	{
-		for (size_t i = 0; i < m_iSize; i++)
+		byte *pEnd = m_pBase + m_iSize;
+		bool bAnchored = !(allowWildcard && m_pSignature[0] == '\x2A');
+		while (m_iSigLength && m_pCurrent + m_iSigLength <= pEnd)
 		{
-			size_t Matches = 0;
-			while (*(m_pCurrent + i + Matches) == m_pSignature[Matches] || (allowWildcard && m_pSignature[Matches] == '\x2A'))
+			// Skip straight to the next occurrence of the first byte.
+			if (bAnchored)
 			{
-				Matches++;
-				if (Matches == m_iSigLength)
+				byte *pNext = (byte *)memchr(m_pCurrent, m_pSignature[0], pEnd - m_iSigLength + 1 - m_pCurrent);
+				if (!pNext)
 				{
-					m_pCurrent += i + 1;
-					return m_pCurrent - 1;
+					break;
 				}
+				m_pCurrent = pNext;
+			}
+
+			size_t Matches = 1;
+			while (Matches < m_iSigLength && (m_pCurrent[Matches] == m_pSignature[Matches] || (allowWildcard && m_pSignature[Matches] == '\x2A')))
+			{
+				Matches++;
+			}
+			m_pCurrent++;
+			if (Matches == m_iSigLength)
+			{
+				return m_pCurrent - 1;
 			}
 		}
 
+		m_pCurrent = pEnd;
 		return nullptr;
 	}
 
@@ -41,3 +41,6 @@ int GetModuleInformation(HINSTANCE module, void **base, size_t *length, std::vec
 #endif
 
 void Plat_WriteMemory(void *pPatchAddress, uint8_t *pPatch, int iPatchSize);
+
+// Identifies the exact build of a loaded module: the GNU build-id on Linux, the PE timestamp and image size on Windows.
+bool GetModuleBuildId(HINSTANCE module, std::string &buildId);
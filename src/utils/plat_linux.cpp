@@ -89,6 +89,66 @@ int GetModuleInformation(HINSTANCE hModule, void **base, size_t *length, std::ve
 	return 0;
 }
 
+struct BuildIdSearch
+{
+	ElfW(Addr) address; // in
+	std::string *buildId; // out
+};
+
+static int FindBuildIdNote(dl_phdr_info *info, size_t size, void *data)
+{
+	BuildIdSearch *search = static_cast<BuildIdSearch *>(data);
+	if (info->dlpi_addr != search->address)
+	{
+		return 0;
+	}
+
+	for (auto i = 0; i < info->dlpi_phnum; ++i)
+	{
+		const ElfW(Phdr) &phdr = info->dlpi_phdr[i];
+		if (phdr.p_type != PT_NOTE)
+		{
+			continue;
+		}
+
+		const uint8_t *note = reinterpret_cast<const uint8_t *>(info->dlpi_addr + phdr.p_vaddr);
+		const uint8_t *end = note + phdr.p_memsz;
+		while (note + sizeof(ElfW(Nhdr)) <= end)
+		{
+			const ElfW(Nhdr) *header = reinterpret_cast<const ElfW(Nhdr) *>(note);
+			const char *name = reinterpret_cast<const char *>(note + sizeof(ElfW(Nhdr)));
+			const uint8_t *desc = reinterpret_cast<const uint8_t *>(name) + ((header->n_namesz + 3) & ~3);
+			if (header->n_type == NT_GNU_BUILD_ID && header->n_namesz == 4 && memcmp(name, "GNU", 4) == 0 && desc + header->n_descsz <= end)
+			{
+				char hex[3];
+				search->buildId->clear();
+				for (ElfW(Word) j = 0; j < header->n_descsz; j++)
+				{
+					snprintf(hex, sizeof(hex), "%02x", desc[j]);
+					search->buildId->append(hex);
+				}
+				return 1;
+			}
+			note = desc + ((header->n_descsz + 3) & ~3);
+		}
+	}
+	return 1;
+}
+
+bool GetModuleBuildId(HINSTANCE hModule, std::string &buildId)
+{
+	link_map *lmap;
+	if (dlinfo(hModule, RTLD_DI_LINKMAP, &lmap) != 0)
+	{
+		return false;
+	}
+
+	buildId.clear();
+	BuildIdSearch search = {lmap->l_addr, &buildId};
+	dl_iterate_phdr(FindBuildIdNote, &search);
+	return !buildId.empty();
+}
+
 static int parse_prot(const char *s)
 {
 	int prot = 0;
@@ -8,6 +8,21 @@ void Plat_WriteMemory(void *pPatchAddress, uint8_t *pPatch, int iPatchSize)
 	WriteProcessMemory(GetCurrentProcess(), pPatchAddress, (void *)pPatch, iPatchSize, nullptr);
 }
 
+bool GetModuleBuildId(HINSTANCE hModule, std::string &buildId)
+{
+	IMAGE_DOS_HEADER *pDosHeader = reinterpret_cast<IMAGE_DOS_HEADER *>(hModule);
+	if (!pDosHeader || pDosHeader->e_magic != IMAGE_DOS_SIGNATURE)
+	{
+		return false;
+	}
+	IMAGE_NT_HEADERS *pNtHeader = reinterpret_cast<IMAGE_NT_HEADERS64 *>(reinterpret_cast<uintptr_t>(hModule) + pDosHeader->e_lfanew);
+
+	char szBuildId[32];
+	V_snprintf(szBuildId, sizeof(szBuildId), "%08x%08x", (uint32_t)pNtHeader->FileHeader.TimeDateStamp, (uint32_t)pNtHeader->OptionalHeader.SizeOfImage);
+	buildId = szBuildId;
+	return true;
+}
+
 void CModule::InitializeSections()
 {
 	IMAGE_DOS_HEADER *pDosHeader = reinterpret_cast<IMAGE_DOS_HEADER *>(m_hModule);
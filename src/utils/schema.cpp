@@ -3,14 +3,10 @@
 #include "schema.h"
 #include "schemasystem/schemasystem.h"
 #include "utils/interfaces.h"
-// #include <unordered_map>
-#include "tier1/utlmap.h"
 #include "plat.h"
 #include "sdk/entity/cbaseentity.h"
 
 #include "tier0/memdbgon.h"
-using SchemaKeyValueMap_t = CUtlMap<uint32_t, SchemaKey>;
-using SchemaTableMap_t = CUtlMap<uint32_t, SchemaKeyValueMap_t *>;
 
 static bool IsFieldNetworked(SchemaClassFieldData_t &field)
 {
@@ -26,47 +22,6 @@ static bool IsFieldNetworked(SchemaClassFieldData_t &field)
 	return false;
 }
 
-static bool InitSchemaFieldsForClass(SchemaTableMap_t *tableMap, const char *className, uint32_t classKey)
-{
-	CSchemaSystemTypeScope *pType = g_pSchemaSystem->FindTypeScopeForModule(MODULE_PREFIX "server" MODULE_EXT);
-
-	if (!pType)
-	{
-		return false;
-	}
-
-	SchemaClassInfoData_t *pClassInfo = pType->FindDeclaredClass(className).Get();
-
-	if (!pClassInfo)
-	{
-		SchemaKeyValueMap_t *map = new SchemaKeyValueMap_t(0, 0, DefLessFunc(uint32_t));
-		tableMap->Insert(classKey, map);
-
-		Warning("InitSchemaFieldsForClass(): '%s' was not found!\n", className);
-		return false;
-	}
-
-	short fieldsSize = pClassInfo->m_nFieldCount;
-	SchemaClassFieldData_t *pFields = pClassInfo->m_pFields;
-
-	SchemaKeyValueMap_t *keyValueMap = new SchemaKeyValueMap_t(0, 0, DefLessFunc(uint32_t));
-	keyValueMap->EnsureCapacity(fieldsSize);
-	tableMap->Insert(classKey, keyValueMap);
-
-	for (int i = 0; i < fieldsSize; ++i)
-	{
-		SchemaClassFieldData_t &field = pFields[i];
-
-#ifdef CS2_SDK_ENABLE_SCHEMA_FIELD_OFFSET_LOGGING
-		Msg("%s::%s found at -> 0x%X - %llx\n", className, field.m_pszName, field.m_nSingleInheritanceOffset, &field);
-#endif
-
-		keyValueMap->Insert(hash_32_fnv1a_const(field.m_pszName), {field.m_nSingleInheritanceOffset, IsFieldNetworked(field)});
-	}
-
-	return true;
-}
-
 int16_t schema::FindChainOffset(const char *className)
 {
 	CSchemaSystemTypeScope *pType = g_pSchemaSystem->FindTypeScopeForModule(MODULE_PREFIX "server" MODULE_EXT);
@@ -96,29 +51,75 @@ int16_t schema::FindChainOffset(const char *className)
 	return 0;
 }
 
-SchemaKey schema::GetOffset(const char *className, uint32_t classKey, const char *memberName, uint32_t memberKey)
+bool schema::ResolveFields()
 {
-	static SchemaTableMap_t schemaTableMap(0, 0, DefLessFunc(uint32_t));
-	int16_t tableMapIndex = schemaTableMap.Find(classKey);
-	if (!schemaTableMap.IsValidIndex(tableMapIndex))
+	CSchemaSystemTypeScope *pType = g_pSchemaSystem->FindTypeScopeForModule(MODULE_PREFIX "server" MODULE_EXT);
+
+	if (!pType)
 	{
-		if (InitSchemaFieldsForClass(&schemaTableMap, className, classKey))
-		{
-			return GetOffset(className, classKey, memberName, memberKey);
-		}
+		return false;
+	}
 
-		return {0, 0};
+	// Group the fields by class so that each class is only looked up and walked once.
+	CUtlVector<FieldKey *> keys;
+	for (FieldKey *key = FieldKey::first; key; key = key->next)
+	{
+		keys.AddToTail(key);
 	}
+	keys.Sort([](FieldKey *const *a, FieldKey *const *b) { return V_strcmp((*a)->className, (*b)->className); });
 
-	SchemaKeyValueMap_t *tableMap = schemaTableMap[tableMapIndex];
-	int16_t memberIndex = tableMap->Find(memberKey);
-	if (!tableMap->IsValidIndex(memberIndex))
+	bool success = true;
+	CUtlVector<uint32_t> fieldHashes;
+	for (int start = 0, end = 0; start < keys.Count(); start = end)
 	{
-		Warning("schema::GetOffset(): '%s' was not found in '%s'!\n", memberName, className);
-		return {0, 0};
+		const char *className = keys[start]->className;
+		for (end = start + 1; end < keys.Count() && V_strcmp(keys[end]->className, className) == 0; end++)
+		{
+		}
+
+		SchemaClassInfoData_t *pClassInfo = pType->FindDeclaredClass(className).Get();
+		if (!pClassInfo)
+		{
+			Warning("schema::ResolveFields(): '%s' was not found!\n", className);
+			for (int i = start; i < end; i++)
+			{
+				fields[keys[i]->id] = {0, false, 0};
+			}
+			success = false;
+			continue;
+		}
+
+		short fieldsSize = pClassInfo->m_nFieldCount;
+		SchemaClassFieldData_t *pFields = pClassInfo->m_pFields;
+		fieldHashes.SetCount(fieldsSize);
+		for (int i = 0; i < fieldsSize; ++i)
+		{
+			fieldHashes[i] = hash_32_fnv1a_const(pFields[i].m_pszName);
+		}
+		int16_t chainOffset = FindChainOffset(className);
+
+		for (int i = start; i < end; i++)
+		{
+			FieldKey *key = keys[i];
+			uint32_t keyHash = hash_32_fnv1a_const(key->fieldName);
+			int fieldIndex = fieldHashes.Find(keyHash);
+			if (fieldIndex == fieldHashes.InvalidIndex())
+			{
+				Warning("schema::ResolveFields(): '%s' was not found in '%s'!\n", key->fieldName, className);
+				fields[key->id] = {0, false, 0};
+				success = false;
+				continue;
+			}
+
+			SchemaClassFieldData_t &field = pFields[fieldIndex];
+#ifdef CS2_SDK_ENABLE_SCHEMA_FIELD_OFFSET_LOGGING
+			Msg("%s::%s found at -> 0x%X - %llx\n", className, field.m_pszName, field.m_nSingleInheritanceOffset, &field);
+#endif
+			fields[key->id] = {field.m_nSingleInheritanceOffset, IsFieldNetworked(field), chainOffset};
+		}
 	}
 
-	return tableMap->Element(memberIndex);
+	return success;
 }
 
 void schema::NetworkStateChanged(int64 chainEntity, uint32 nLocalOffset, int nArrayIndex)
@@ -12,8 +12,13 @@ struct SchemaKey
 {
 	int32 offset;
 	bool networked;
+	// Offset of __m_pChainEntity in the declaring class, 0 if it has none.
+	int16 chainOffset;
 };
 
+// Every schema field accessor declared in a binary gets a slot in schema::fields.
+#define SCHEMA_MAX_FIELDS 512
+
 struct CNetworkVarChainer : public CSmartPtr<CEntityInstance>
 {
 	struct ChainUpdatePropagationLL_t
@@ -29,8 +34,33 @@ struct CNetworkVarChainer : public CSmartPtr<CEntityInstance>
 
 namespace schema
 {
+	// Registers a field accessor at static init time and hands out its index in schema::fields.
+	struct FieldKey
+	{
+		FieldKey(const char *className, const char *fieldName) : className(className), fieldName(fieldName), next(FieldKey::first)
+		{
+			FieldKey::first = this;
+			this->id = FieldKey::count++;
+			assert(this->id < SCHEMA_MAX_FIELDS);
+		}
+
+		const char *className;
+		const char *fieldName;
+		int32 id;
+		FieldKey *next;
+
+		static inline FieldKey *first;
+		static inline int32 count;
+	};
+
+	// Filled by ResolveFields, indexed by FieldKey::id.
+	inline SchemaKey fields[SCHEMA_MAX_FIELDS];
+
+	// Looks up every registered field in one pass over the schema system, once the schema system is available.
+	// Each binary has its own registry and must resolve it.
+	bool ResolveFields();
+
 	int16_t FindChainOffset(const char *className);
-	SchemaKey GetOffset(const char *className, uint32_t classKey, const char *memberName, uint32_t memberKey);
 	void NetworkStateChanged(int64 chainEntity, uint32 nLocalOffset, int nArrayIndex);
 } // namespace schema
 
@@ -56,34 +86,26 @@ inline constexpr uint64_t hash_64_fnv1a_const(const char *const str, const uint6
 	class varName##_prop \
 	{ \
 	public: \
+		static inline const schema::FieldKey key {ThisClassName, #varName}; \
+\
 		std::add_lvalue_reference_t<type> Get() \
 		{ \
-			static constexpr auto datatable_hash = hash_32_fnv1a_const(ThisClassName); \
-			static constexpr auto prop_hash = hash_32_fnv1a_const(#varName); \
-\
-			static const auto m_key = schema::GetOffset(ThisClassName, datatable_hash, #varName, prop_hash); \
-\
 			static const size_t offset = offsetof(ThisClass, varName); \
 			ThisClass *pThisClass = (ThisClass *)((byte *)this - offset); \
 \
-			return *reinterpret_cast<std::add_pointer_t<type>>((uintptr_t)(pThisClass) + m_key.offset + extra_offset); \
+			return *reinterpret_cast<std::add_pointer_t<type>>((uintptr_t)(pThisClass) + schema::fields[key.id].offset + extra_offset); \
 		} \
 		void Set(type val) \
 		{ \
-			static constexpr auto datatable_hash = hash_32_fnv1a_const(ThisClassName); \
-			static constexpr auto prop_hash = hash_32_fnv1a_const(#varName); \
-\
-			static const auto m_key = schema::GetOffset(ThisClassName, datatable_hash, #varName, prop_hash); \
-\
-			static const auto m_chain = schema::FindChainOffset(ThisClassName); \
+			const SchemaKey &m_key = schema::fields[key.id]; \
 \
 			static const size_t offset = offsetof(ThisClass, varName); \
 			ThisClass *pThisClass = (ThisClass *)((byte *)this - offset); \
 \
-			if (m_chain != 0 && m_key.networked) \
+			if (m_key.chainOffset != 0 && m_key.networked) \
 			{ \
-				DevMsg("Found chain offset %d for %s::%s\n", m_chain, ThisClassName, #varName); \
-				schema::NetworkStateChanged((uintptr_t)(pThisClass) + m_chain, m_key.offset + extra_offset, 0xFFFFFFFF); \
+				DevMsg("Found chain offset %d for %s::%s\n", m_key.chainOffset, ThisClassName, #varName); \
+				schema::NetworkStateChanged((uintptr_t)(pThisClass) + m_key.chainOffset, m_key.offset + extra_offset, 0xFFFFFFFF); \
 			} \
 			else if (m_key.networked) \
 			{ \
@@ -123,17 +145,14 @@ inline constexpr uint64_t hash_64_fnv1a_const(const char *const str, const uint6
 	class varName##_prop \
 	{ \
 	public: \
+		static inline const schema::FieldKey key {ThisClassName, #varName}; \
+\
 		type *Get() \
 		{ \
-			static constexpr auto datatable_hash = hash_32_fnv1a_const(ThisClassName); \
-			static constexpr auto prop_hash = hash_32_fnv1a_const(#varName); \
-\
-			static const auto m_key = schema::GetOffset(ThisClassName, datatable_hash, #varName, prop_hash); \
-\
 			static const size_t offset = offsetof(ThisClass, varName); \
 			ThisClass *pThisClass = (ThisClass *)((byte *)this - offset); \
 \
-			return reinterpret_cast<std::add_pointer_t<type>>((uintptr_t)(pThisClass) + m_key.offset + extra_offset); \
+			return reinterpret_cast<std::add_pointer_t<type>>((uintptr_t)(pThisClass) + schema::fields[key.id].offset + extra_offset); \
 		} \
 		operator type *() \
 		{ \
@@ -0,0 +1,295 @@
+// Before common.h, whose internal macro clashes with ios_base::internal.
+#include <thread>
+
+#include "sigscanner.h"
+#include "module.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIGSCANNER_SSE2
+#endif
+
+#ifdef _WIN32
+#include <intrin.h>
+#endif
+
+#include "tier0/memdbgon.h"
+
+#define SIG_WILDCARD 0x2A
+
+// Below this size, starting threads costs more than the scan itself.
+#define SIGSCANNER_MIN_THREAD_SIZE (8 * 1024 * 1024)
+#define SIGSCANNER_MAX_THREADS     8
+// Anchor pairs compared per 16 byte block, more than this falls back to the scalar scan.
+#define SIGSCANNER_MAX_SIMD_ANCHORS 64
+
+// Bytes that are everywhere in x86-64 code, anchors avoid them when they can.
+internal bool IsCommonByte(byte value)
+{
+	switch (value)
+	{
+		case 0x00:
+		case 0x0F:
+		case 0x24:
+		case 0x41:
+		case 0x44:
+		case 0x48:
+		case 0x49:
+		case 0x4C:
+		case 0x83:
+		case 0x85:
+		case 0x89:
+		case 0x8B:
+		case 0x8D:
+		case 0xC0:
+		case 0xCC:
+		case 0xE8:
+		case 0xFF:
+			return true;
+	}
+	return false;
+}
+
+internal u32 LowestSetBit(u32 mask)
+{
+#ifdef _WIN32
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+i32 SignatureScanner::AddPattern(const byte *pattern, size_t length)
+{
+	i32 index = (i32)this->patterns.size();
+	Pattern &newPattern = this->patterns.emplace_back();
+	newPattern.bytes.assign(pattern, pattern + length);
+	newPattern.anchor = 0;
+	newPattern.hasAnchor = false;
+
+	i32 bestScore = 3;
+	for (size_t i = 0; i + 1 < length; i++)
+	{
+		if (pattern[i] == SIG_WILDCARD || pattern[i + 1] == SIG_WILDCARD)
+		{
+			continue;
+		}
+		i32 score = IsCommonByte(pattern[i]) + IsCommonByte(pattern[i + 1]);
+		if (score < bestScore)
+		{
+			bestScore = score;
+			newPattern.anchor = i;
+			newPattern.hasAnchor = true;
+			if (score == 0)
+			{
+				break;
+			}
+		}
+	}
+
+	if (newPattern.hasAnchor)
+	{
+		u16 pair = pattern[newPattern.anchor] | (pattern[newPattern.anchor + 1] << 8);
+		size_t slot = 0;
+		while (slot < this->anchors.size() && this->anchors[slot] != pair)
+		{
+			slot++;
+		}
+		if (slot == this->anchors.size())
+		{
+			this->anchors.push_back(pair);
+			this->patternsByAnchor.emplace_back();
+		}
+		this->patternsByAnchor[slot].push_back(index);
+		this->maxAnchor = MAX(this->maxAnchor, newPattern.anchor);
+	}
+	return index;
+}
+
+bool SignatureScanner::MatchesAt(const byte *memory, const byte *pattern, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		if (memory[i] != pattern[i] && pattern[i] != SIG_WILDCARD)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SignatureScanner::Compare(const byte *memory, const Pattern &pattern)
+{
+	return MatchesAt(memory, pattern.bytes.data(), pattern.bytes.size());
+}
+
+void SignatureScanner::CheckCandidate(const byte *base, size_t size, size_t candidate, size_t from, size_t to, Match *matches) const
+{
+	u16 pair = base[candidate] | (base[candidate + 1] << 8);
+	for (size_t slot = 0; slot < this->anchors.size(); slot++)
+	{
+		if (this->anchors[slot] != pair)
+		{
+			continue;
+		}
+		for (i32 index : this->patternsByAnchor[slot])
+		{
+			const Pattern &pattern = this->patterns[index];
+			// Each range only reports the matches that start in it, the anchor may be further in.
+			if (candidate < pattern.anchor)
+			{
+				continue;
+			}
+			size_t start = candidate - pattern.anchor;
+			if (start < from || start >= to || size - start < pattern.bytes.size())
+			{
+				continue;
+			}
+			if (Compare(base + start, pattern))
+			{
+				if (!matches[index].count)
+				{
+					matches[index].first = base + start;
+				}
+				matches[index].count++;
+			}
+		}
+		return;
+	}
+}
+
+void SignatureScanner::ScanRange(const byte *base, size_t size, size_t from, size_t to, Match *matches) const
+{
+	if (this->anchors.empty() || size < 2)
+	{
+		return;
+	}
+	// Anchors of matches starting before `to` can be up to maxAnchor further, and need the byte after them.
+	size_t scanEnd = MIN(to + this->maxAnchor, size - 1);
+	size_t position = from;
+
+#ifdef SIGSCANNER_SSE2
+	__m128i firstBytes[SIGSCANNER_MAX_SIMD_ANCHORS];
+	__m128i secondBytes[SIGSCANNER_MAX_SIMD_ANCHORS];
+	size_t numAnchors = this->anchors.size();
+	for (size_t i = 0; i < numAnchors && i < SIGSCANNER_MAX_SIMD_ANCHORS; i++)
+	{
+		firstBytes[i] = _mm_set1_epi8((char)(this->anchors[i] & 0xFF));
+		secondBytes[i] = _mm_set1_epi8((char)(this->anchors[i] >> 8));
+	}
+	// The second load reads one byte past the block, which must stay inside the memory.
+	for (; numAnchors <= SIGSCANNER_MAX_SIMD_ANCHORS && position + 16 <= scanEnd; position += 16)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(base + position));
+		__m128i nextBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(base + position + 1));
+		u32 mask = 0;
+		for (size_t i = 0; i < numAnchors; i++)
+		{
+			__m128i pairs = _mm_and_si128(_mm_cmpeq_epi8(block, firstBytes[i]), _mm_cmpeq_epi8(nextBlock, secondBytes[i]));
+			mask |= (u32)_mm_movemask_epi8(pairs);
+		}
+		while (mask)
+		{
+			this->CheckCandidate(base, size, position + LowestSetBit(mask), from, to, matches);
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	bool isFirstByte[256] {};
+	for (u16 pair : this->anchors)
+	{
+		isFirstByte[pair & 0xFF] = true;
+	}
+	for (; position < scanEnd; position++)
+	{
+		if (isFirstByte[base[position]])
+		{
+			this->CheckCandidate(base, size, position, from, to, matches);
+		}
+	}
+}
+
+void SignatureScanner::Scan(const void *base, size_t size, i32 numThreads)
+{
+	const byte *memory = static_cast<const byte *>(base);
+	numThreads = MAX(1, MIN(numThreads, SIGSCANNER_MAX_THREADS));
+	if (size / numThreads < 16)
+	{
+		numThreads = 1;
+	}
+
+	std::vector<std::vector<Match>> threadMatches(numThreads, std::vector<Match>(this->patterns.size(), Match {}));
+	size_t chunkSize = size / numThreads;
+	std::vector<std::thread> threads;
+	for (i32 i = 1; i < numThreads; i++)
+	{
+		size_t from = i * chunkSize;
+		size_t to = i == numThreads - 1 ? size : from + chunkSize;
+		threads.emplace_back([this, memory, size, from, to, &threadMatches, i]() { this->ScanRange(memory, size, from, to, threadMatches[i].data()); });
+	}
+	this->ScanRange(memory, size, 0, numThreads == 1 ? size : chunkSize, threadMatches[0].data());
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+
+	// Ranges are in memory order, so the first range with a match has the first match.
+	this->results.assign(this->patterns.size(), Match {});
+	for (size_t i = 0; i < this->patterns.size(); i++)
+	{
+		for (i32 j = 0; j < numThreads; j++)
+		{
+			const Match &match = threadMatches[j][i];
+			if (match.count && !this->results[i].count)
+			{
+				this->results[i].first = match.first;
+			}
+			this->results[i].count += match.count;
+		}
+	}
+
+	// Patterns without two fixed bytes in a row can't be anchored, check them everywhere.
+	for (size_t i = 0; i < this->patterns.size(); i++)
+	{
+		const Pattern &pattern = this->patterns[i];
+		if (pattern.hasAnchor || pattern.bytes.empty())
+		{
+			continue;
+		}
+		for (size_t start = 0; start + pattern.bytes.size() <= size && this->results[i].count < 2; start++)
+		{
+			if (Compare(memory + start, pattern))
+			{
+				if (!this->results[i].count)
+				{
+					this->results[i].first = memory + start;
+				}
+				this->results[i].count++;
+			}
+		}
+	}
+}
+
+void *SignatureScanner::GetResult(i32 pattern, int &error) const
+{
+	if (pattern < 0 || (size_t)pattern >= this->results.size() || !this->results[pattern].count)
+	{
+		error = SIG_NOT_FOUND;
+		return nullptr;
+	}
+	error = this->results[pattern].count > 1 ? SIG_FOUND_MULTIPLE : SIG_OK;
+	return (void *)this->results[pattern].first;
+}
+
+i32 SignatureScanner::GetDefaultThreadCount(size_t size)
+{
+	if (size < SIGSCANNER_MIN_THREAD_SIZE)
+	{
+		return 1;
+	}
+	i32 hardwareThreads = (i32)std::thread::hardware_concurrency();
+	return MAX(1, MIN(hardwareThreads, SIGSCANNER_MAX_THREADS));
+}
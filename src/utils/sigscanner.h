@@ -0,0 +1,62 @@
+#pragma once
+#include "common.h"
+
+#include <vector>
+
+/*
+ * Finds many signatures in a single pass over a block of memory.
+ *
+ * Every pattern is anchored on a pair of consecutive non-wildcard bytes. The scan looks for all anchors at once with SSE2
+ * compares, 16 positions at a time, and only candidates whose anchor matches are compared against the whole pattern.
+ * Like CModule::FindSignature, \x2A is a wildcard and a second match makes the result SIG_FOUND_MULTIPLE.
+ */
+class SignatureScanner
+{
+public:
+	// Returns the index of the pattern for GetResult. The pattern bytes are copied.
+	i32 AddPattern(const byte *pattern, size_t length);
+
+	// Scans [base, base + size). With more than one thread, the range is split between them and results are merged.
+	void Scan(const void *base, size_t size, i32 numThreads = 1);
+
+	// First match of the pattern, error is one of SigError.
+	void *GetResult(i32 pattern, int &error) const;
+
+	i32 GetPatternCount() const
+	{
+		return (i32)this->patterns.size();
+	}
+
+	// Checks a single position, for validating addresses found earlier.
+	static bool MatchesAt(const byte *memory, const byte *pattern, size_t length);
+
+	// Thread count for Scan based on the size of the range and the hardware.
+	static i32 GetDefaultThreadCount(size_t size);
+
+private:
+	struct Pattern
+	{
+		std::vector<byte> bytes;
+		// Offset of the anchor pair from the start of the pattern.
+		size_t anchor;
+		bool hasAnchor;
+	};
+
+	struct Match
+	{
+		const byte *first;
+		u32 count;
+	};
+
+	// Looks for matches starting in [from, to) of the memory at base, reading up to base + size.
+	void ScanRange(const byte *base, size_t size, size_t from, size_t to, Match *matches) const;
+	void CheckCandidate(const byte *base, size_t size, size_t candidate, size_t from, size_t to, Match *matches) const;
+	static bool Compare(const byte *memory, const Pattern &pattern);
+
+	std::vector<Pattern> patterns;
+	std::vector<Match> results;
+	// Patterns sharing the same anchor pair, by anchor pair.
+	std::vector<u16> anchors;
+	std::vector<std::vector<i32>> patternsByAnchor;
+	size_t maxAnchor {};
+};
@@ -3,11 +3,14 @@
 #include "utils/utils.h"
 #include "simplecmds.h"
 #include "../kz/kz.h"
+#include "../kz/option/kz_option.h"
 #include "tier0/memdbgon.h"
 
 // private structs
 #define SCMD_MAX_NAME_LEN        128
 #define SCMD_MAX_DESCRIPTION_LEN 1024
+// Power of two, kept at 4x the command limit so probe chains stay short.
+#define SCMD_HASH_TABLE_SIZE (SCMD_MAX_CMDS * 4)
 
 struct Scmd
 {
@@ -17,17 +20,81 @@ struct Scmd
 	char description[SCMD_MAX_DESCRIPTION_LEN];
 	scmd::Callback_t *callback;
 	bool hidden;
+	bool adminOnly;
 };
 
 struct ScmdManager
 {
 	i32 cmdCount;
 	Scmd cmds[SCMD_MAX_CMDS];
+	// Open-addressed indices into cmds (stored + 1, 0 is empty), hashed on the case-folded name.
+	// byName is for console commands as typed, byShortName is the name without the console prefix,
+	// which is what chat triggers and overridden console commands use.
+	i16 byName[SCMD_HASH_TABLE_SIZE];
+	i16 byShortName[SCMD_HASH_TABLE_SIZE];
 };
 
 internal ScmdManager g_cmdManager = {};
 internal bool g_coreCmdsRegistered = false;
 
+// Case-insensitive FNV-1a, also returns the length of the name.
+internal u32 HashCmdName(const char *name, i32 &length)
+{
+	u32 hash = 2166136261u;
+	for (length = 0; name[length]; length++)
+	{
+		hash = (hash ^ (u8)V_tolower(name[length])) * 16777619u;
+	}
+	return hash;
+}
+
+internal const char *GetShortName(const Scmd &cmd, i32 &length)
+{
+	i32 prefixLength = cmd.hasConsolePrefix ? sizeof(SCMD_CONSOLE_PREFIX) - 1 : 0;
+	length = cmd.nameLength - prefixLength;
+	return cmd.name + prefixLength;
+}
+
+internal void IndexCmd(i16 *table, const char *name, i32 cmdIndex)
+{
+	i32 length;
+	u32 slot = HashCmdName(name, length) & (SCMD_HASH_TABLE_SIZE - 1);
+	while (table[slot])
+	{
+		slot = (slot + 1) & (SCMD_HASH_TABLE_SIZE - 1);
+	}
+	table[slot] = cmdIndex + 1;
+}
+
+internal void RebuildCmdIndex()
+{
+	V_memset(g_cmdManager.byName, 0, sizeof(g_cmdManager.byName));
+	V_memset(g_cmdManager.byShortName, 0, sizeof(g_cmdManager.byShortName));
+	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	{
+		i32 shortLength;
+		IndexCmd(g_cmdManager.byName, g_cmdManager.cmds[i].name, i);
+		IndexCmd(g_cmdManager.byShortName, GetShortName(g_cmdManager.cmds[i], shortLength), i);
+	}
+}
+
+// If several commands share a short name, the one registered first is found.
+internal Scmd *FindCmd(const i16 *table, const char *name, bool shortName)
+{
+	i32 length;
+	for (u32 slot = HashCmdName(name, length) & (SCMD_HASH_TABLE_SIZE - 1); table[slot]; slot = (slot + 1) & (SCMD_HASH_TABLE_SIZE - 1))
+	{
+		Scmd *cmd = &g_cmdManager.cmds[table[slot] - 1];
+		i32 cmdLength = cmd->nameLength;
+		const char *cmdName = shortName ? GetShortName(*cmd, cmdLength) : cmd->name;
+		if (cmdLength == length && !V_stricmp(cmdName, name))
+		{
+			return cmd;
+		}
+	}
+	return nullptr;
+}
+
 internal SCMD_CALLBACK(Command_KzHelp)
 {
 	utils::CPrintChat(controller, "%s Look in your console for a list of commands!", KZ_CHAT_PREFIX);
@@ -54,7 +121,7 @@ internal void RegisterCoreCmds()
 	scmd::RegisterCmd("kz_help", Command_KzHelp, "Show this help message.");
 }
 
-bool scmd::RegisterCmd(const char *name, scmd::Callback_t *callback, const char *description /* = nullptr*/, bool hidden)
+bool scmd::RegisterCmd(const char *name, scmd::Callback_t *callback, const char *description /* = nullptr*/, bool hidden, bool adminOnly)
 {
 	Assert(name);
 	Assert(callback);
@@ -89,54 +156,80 @@ bool scmd::RegisterCmd(const char *name, scmd::Callback_t *callback, const char
 	}
 
 	// Check if command with this name already exists
-	Scmd *cmds = g_cmdManager.cmds;
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	if (FindCmd(g_cmdManager.byName, name, false))
 	{
-		if (nameLength != g_cmdManager.cmds[i].nameLength)
-		{
-			continue;
-		}
-
-		if (!V_stricmp(g_cmdManager.cmds[i].name, name))
-		{
-			// TODO: print warning? error? segfault?
-			// Command already exists
-			// Assert(0);
-			return false;
-		}
+		// TODO: print warning? error? segfault?
+		// Command already exists
+		// Assert(0);
+		return false;
 	}
 
 	// Command name is unique!
-	Scmd cmd = {hasConPrefix, nameLength, "", "", callback, hidden};
+	Scmd cmd = {hasConPrefix, nameLength, "", "", callback, hidden, adminOnly};
 	V_snprintf(cmd.name, SCMD_MAX_NAME_LEN, "%s", name);
 	V_snprintf(cmd.description, SCMD_MAX_DESCRIPTION_LEN, "%s", description);
-	g_cmdManager.cmds[g_cmdManager.cmdCount++] = cmd;
+	i32 cmdIndex = g_cmdManager.cmdCount++;
+	g_cmdManager.cmds[cmdIndex] = cmd;
+
+	i32 shortLength;
+	IndexCmd(g_cmdManager.byName, g_cmdManager.cmds[cmdIndex].name, cmdIndex);
+	IndexCmd(g_cmdManager.byShortName, GetShortName(g_cmdManager.cmds[cmdIndex], shortLength), cmdIndex);
 	return true;
 }
 
 bool scmd::UnregisterCmd(const char *name)
 {
-	i32 indexToDelete = -1;
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	Scmd *cmd = FindCmd(g_cmdManager.byName, name, false);
+	if (!cmd)
 	{
-		if (!V_stricmp(g_cmdManager.cmds[i].name, name))
-		{
-			indexToDelete = i;
-			break;
-		}
+		return false;
 	}
-	if (indexToDelete != -1)
+	// Keep registration order for kz_help, indices after the removed command shift so the index is rebuilt.
+	i32 indexToDelete = cmd - g_cmdManager.cmds;
+	V_memmove(cmd, cmd + 1, (g_cmdManager.cmdCount - indexToDelete - 1) * sizeof(Scmd));
+	g_cmdManager.cmdCount--;
+	RebuildCmdIndex();
+	return true;
+}
+
+// The server console (no controller) or a player whose SteamID64 is in the adminSteamIDs server option.
+internal bool IsAdmin(CCSPlayerController *controller)
+{
+	if (!controller)
 	{
-		for (i32 i = indexToDelete; i < g_cmdManager.cmdCount; i++)
+		return true;
+	}
+	u64 steamID = controller->m_steamID();
+	// SteamID64s separated by commas or spaces.
+	const char *admins = KZOptionService::GetOptionStr("adminSteamIDs", "");
+	while (steamID && *admins)
+	{
+		char *end;
+		u64 adminSteamID = strtoull(admins, &end, 10);
+		if (end == admins)
 		{
-			g_cmdManager.cmds[i] = g_cmdManager.cmds[i + 1];
+			admins++;
+			continue;
 		}
-		g_cmdManager.cmdCount--;
-		return true;
+		if (adminSteamID == steamID)
+		{
+			return true;
+		}
+		admins = end;
 	}
 	return false;
 }
 
+internal META_RES RunCmd(Scmd *cmd, CCSPlayerController *controller, const CCommand *args)
+{
+	if (cmd->adminOnly && !IsAdmin(controller))
+	{
+		utils::CPrintChat(controller, "%s You don't have access to this command.", KZ_CHAT_PREFIX);
+		return MRES_SUPERCEDE;
+	}
+	return cmd->callback(controller, args);
+}
+
 META_RES scmd::OnClientCommand(CPlayerSlot &slot, const CCommand &args)
 {
 	if (!g_coreCmdsRegistered)
@@ -157,19 +250,10 @@ META_RES scmd::OnClientCommand(CPlayerSlot &slot, const CCommand &args)
 		return MRES_IGNORED;
 	}
 
-	for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+	Scmd *cmd = FindCmd(g_cmdManager.byName, args[0], false);
+	if (cmd)
 	{
-		if (!g_cmdManager.cmds[i].callback)
-		{
-			// TODO: error?
-			Assert(g_cmdManager.cmds[i].callback);
-			continue;
-		}
-
-		if (!V_stricmp(g_cmdManager.cmds[i].name, args[0]))
-		{
-			result = g_cmdManager.cmds[i].callback(controller, &args);
-		}
+		result = RunCmd(cmd, controller, &args);
 	}
 	return result;
 }
@@ -216,51 +300,28 @@ META_RES scmd::OnDispatchConCommand(ConCommandHandle cmd, const CCommandContext
 			// arg is too short!
 			return MRES_IGNORED;
 		}
-		Scmd *cmds = g_cmdManager.cmds;
-
 		CCommand cmdArgs;
 		cmdArgs.Tokenize(args[1]);
 
-		for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+		const char *arg = cmdArgs[0] + 1; // skip chat trigger
+		Scmd *command = FindCmd(g_cmdManager.byShortName, arg, true);
+		if (command)
 		{
-			if (!cmds[i].callback)
+			RunCmd(command, controller, &cmdArgs);
+			if (args[1][0] == SCMD_CHAT_SILENT_TRIGGER)
 			{
-				// TODO: error?
-				Assert(cmds[i].callback);
-				continue;
-			}
-
-			const char *arg = cmdArgs[0] + 1; // skip chat trigger
-			const char *cmdName = cmds[i].hasConsolePrefix ? cmds[i].name + strlen(SCMD_CONSOLE_PREFIX) : cmds[i].name;
-			if (!V_stricmp(arg, cmdName))
-			{
-				cmds[i].callback(controller, &cmdArgs);
-				if (args[1][0] == SCMD_CHAT_SILENT_TRIGGER)
-				{
-					// don't send chat message
-					return MRES_SUPERCEDE;
-				}
+				// don't send chat message
+				return MRES_SUPERCEDE;
 			}
 		}
 	}
 	else // Are we overriding a console command?
 	{
-		for (i32 i = 0; i < g_cmdManager.cmdCount; i++)
+		Scmd *command = FindCmd(g_cmdManager.byShortName, commandName, true);
+		if (command)
 		{
-			Scmd *cmds = g_cmdManager.cmds;
-			if (!cmds[i].callback)
-			{
-				// TODO: error?
-				Assert(cmds[i].callback);
-				continue;
-			}
-
-			const char *cmdName = cmds[i].hasConsolePrefix ? cmds[i].name + strlen(SCMD_CONSOLE_PREFIX) : cmds[i].name;
-			if (!V_stricmp(commandName, cmdName))
-			{
-				cmds[i].callback(controller, &args);
-				return MRES_SUPERCEDE;
-			}
+			RunCmd(command, controller, &args);
+			return MRES_SUPERCEDE;
 		}
 	}
 
@@ -15,7 +15,8 @@ class CCSPlayerController;
 namespace scmd
 {
 	typedef SCMD_CALLBACK(Callback_t);
-	bool RegisterCmd(const char *name, Callback_t *callback, const char *description = nullptr, bool hidden = false);
+	// adminOnly: only the server console and the players listed in the adminSteamIDs server option can run the command.
+	bool RegisterCmd(const char *name, Callback_t *callback, const char *description = nullptr, bool hidden = false, bool adminOnly = false);
 	bool UnregisterCmd(const char *name);
 
 	META_RES OnClientCommand(CPlayerSlot &slot, const CCommand &args);
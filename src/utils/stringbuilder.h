@@ -0,0 +1,161 @@
+#pragma once
+#include "common.h"
+
+#include <math.h>
+
+/*
+ * Builds a string into a fixed buffer by appending at a cursor, so nothing is rescanned on each append.
+ *
+ * Numbers are formatted directly instead of going through printf: AppendFloat rounds like "%.*f" does for the values
+ * we display, without locale lookups. The result is always null terminated and silently truncated when it doesn't fit.
+ */
+class StringBuilder
+{
+public:
+	StringBuilder(char *buffer, u32 size) : start(buffer), cursor(buffer), end(buffer + size - 1)
+	{
+		*this->cursor = 0;
+	}
+
+	const char *Get() const
+	{
+		return this->start;
+	}
+
+	u32 Length() const
+	{
+		return this->cursor - this->start;
+	}
+
+	StringBuilder &Append(char c)
+	{
+		if (this->cursor < this->end)
+		{
+			*this->cursor++ = c;
+			*this->cursor = 0;
+		}
+		return *this;
+	}
+
+	StringBuilder &Append(const char *str)
+	{
+		while (*str && this->cursor < this->end)
+		{
+			*this->cursor++ = *str++;
+		}
+		*this->cursor = 0;
+		return *this;
+	}
+
+	// minDigits pads with zeroes, like "%02i".
+	StringBuilder &AppendInt(i64 value, u32 minDigits = 0)
+	{
+		if (value < 0)
+		{
+			this->Append('-');
+		}
+		// Negate as unsigned so INT64_MIN works.
+		u64 magnitude = value < 0 ? 0 - (u64)value : (u64)value;
+		return this->AppendDigits(magnitude, minDigits);
+	}
+
+	// Fixed point with the given number of decimals, like "%.2f".
+	StringBuilder &AppendFloat(f64 value, u32 decimals)
+	{
+		if (!isfinite(value))
+		{
+			return this->Append(isnan(value) ? "nan" : signbit(value) ? "-inf" : "inf");
+		}
+		f64 scale = 1.0;
+		for (u32 i = 0; i < decimals; i++)
+		{
+			scale *= 10.0;
+		}
+		// printf rounds the exact value, ties to even. The product can land on a tie the exact value isn't on,
+		// the rounding error of the product (exact through fma) tells which way to go then.
+		f64 magnitude = fabs(value);
+		f64 product = magnitude * scale;
+		f64 scaled = rint(product);
+		if (product - floor(product) == 0.5)
+		{
+			f64 error = fma(magnitude, scale, -product);
+			scaled = error > 0.0 ? ceil(product) : error < 0.0 ? floor(product) : scaled;
+		}
+		if (scaled >= 9e18)
+		{
+			char buffer[64];
+			snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+			return this->Append(buffer);
+		}
+		if (signbit(value))
+		{
+			this->Append('-');
+		}
+		u64 fixed = (u64)scaled;
+		u64 divisor = (u64)scale;
+		this->AppendDigits(fixed / divisor, 0);
+		if (decimals)
+		{
+			this->Append('.');
+			this->AppendDigits(fixed % divisor, decimals);
+		}
+		return *this;
+	}
+
+	// Pads what was appended since mark with spaces to width, like "%-10s" (left) or "%10s" (right).
+	StringBuilder &AlignLeft(u32 mark, u32 width)
+	{
+		while (this->Length() - mark < width && this->cursor < this->end)
+		{
+			*this->cursor++ = ' ';
+		}
+		*this->cursor = 0;
+		return *this;
+	}
+
+	StringBuilder &AlignRight(u32 mark, u32 width)
+	{
+		u32 length = this->Length() - mark;
+		if (length >= width)
+		{
+			return *this;
+		}
+		u32 padding = width - length;
+		if (padding > (u32)(this->end - this->cursor))
+		{
+			padding = this->end - this->cursor;
+		}
+		char *field = this->start + mark;
+		memmove(field + padding, field, length);
+		memset(field, ' ', padding);
+		this->cursor += padding;
+		*this->cursor = 0;
+		return *this;
+	}
+
+private:
+	StringBuilder &AppendDigits(u64 value, u32 minDigits)
+	{
+		char digits[20];
+		u32 count = 0;
+		do
+		{
+			digits[count++] = '0' + value % 10;
+			value /= 10;
+		} while (value);
+		while (count < minDigits && count < sizeof(digits))
+		{
+			digits[count++] = '0';
+		}
+		while (count && this->cursor < this->end)
+		{
+			*this->cursor++ = digits[--count];
+		}
+		*this->cursor = 0;
+		return *this;
+	}
+
+	char *start;
+	char *cursor;
+	char *end;
+};
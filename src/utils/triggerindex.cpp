@@ -0,0 +1,410 @@
+#include "triggerindex.h"
+#include "utils/utils.h"
+#include "utils/entitykind.h"
+#include "sdk/entity/cbasetrigger.h"
+#include "entityclass.h"
+#include "mathlib/mathlib.h"
+#include <algorithm>
+
+#include "tier0/memdbgon.h"
+
+struct TriggerBounds
+{
+	Vector mins;
+	Vector maxs;
+	CEntityHandle handle;
+	// Transform the bounds were computed with, see triggers::Refresh.
+	Vector origin;
+	QAngle angles;
+	f32 scale;
+};
+
+struct TriggerNode
+{
+	Vector mins;
+	Vector maxs;
+	// Leaves: first trigger and trigger count. Inner nodes: index of the right child (the left one follows this node), count is 0.
+	i32 first;
+	i32 count;
+};
+
+internal bool built;
+internal CUtlVector<TriggerBounds> staticTriggers;
+internal CUtlVector<TriggerNode> nodes;
+internal CUtlVector<CEntityHandle> dynamicTriggers;
+// Triggers in the hierarchy that moved or were deleted, they leave it before the next query.
+internal CUtlVector<CEntityHandle> dirtyTriggers;
+// Next trigger in the hierarchy for Refresh to compare against its indexed transform.
+internal i32 refreshCursor;
+
+internal bool BoundsOverlap(const Vector &mins1, const Vector &maxs1, const Vector &mins2, const Vector &maxs2)
+{
+	return mins1.x <= maxs2.x && maxs1.x >= mins2.x && mins1.y <= maxs2.y && maxs1.y >= mins2.y && mins1.z <= maxs2.z && maxs1.z >= mins2.z;
+}
+
+internal void GetTriggerBounds(CBaseTrigger *trigger, Vector &mins, Vector &maxs, f32 padding = TRIGGERINDEX_PADDING)
+{
+	CCollisionProperty &collision = trigger->m_Collision();
+	CGameSceneNode *node = trigger->m_CBodyComponent()->m_pSceneNode();
+	Vector localMins = collision.m_vecMins();
+	Vector localMaxs = collision.m_vecMaxs();
+	f32 scale = node->m_flAbsScale();
+	if (scale > 0.0f && scale != 1.0f)
+	{
+		localMins *= scale;
+		localMaxs *= scale;
+	}
+
+	matrix3x4_t transform;
+	AngleMatrix(node->m_angAbsRotation(), node->m_vecAbsOrigin(), transform);
+	TransformAABB(transform, localMins, localMaxs, mins, maxs);
+
+	padding += collision.m_triggerBloat();
+	mins -= Vector(padding, padding, padding);
+	maxs += Vector(padding, padding, padding);
+}
+
+// Axis aligned box triggers, their bounds are their exact shape.
+internal bool IsPlainBoxTrigger(CBaseTrigger *trigger)
+{
+	return trigger->m_Collision().m_nSolidType() == SOLID_BBOX && trigger->m_CBodyComponent()->m_pSceneNode()->m_angAbsRotation() == vec3_angle;
+}
+
+// Slab test of the box swept from start to end against the trigger bounds grown by the box.
+internal bool SweptBoxHitsBounds(const Vector &start, const Vector &end, const bbox_t &bounds, const Vector &mins, const Vector &maxs)
+{
+	f32 enter = 0.0f;
+	f32 leave = 1.0f;
+	for (u32 axis = 0; axis < 3; axis++)
+	{
+		f32 lo = mins[axis] - bounds.maxs[axis] - start[axis];
+		f32 hi = maxs[axis] - bounds.mins[axis] - start[axis];
+		f32 delta = end[axis] - start[axis];
+		if (delta == 0.0f)
+		{
+			if (lo > 0.0f || hi < 0.0f)
+			{
+				return false;
+			}
+			continue;
+		}
+		f32 t1 = lo / delta;
+		f32 t2 = hi / delta;
+		enter = MAX(enter, MIN(t1, t2));
+		leave = MIN(leave, MAX(t1, t2));
+		if (enter > leave)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+internal bool IsTriggerDynamic(CBaseTrigger *trigger)
+{
+	return trigger->m_CBodyComponent()->m_pSceneNode()->m_pParent() != nullptr;
+}
+
+internal bool HasTriggerMoved(CBaseTrigger *trigger, const TriggerBounds &bounds)
+{
+	CGameSceneNode *node = trigger->m_CBodyComponent()->m_pSceneNode();
+	return node->m_pParent() != nullptr || node->m_vecAbsOrigin() != bounds.origin || node->m_angAbsRotation() != bounds.angles
+		   || node->m_flAbsScale() != bounds.scale;
+}
+
+internal void AddStaticTrigger(CBaseTrigger *trigger)
+{
+	TriggerBounds &bounds = staticTriggers[staticTriggers.AddToTail()];
+	GetTriggerBounds(trigger, bounds.mins, bounds.maxs);
+	bounds.handle = trigger->GetRefEHandle();
+	CGameSceneNode *node = trigger->m_CBodyComponent()->m_pSceneNode();
+	bounds.origin = node->m_vecAbsOrigin();
+	bounds.angles = node->m_angAbsRotation();
+	bounds.scale = node->m_flAbsScale();
+}
+
+// Moves a trigger out of the hierarchy, its bounds are recomputed on every query from now on.
+internal void MakeTriggerDynamic(i32 index)
+{
+	dynamicTriggers.AddToTail(staticTriggers[index].handle);
+	staticTriggers.FastRemove(index);
+}
+
+// Sorts staticTriggers[first, first + count) into a subtree starting at the node added next.
+internal void BuildNode(i32 first, i32 count)
+{
+	i32 nodeIndex = nodes.AddToTail();
+	Vector mins = staticTriggers[first].mins;
+	Vector maxs = staticTriggers[first].maxs;
+	Vector centerMins = (mins + maxs) * 0.5f;
+	Vector centerMaxs = centerMins;
+	for (i32 i = first + 1; i < first + count; i++)
+	{
+		VectorMin(mins, staticTriggers[i].mins, mins);
+		VectorMax(maxs, staticTriggers[i].maxs, maxs);
+		Vector center = (staticTriggers[i].mins + staticTriggers[i].maxs) * 0.5f;
+		VectorMin(centerMins, center, centerMins);
+		VectorMax(centerMaxs, center, centerMaxs);
+	}
+	nodes[nodeIndex].mins = mins;
+	nodes[nodeIndex].maxs = maxs;
+
+	if (count <= TRIGGERINDEX_LEAF_SIZE)
+	{
+		nodes[nodeIndex].first = first;
+		nodes[nodeIndex].count = count;
+		return;
+	}
+
+	// Split at the median of the axis along which the trigger centers are the most spread out.
+	Vector extent = centerMaxs - centerMins;
+	u32 axis = 0;
+	if (extent.y > extent[axis])
+	{
+		axis = 1;
+	}
+	if (extent.z > extent[axis])
+	{
+		axis = 2;
+	}
+	TriggerBounds *base = staticTriggers.Base() + first;
+	std::nth_element(base, base + count / 2, base + count,
+					 [axis](const TriggerBounds &a, const TriggerBounds &b) { return a.mins[axis] + a.maxs[axis] < b.mins[axis] + b.maxs[axis]; });
+
+	BuildNode(first, count / 2);
+	nodes[nodeIndex].first = nodes.Count();
+	nodes[nodeIndex].count = 0;
+	BuildNode(first + count / 2, count - count / 2);
+}
+
+internal void BuildHierarchy()
+{
+	nodes.RemoveAll();
+	if (staticTriggers.Count() > 0)
+	{
+		nodes.EnsureCapacity(staticTriggers.Count() * 2);
+		BuildNode(0, staticTriggers.Count());
+	}
+}
+
+internal void MarkTriggerDirty(CEntityHandle handle)
+{
+	if (built && !dirtyTriggers.HasElement(handle) && !dynamicTriggers.HasElement(handle))
+	{
+		dirtyTriggers.AddToTail(handle);
+	}
+}
+
+internal void FlushDirtyTriggers()
+{
+	if (dirtyTriggers.Count() == 0)
+	{
+		return;
+	}
+	bool changed = false;
+	FOR_EACH_VEC(dirtyTriggers, i)
+	{
+		FOR_EACH_VEC(staticTriggers, j)
+		{
+			if (staticTriggers[j].handle != dirtyTriggers[i])
+			{
+				continue;
+			}
+			if (GameEntitySystem()->GetBaseEntity(dirtyTriggers[i]))
+			{
+				MakeTriggerDynamic(j);
+			}
+			else
+			{
+				staticTriggers.FastRemove(j);
+			}
+			changed = true;
+			break;
+		}
+	}
+	dirtyTriggers.RemoveAll();
+	if (changed)
+	{
+		BuildHierarchy();
+	}
+}
+
+void triggers::Clear()
+{
+	built = false;
+	staticTriggers.Purge();
+	nodes.Purge();
+	dynamicTriggers.Purge();
+	dirtyTriggers.Purge();
+	refreshCursor = 0;
+}
+
+void triggers::Rebuild()
+{
+	triggers::Clear();
+	if (!GameEntitySystem())
+	{
+		return;
+	}
+	for (CEntityIdentity *entID = GameEntitySystem()->m_EntityList.m_pFirstActiveEntity; entID != NULL; entID = entID->m_pNext)
+	{
+		if (!utils::IsTriggerKind(utils::GetEntityKind(entID->m_pInstance)))
+		{
+			continue;
+		}
+		CBaseTrigger *trigger = static_cast<CBaseTrigger *>(entID->m_pInstance);
+		if (IsTriggerDynamic(trigger))
+		{
+			dynamicTriggers.AddToTail(trigger->GetRefEHandle());
+			continue;
+		}
+		AddStaticTrigger(trigger);
+	}
+	BuildHierarchy();
+	built = true;
+}
+
+void triggers::Refresh()
+{
+	if (!built || !GameEntitySystem())
+	{
+		return;
+	}
+	// Teleports are hooked, parent changes and other moves aren't, so a few triggers are checked every frame instead.
+	i32 checks = MIN(staticTriggers.Count(), TRIGGERINDEX_CHECKS_PER_FRAME);
+	for (i32 i = 0; i < checks; i++)
+	{
+		refreshCursor = refreshCursor + 1 < staticTriggers.Count() ? refreshCursor + 1 : 0;
+		const TriggerBounds &bounds = staticTriggers[refreshCursor];
+		CBaseEntity2 *entity = static_cast<CBaseEntity2 *>(GameEntitySystem()->GetBaseEntity(bounds.handle));
+		if (!entity || HasTriggerMoved(static_cast<CBaseTrigger *>(entity), bounds))
+		{
+			MarkTriggerDirty(bounds.handle);
+		}
+	}
+	FlushDirtyTriggers();
+}
+
+void triggers::OnTriggerSpawned(CBaseEntity2 *trigger)
+{
+	if (built)
+	{
+		dynamicTriggers.AddToTail(trigger->GetRefEHandle());
+	}
+}
+
+void triggers::OnTriggerTeleported(CBaseEntity2 *trigger)
+{
+	MarkTriggerDirty(trigger->GetRefEHandle());
+}
+
+void triggers::OnTriggerDeleted(CBaseEntity2 *trigger)
+{
+	dynamicTriggers.FindAndRemove(trigger->GetRefEHandle());
+	MarkTriggerDirty(trigger->GetRefEHandle());
+}
+
+bool triggers::QuerySweptBox(const Vector &start, const Vector &end, const bbox_t &bounds, CUtlVector<CEntityHandle> *hits)
+{
+	if (!built)
+	{
+		return true;
+	}
+	FlushDirtyTriggers();
+	Vector mins, maxs;
+	VectorMin(start, end, mins);
+	VectorMax(start, end, maxs);
+	mins += bounds.mins;
+	maxs += bounds.maxs;
+
+	bool hit = false;
+	if (nodes.Count() > 0)
+	{
+		// Depth is about log2 of the trigger count, 64 is plenty.
+		i32 stack[64];
+		i32 stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0)
+		{
+			const TriggerNode &node = nodes[stack[--stackSize]];
+			if (!BoundsOverlap(mins, maxs, node.mins, node.maxs))
+			{
+				continue;
+			}
+			if (node.count == 0)
+			{
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = &node - nodes.Base() + 1;
+				continue;
+			}
+			for (i32 i = node.first; i < node.first + node.count; i++)
+			{
+				if (!BoundsOverlap(mins, maxs, staticTriggers[i].mins, staticTriggers[i].maxs))
+				{
+					continue;
+				}
+				if (!hits)
+				{
+					return true;
+				}
+				hits->AddToTail(staticTriggers[i].handle);
+				hit = true;
+			}
+		}
+	}
+
+	FOR_EACH_VEC(dynamicTriggers, i)
+	{
+		CBaseEntity2 *entity = static_cast<CBaseEntity2 *>(GameEntitySystem()->GetBaseEntity(dynamicTriggers[i]));
+		if (!entity)
+		{
+			continue;
+		}
+		Vector triggerMins, triggerMaxs;
+		GetTriggerBounds(static_cast<CBaseTrigger *>(entity), triggerMins, triggerMaxs);
+		if (!BoundsOverlap(mins, maxs, triggerMins, triggerMaxs))
+		{
+			continue;
+		}
+		if (!hits)
+		{
+			return true;
+		}
+		hits->AddToTail(dynamicTriggers[i]);
+		hit = true;
+	}
+	return hit;
+}
+
+bool triggers::FindTouchedTriggers(const Vector &start, const Vector &end, const bbox_t &bounds, EntityHandleSet &touched)
+{
+	if (!built)
+	{
+		return true;
+	}
+	local_persist CUtlVector<CEntityHandle> hits;
+	hits.RemoveAll();
+	if (!triggers::QuerySweptBox(start, end, bounds, &hits))
+	{
+		return false;
+	}
+	FOR_EACH_VEC(hits, i)
+	{
+		CBaseTrigger *trigger = static_cast<CBaseTrigger *>(GameEntitySystem()->GetBaseEntity(hits[i]));
+		if (!trigger || (trigger->m_Collision().m_usSolidFlags() & FSOLID_NOT_SOLID))
+		{
+			continue;
+		}
+		if (!IsPlainBoxTrigger(trigger))
+		{
+			return true;
+		}
+		Vector mins, maxs;
+		GetTriggerBounds(trigger, mins, maxs, 0.0f);
+		if (SweptBoxHitsBounds(start, end, bounds, mins, maxs))
+		{
+			touched.Insert(hits[i]);
+		}
+	}
+	return false;
+}
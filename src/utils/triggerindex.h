@@ -0,0 +1,46 @@
+#pragma once
+#include "common.h"
+#include "sdk/datatypes.h"
+
+class CBaseEntity2;
+
+// Leaves hold at most this many triggers.
+#define TRIGGERINDEX_LEAF_SIZE 4
+// Added around every trigger so that rounding and small movements don't make us miss one.
+#define TRIGGERINDEX_PADDING   1.0f
+// Triggers in the hierarchy that Refresh compares against their indexed transform every frame.
+#define TRIGGERINDEX_CHECKS_PER_FRAME 16
+
+/*
+ * Bounding volume hierarchy over the world space bounds of every trigger_* entity.
+ *
+ * The hierarchy is a broad phase: it tells which triggers a (swept) player box can touch at all.
+ * Triggers that are axis aligned boxes are then tested exactly, brush triggers can have any shape
+ * so the engine trace that finds the triggers that are actually touched is only needed for those.
+ *
+ * The hierarchy is built on round_start. Triggers that have a parent or spawn afterwards can move,
+ * their bounds are recomputed on every query instead. A trigger in the hierarchy that is teleported
+ * leaves it before the next query. One that moved or got a parent in some other way leaves it once
+ * Refresh gets to it, which checks TRIGGERINDEX_CHECKS_PER_FRAME triggers per frame in turn.
+ * Disabled triggers stay in the index.
+ */
+namespace triggers
+{
+	// Forget every trigger, the index answers "maybe" for everything until the next Rebuild.
+	void Clear();
+	void Rebuild();
+	// Once per frame before any movement, see above.
+	void Refresh();
+
+	void OnTriggerSpawned(CBaseEntity2 *trigger);
+	void OnTriggerTeleported(CBaseEntity2 *trigger);
+	void OnTriggerDeleted(CBaseEntity2 *trigger);
+
+	// Returns true if the box swept from start to end overlaps the bounds of any trigger.
+	// If hits is not null, all of them are appended to it, otherwise this returns on the first one.
+	bool QuerySweptBox(const Vector &start, const Vector &end, const bbox_t &bounds, CUtlVector<CEntityHandle> *hits = nullptr);
+
+	// Adds the box triggers touched by the box swept from start to end to touched.
+	// Returns true if other triggers may be touched too, the engine trace has to find those.
+	bool FindTouchedTriggers(const Vector &start, const Vector &end, const bbox_t &bounds, EntityHandleSet &touched);
+} // namespace triggers
@@ -39,6 +39,11 @@ bool utils::Initialize(ISmmAPI *ismm, char *error, size_t maxlen)
 		return false;
 	}
 
+	if (!schema::ResolveFields())
+	{
+		Warning("Some schema fields could not be resolved.\n");
+	}
+
 	CBufferStringGrowable<256> gamedirpath;
 	interfaces::pEngine->GetGameDir(gamedirpath);
 
@@ -53,9 +58,10 @@ bool utils::Initialize(ISmmAPI *ismm, char *error, size_t maxlen)
 		Warning("%s\n", error);
 		return false;
 	}
+	g_pGameConfig->ScanSignatures(g_pFullFileSystem, "addons/cs2kz/data/signatures.cache.txt");
 	// Initialize this later because we didn't have game config before.
 	interfaces::pGameEventManager =
-		(IGameEventManager2 *)(CALL_VIRTUAL(uintptr_t, g_pGameConfig->GetOffset("GameEventManager"), interfaces::pServer) - 8);
+		(IGameEventManager2 *)(CALL_VIRTUAL(uintptr_t, g_pGameConfig->GetOffset(gamedata::gameEventManager), interfaces::pServer) - 8);
 
 	RESOLVE_SIG(g_pGameConfig, "TracePlayerBBox", TracePlayerBBox_t, TracePlayerBBox);
 	RESOLVE_SIG(g_pGameConfig, "InitGameTrace", InitGameTrace_t, InitGameTrace);
@@ -229,29 +235,6 @@ void utils::PlaySoundToClient(CPlayerSlot player, const char *sound, f32 volume)
 	g_pKZUtils->EmitSound(filter, player.Get() + 1, soundParams);
 }
 
-f32 utils::NormalizeDeg(f32 a)
-{
-	a = fmod(a, 360.0);
-	if (a >= 180.0)
-	{
-		a -= 360.0;
-	}
-	else if (a < -180.0)
-	{
-		a += 360.0;
-	}
-	return a;
-}
-
-f32 utils::GetAngleDifference(const f32 source, const f32 target, const f32 c, bool relative)
-{
-	if (relative)
-	{
-		return fmod((fmod(target - source, 2 * c) + 3 * c), 2 * c) - c;
-	}
-	return fmod(fabs(target - source) + c, 2 * c) - c;
-}
-
 void utils::SendConVarValue(CPlayerSlot slot, ConVar *conVar, const char *value)
 {
 	INetworkSerializable *netmsg = g_pNetworkMessages->FindNetworkMessagePartial("SetConVar");
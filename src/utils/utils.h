@@ -26,15 +26,43 @@ namespace utils
 	CPlayerSlot GetEntityPlayerSlot(CBaseEntity2 *entity);
 
 	// Normalize the angle between -180 and 180.
-	f32 NormalizeDeg(f32 a);
+	// Defined here so that code without the engine (mode plugins, the benchmark) can use it.
+	inline f32 NormalizeDeg(f32 a)
+	{
+		a = fmod(a, 360.0);
+		if (a >= 180.0)
+		{
+			a -= 360.0;
+		}
+		else if (a < -180.0)
+		{
+			a += 360.0;
+		}
+		return a;
+	}
+
 	// Gets the difference in angle between 2 angles.
 	// c can be PI (for radians) or 180.0 (for degrees);
-	f32 GetAngleDifference(const f32 x, const f32 y, const f32 c, bool relative = false);
+	inline f32 GetAngleDifference(const f32 source, const f32 target, const f32 c, bool relative = false)
+	{
+		if (relative)
+		{
+			return fmod((fmod(target - source, 2 * c) + 3 * c), 2 * c) - c;
+		}
+		return fmod(fabs(target - source) + c, 2 * c) - c;
+	}
 
 	// Print functions
 	bool CFormat(char *buffer, u64 buffer_size, const char *text);
+	// vsnprintf and CFormat in one pass, with an optional prefix before the message.
+	// The format string is compiled once and cached by address, so it must not change (use literals).
+	bool CFormatV(char *buffer, u64 buffer_size, const char *prefix, const char *format, va_list args);
 	void ClientPrintFilter(IRecipientFilter *filter, int msg_dest, const char *msg_name, const char *param1, const char *param2, const char *param3,
 						   const char *param4);
+	// Queues a TextMsg for the player slots in recipients, sent by FlushPrints at the end of the tick.
+	// Identical messages are merged into one send, console lines of a recipient are joined into one message.
+	void QueuePrint(u64 recipients, int msg_dest, const char *text);
+	void FlushPrints();
 	void PrintConsole(CBaseEntity2 *entity, const char *format, ...);
 	void PrintChat(CBaseEntity2 *entity, const char *format, ...);
 	void PrintCentre(CBaseEntity2 *entity, const char *format, ...);
@@ -4,6 +4,10 @@
 #include "sdk/recipientfilters.h"
 #include "utils.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "tier0/memdbgon.h"
 
 /*
@@ -188,6 +192,51 @@ internal CFormatResult AddSpace(CFormatContext *ctx)
 	return CFORMAT_OK;
 }
 
+// Parses colors, escapes and newlines of ctx->current until the end of the string.
+internal bool FormatColors(CFormatContext *ctx)
+{
+	while (*ctx->current)
+	{
+		auto escape_chars = EscapeChars(ctx);
+		if (escape_chars == CFORMAT_OK)
+		{
+			continue;
+		}
+		if (escape_chars == CFORMAT_OUT_OF_SPACE)
+		{
+			return false;
+		}
+
+		auto parse_colors = ParseColors(ctx);
+		if (parse_colors == CFORMAT_OK)
+		{
+			continue;
+		}
+		if (parse_colors == CFORMAT_OUT_OF_SPACE)
+		{
+			return false;
+		}
+
+		auto replace_newlines = ReplaceNewlines(ctx);
+		if (replace_newlines == CFORMAT_OK)
+		{
+			continue;
+		}
+		if (replace_newlines == CFORMAT_OUT_OF_SPACE)
+		{
+			return false;
+		}
+
+		// Everything else
+		if (!HasEnoughSpace(ctx, 1))
+		{
+			return false;
+		}
+		*ctx->result++ = *ctx->current++;
+	}
+	return true;
+}
+
 bool utils::CFormat(char *buffer, u64 buffer_size, const char *text)
 {
 	assert(buffer_size != 0);
@@ -202,44 +251,360 @@ bool utils::CFormat(char *buffer, u64 buffer_size, const char *text)
 		return false;
 	}
 
-	while (*ctx.current)
+	if (!FormatColors(&ctx))
 	{
-		auto escape_chars = EscapeChars(&ctx);
-		if (escape_chars == CFORMAT_OK)
+		return false;
+	}
+
+	// Null terminate
+	if (!HasEnoughSpace(&ctx, 1))
+	{
+		return false;
+	}
+	*ctx.result++ = 0;
+
+	return true;
+}
+
+/*
+ * Compiled format strings.
+ *
+ * A format string is turned into a program of literal runs, with colors, escapes and newlines already resolved, and printf
+ * conversions. Running it substitutes the arguments in one pass. String arguments can carry color tags of their own
+ * (jumpstat tier colors, the chat prefix...), so only those still go through FormatColors.
+ */
+
+enum CFormatOp : u8
+{
+	CFORMAT_OP_LITERAL, // u16 length, bytes
+	CFORMAT_OP_ARG,     // CFormatArg, number of '*', null terminated conversion spec
+};
+
+enum CFormatArg : u8
+{
+	CFORMAT_ARG_INT,
+	CFORMAT_ARG_LONG,
+	CFORMAT_ARG_LONGLONG,
+	CFORMAT_ARG_SIZE,
+	CFORMAT_ARG_DOUBLE,
+	CFORMAT_ARG_LONGDOUBLE,
+	CFORMAT_ARG_POINTER,
+	CFORMAT_ARG_CHAR,
+	CFORMAT_ARG_STRING,
+};
+
+struct CFormatTemplate
+{
+	// False if the format uses conversions the compiler doesn't know, these use vsnprintf and CFormat instead.
+	bool compiled;
+	std::string program;
+};
+
+internal bool FlushLiteral(std::string &program, std::string &literal)
+{
+	if (literal.empty())
+	{
+		return true;
+	}
+	// Newlines grow to 3 bytes, nothing else grows.
+	std::string resolved(literal.size() * 3 + 1, '\0');
+	CFormatContext ctx;
+	ctx.current = literal.c_str();
+	ctx.result = resolved.data();
+	ctx.result_end = resolved.data() + resolved.size();
+	FormatColors(&ctx);
+	u16 length = ctx.result - resolved.data();
+	if (length != ctx.result - resolved.data())
+	{
+		return false;
+	}
+	program += (char)CFORMAT_OP_LITERAL;
+	program.append((const char *)&length, sizeof(length));
+	program.append(resolved.data(), length);
+	literal.clear();
+	return true;
+}
+
+internal bool CompileTemplate(const char *format, bool formatArgs, std::string &program)
+{
+	std::string literal;
+	const char *current = format;
+	while (*current)
+	{
+		if (*current != '%' || !formatArgs)
 		{
+			literal += *current++;
 			continue;
 		}
-		if (escape_chars == CFORMAT_OUT_OF_SPACE)
+		if (current[1] == '%')
+		{
+			literal += '%';
+			current += 2;
+			continue;
+		}
+
+		const char *spec = current++;
+		u8 stars = 0;
+		while (*current && strchr("-+ #0", *current))
+		{
+			current++;
+		}
+		if (*current == '*')
+		{
+			stars++;
+			current++;
+		}
+		while (*current >= '0' && *current <= '9')
+		{
+			current++;
+		}
+		if (*current == '.')
 		{
+			current++;
+			if (*current == '*')
+			{
+				stars++;
+				current++;
+			}
+			while (*current >= '0' && *current <= '9')
+			{
+				current++;
+			}
+		}
+
+		i32 longs = 0;
+		bool sizeArg = false;
+		bool longDouble = false;
+		while (*current && strchr("hljztL", *current))
+		{
+			longs += *current == 'l';
+			longs += *current == 'j' ? 2 : 0;
+			sizeArg |= *current == 'z' || *current == 't';
+			longDouble |= *current == 'L';
+			current++;
+		}
+
+		CFormatArg arg;
+		switch (*current)
+		{
+			case 'd':
+			case 'i':
+			case 'u':
+			case 'x':
+			case 'X':
+			case 'o':
+				arg = sizeArg ? CFORMAT_ARG_SIZE : longs >= 2 ? CFORMAT_ARG_LONGLONG : longs == 1 ? CFORMAT_ARG_LONG : CFORMAT_ARG_INT;
+				break;
+			case 'f':
+			case 'F':
+			case 'e':
+			case 'E':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A':
+				arg = longDouble ? CFORMAT_ARG_LONGDOUBLE : CFORMAT_ARG_DOUBLE;
+				break;
+			case 'p':
+				arg = CFORMAT_ARG_POINTER;
+				break;
+			case 'c':
+				arg = CFORMAT_ARG_CHAR;
+				break;
+			case 's':
+				arg = CFORMAT_ARG_STRING;
+				break;
+			default:
+				return false;
+		}
+		if ((arg == CFORMAT_ARG_CHAR || arg == CFORMAT_ARG_STRING) && (longs || sizeArg))
+		{
+			// Wide characters.
 			return false;
 		}
+		current++;
 
-		auto parse_colors = ParseColors(&ctx);
-		if (parse_colors == CFORMAT_OK)
+		if (!FlushLiteral(program, literal))
+		{
+			return false;
+		}
+		program += (char)CFORMAT_OP_ARG;
+		program += (char)arg;
+		program += (char)stars;
+		program.append(spec, current - spec);
+		program += '\0';
+	}
+	return FlushLiteral(program, literal);
+}
+
+// Format strings are keyed by address, they are expected to be literals.
+internal const CFormatTemplate &GetTemplate(const char *format, bool formatArgs)
+{
+	local_persist std::unordered_map<const char *, CFormatTemplate> templates[2];
+	auto &cache = templates[formatArgs];
+	auto it = cache.find(format);
+	if (it == cache.end())
+	{
+		CFormatTemplate tmpl;
+		tmpl.compiled = CompileTemplate(format, formatArgs, tmpl.program);
+		it = cache.emplace(format, std::move(tmpl)).first;
+	}
+	return it->second;
+}
+
+template<typename T>
+internal i32 FormatArg(char *buffer, size_t size, const char *spec, u8 stars, const i32 *starValues, T value)
+{
+	switch (stars)
+	{
+		case 1:
+			return snprintf(buffer, size, spec, starValues[0], value);
+		case 2:
+			return snprintf(buffer, size, spec, starValues[0], starValues[1], value);
+	}
+	return snprintf(buffer, size, spec, value);
+}
+
+internal bool RunTemplate(CFormatContext *ctx, const std::string &program, va_list args)
+{
+	const char *op = program.data();
+	const char *end = op + program.size();
+	while (op < end)
+	{
+		if (*op++ == CFORMAT_OP_LITERAL)
 		{
+			u16 length;
+			V_memcpy(&length, op, sizeof(length));
+			op += sizeof(length);
+			if (!HasEnoughSpace(ctx, length))
+			{
+				return false;
+			}
+			V_memcpy(ctx->result, op, length);
+			ctx->result += length;
+			op += length;
 			continue;
 		}
-		if (parse_colors == CFORMAT_OUT_OF_SPACE)
+
+		CFormatArg arg = (CFormatArg)*op++;
+		u8 stars = *op++;
+		const char *spec = op;
+		op += strlen(spec) + 1;
+
+		i32 starValues[2] = {};
+		for (u8 i = 0; i < stars; i++)
 		{
-			return false;
+			starValues[i] = va_arg(args, int);
 		}
 
-		auto replace_newlines = ReplaceNewlines(&ctx);
-		if (replace_newlines == CFORMAT_OK)
+		if (arg == CFORMAT_ARG_STRING || arg == CFORMAT_ARG_CHAR)
 		{
+			// Text from arguments may hold color tags, it still needs parsing.
+			char text[512];
+			CFormatContext argCtx = *ctx;
+			if (arg == CFORMAT_ARG_STRING && !V_strcmp(spec, "%s"))
+			{
+				argCtx.current = va_arg(args, const char *);
+				argCtx.current = argCtx.current ? argCtx.current : "(null)";
+			}
+			else
+			{
+				if (arg == CFORMAT_ARG_STRING)
+				{
+					FormatArg(text, sizeof(text), spec, stars, starValues, va_arg(args, const char *));
+				}
+				else
+				{
+					FormatArg(text, sizeof(text), spec, stars, starValues, va_arg(args, int));
+				}
+				argCtx.current = text;
+			}
+			if (!FormatColors(&argCtx))
+			{
+				return false;
+			}
+			ctx->result = argCtx.result;
 			continue;
 		}
-		if (replace_newlines == CFORMAT_OUT_OF_SPACE)
+
+		size_t space = ctx->result_end - ctx->result;
+		i32 written = 0;
+		switch (arg)
+		{
+			case CFORMAT_ARG_INT:
+				written = FormatArg(ctx->result, space, spec, stars, starValues, va_arg(args, int));
+				break;
+			case CFORMAT_ARG_LONG:
+				written = FormatArg(ctx->result, space, spec, stars, starValues, va_arg(args, long));
+				break;
+			case CFORMAT_ARG_LONGLONG:
+				written = FormatArg(ctx->result, space, spec, stars, starValues, va_arg(args, long long));
+				break;
+			case CFORMAT_ARG_SIZE:
+				written = FormatArg(ctx->result, space, spec, stars, starValues, va_arg(args, size_t));
+				break;
+			case CFORMAT_ARG_DOUBLE:
+				written = FormatArg(ctx->result, space, spec, stars, starValues, va_arg(args, double));
+				break;
+			case CFORMAT_ARG_LONGDOUBLE:
+				written = FormatArg(ctx->result, space, spec, stars, starValues, va_arg(args, long double));
+				break;
+			case CFORMAT_ARG_POINTER:
+				written = FormatArg(ctx->result, space, spec, stars, starValues, va_arg(args, void *));
+				break;
+			default:
+				break;
+		}
+		if (written < 0 || !HasEnoughSpace(ctx, written))
 		{
 			return false;
 		}
+		ctx->result += written;
+	}
+	return true;
+}
 
-		// Everything else
-		if (!HasEnoughSpace(&ctx, 1))
+bool utils::CFormatV(char *buffer, u64 buffer_size, const char *prefix, const char *format, va_list args)
+{
+	assert(buffer_size != 0);
+
+	const CFormatTemplate &formatTemplate = GetTemplate(format, true);
+	if (!formatTemplate.compiled)
+	{
+		char text[512];
+		if (prefix)
+		{
+			i32 prefixLength = snprintf(text, sizeof(text), "%s ", prefix);
+			vsnprintf(text + prefixLength, sizeof(text) - prefixLength, format, args);
+		}
+		else
+		{
+			vsnprintf(text, sizeof(text), format, args);
+		}
+		return CFormat(buffer, buffer_size, text);
+	}
+
+	CFormatContext ctx;
+	ctx.current = format;
+	ctx.result = buffer;
+	ctx.result_end = buffer + buffer_size;
+
+	if (AddSpace(&ctx) != CFORMAT_OK)
+	{
+		return false;
+	}
+
+	if (prefix)
+	{
+		if (!RunTemplate(&ctx, GetTemplate(prefix, false).program, args) || AddSpace(&ctx) != CFORMAT_OK)
 		{
 			return false;
 		}
-		*ctx.result++ = *ctx.current++;
+	}
+
+	if (!RunTemplate(&ctx, formatTemplate.program, args))
+	{
+		return false;
 	}
 
 	// Null terminate
@@ -267,6 +632,92 @@ void utils::ClientPrintFilter(IRecipientFilter *filter, int msg_dest, const char
 	interfaces::pGameEventSystem->PostEventAbstract(0, false, filter, netmsg, &msg, 0);
 }
 
+// Console lines for one recipient are joined up to this size per message.
+#define PRINT_MAX_CONSOLE_BATCH 1024
+
+struct QueuedPrint
+{
+	int msg_dest;
+	u64 recipients;
+	std::string text;
+};
+
+internal std::vector<QueuedPrint> queuedPrints;
+internal std::string queuedConsoleLines[MAXPLAYERS];
+
+internal void AddQueuedPrint(u64 recipients, int msg_dest, const char *text, size_t length)
+{
+	// Only a handful of messages go out per tick, a linear search is enough.
+	for (QueuedPrint &print : queuedPrints)
+	{
+		if (print.msg_dest == msg_dest && print.text.size() == length && !V_memcmp(print.text.data(), text, length))
+		{
+			print.recipients |= recipients;
+			return;
+		}
+	}
+	queuedPrints.push_back({msg_dest, recipients, std::string(text, length)});
+}
+
+void utils::QueuePrint(u64 recipients, int msg_dest, const char *text)
+{
+	if (msg_dest != HUD_PRINTCONSOLE)
+	{
+		if (recipients)
+		{
+			AddQueuedPrint(recipients, msg_dest, text, strlen(text));
+		}
+		return;
+	}
+
+	size_t length = strlen(text);
+	for (i32 i = 0; i < MAXPLAYERS; i++)
+	{
+		if (!(recipients & (1ull << i)))
+		{
+			continue;
+		}
+		std::string &lines = queuedConsoleLines[i];
+		if (!lines.empty() && lines.size() + length + 1 > PRINT_MAX_CONSOLE_BATCH)
+		{
+			AddQueuedPrint(1ull << i, HUD_PRINTCONSOLE, lines.data(), lines.size());
+			lines.clear();
+		}
+		if (!lines.empty())
+		{
+			lines += '\n';
+		}
+		lines.append(text, length);
+	}
+}
+
+void utils::FlushPrints()
+{
+	for (i32 i = 0; i < MAXPLAYERS; i++)
+	{
+		if (!queuedConsoleLines[i].empty())
+		{
+			// Spectators usually get the same lines as the player they watch, these merge here.
+			AddQueuedPrint(1ull << i, HUD_PRINTCONSOLE, queuedConsoleLines[i].data(), queuedConsoleLines[i].size());
+			queuedConsoleLines[i].clear();
+		}
+	}
+
+	for (QueuedPrint &print : queuedPrints)
+	{
+		CRecipientFilter filter;
+		for (i32 i = 0; i < MAXPLAYERS; i++)
+		{
+			if (print.recipients & (1ull << i))
+			{
+				filter.AddRecipient(CPlayerSlot(i));
+			}
+		}
+		ClientPrintFilter(&filter, print.msg_dest, print.text.c_str(), "", "", "", "");
+	}
+	queuedPrints.clear();
+}
+
 #define FORMAT_STRING(buffer) \
 	va_list args; \
 	va_start(args, format); \
@@ -381,32 +832,34 @@ void utils::PrintHTMLCentreAll(const char *format, ...)
 
 void utils::CPrintChat(CBaseEntity2 *entity, const char *format, ...)
 {
-	FORMAT_STRING(buffer);
-	CSingleRecipientFilter *filter = new CSingleRecipientFilter(utils::GetEntityPlayerSlot(entity).Get());
+	va_list args;
+	va_start(args, format);
 	char coloredBuffer[512];
-	if (CFormat(coloredBuffer, sizeof(coloredBuffer), buffer))
-	{
-		ClientPrintFilter(filter, HUD_PRINTTALK, coloredBuffer, "", "", "", "");
-	}
-	else
+	bool formatted = CFormatV(coloredBuffer, sizeof(coloredBuffer), nullptr, format, args);
+	va_end(args);
+	if (!formatted)
 	{
-		Warning("utils::CPrintChat did not have enough space to print: %s\n", buffer);
+		Warning("utils::CPrintChat did not have enough space to print: %s\n", format);
+		return;
 	}
+	CSingleRecipientFilter *filter = new CSingleRecipientFilter(utils::GetEntityPlayerSlot(entity).Get());
+	ClientPrintFilter(filter, HUD_PRINTTALK, coloredBuffer, "", "", "", "");
 	delete filter;
 }
 
 void utils::CPrintChatAll(const char *format, ...)
 {
-	FORMAT_STRING(buffer);
-	CBroadcastRecipientFilter *filter = new CBroadcastRecipientFilter;
+	va_list args;
+	va_start(args, format);
 	char coloredBuffer[512];
-	if (CFormat(coloredBuffer, sizeof(coloredBuffer), buffer))
-	{
-		ClientPrintFilter(filter, HUD_PRINTTALK, coloredBuffer, "", "", "", "");
-	}
-	else
+	bool formatted = CFormatV(coloredBuffer, sizeof(coloredBuffer), nullptr, format, args);
+	va_end(args);
+	if (!formatted)
 	{
-		Warning("utils::CPrintChatAll did not have enough space to print: %s\n", buffer);
+		Warning("utils::CPrintChatAll did not have enough space to print: %s\n", format);
+		return;
 	}
+	CBroadcastRecipientFilter *filter = new CBroadcastRecipientFilter;
+	ClientPrintFilter(filter, HUD_PRINTTALK, coloredBuffer, "", "", "", "");
 	delete filter;
 }